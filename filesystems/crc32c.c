@@ -1,6 +1,6 @@
 /*
  * this file take from grub 2.0
- * for btrfs UEFI driver
+ * for btrfs UEFI driver, also used by the ext4 driver
  */
 /*
  *  GRUB  --  GRand Unified Bootloader
@@ -20,61 +20,150 @@
  *  along with GRUB.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-static uint32_t crc32c_table [256];
+/*
+ * crc32c (Castagnoli polynomial, reflected).  The portable version works
+ * on eight bytes per step with eight lookup tables (slicing-by-8).  On
+ * x86-64 with SSE4.2 and on ARMv8 CPUs with the CRC32 extension the CRC
+ * instructions are used instead; the choice is made on the first call.
+ */
 
-static void
-init_crc32c_table (void)
+#define CRC32C_POLY 0x82F63B78
+
+typedef fsw_u32 (*crc32c_fn) (fsw_u32 crc, const fsw_u8 *data, fsw_u32 size);
+
+static fsw_u32 crc32c_table[8][256];
+static crc32c_fn crc32c_update;
+
+static fsw_u32
+crc32c_sb8 (fsw_u32 crc, const fsw_u8 *data, fsw_u32 size)
 {
-  auto uint32_t reflect (uint32_t ref, int len);
-  uint32_t reflect (uint32_t ref, int len)
+  while (size >= 8)
     {
-      uint32_t result = 0;
-      int i;
+      fsw_u32 lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16)
+                          | ((fsw_u32) data[3] << 24));
+      fsw_u32 hi = data[4] | (data[5] << 8) | (data[6] << 16)
+                   | ((fsw_u32) data[7] << 24);
+
+      crc = crc32c_table[7][lo & 0xff] ^ crc32c_table[6][(lo >> 8) & 0xff]
+          ^ crc32c_table[5][(lo >> 16) & 0xff] ^ crc32c_table[4][lo >> 24]
+          ^ crc32c_table[3][hi & 0xff] ^ crc32c_table[2][(hi >> 8) & 0xff]
+          ^ crc32c_table[1][(hi >> 16) & 0xff] ^ crc32c_table[0][hi >> 24];
+      data += 8;
+      size -= 8;
+    }
+  while (size--)
+    crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *data++) & 0xff];
+  return crc;
+}
 
-      for (i = 1; i <= len; i++)
-        {
-          if (ref & 1)
-            result |= 1 << (len - i);
-          ref >>= 1;
-        }
+#if defined(EFIX64) || defined(EFIAARCH64)
+/* Both CPUs load unaligned words natively.  fsw_memcpy would be a
+ * firmware CopyMem call per word in the EFI builds.  */
+#define crc32c_get_unaligned64(x) (*(const fsw_u64 *)(x))
+#endif
 
-      return result;
+#if defined(EFIX64)
+static fsw_u32
+crc32c_sse42 (fsw_u32 crc, const fsw_u8 *data, fsw_u32 size)
+{
+  fsw_u64 crc64 = crc;
+
+  while (size >= 8)
+    {
+      fsw_u64 v = crc32c_get_unaligned64 (data);
+
+      __asm__ ("crc32q %1, %0" : "+r" (crc64) : "rm" (v));
+      data += 8;
+      size -= 8;
     }
+  crc = (fsw_u32) crc64;
+  while (size--)
+    __asm__ ("crc32b %1, %0" : "+r" (crc) : "rm" (*data++));
+  return crc;
+}
 
-  static int crc32c_table_inited;
-  if(crc32c_table_inited)
-	  return;
-  crc32c_table_inited = 1;
+static int
+crc32c_have_hw (void)
+{
+  fsw_u32 a, b, c, d;
 
-  uint32_t polynomial = 0x1edc6f41;
-  int i, j;
+  __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (1), "c" (0));
+  return (c >> 20) & 1;   /* SSE4.2 */
+}
+#define crc32c_hw crc32c_sse42
+#elif defined(EFIAARCH64)
+static fsw_u32
+crc32c_armv8 (fsw_u32 crc, const fsw_u8 *data, fsw_u32 size)
+{
+  while (size >= 8)
+    {
+      fsw_u64 v = crc32c_get_unaligned64 (data);
 
-  for(i = 0; i < 256; i++)
+      __asm__ (".arch_extension crc\n\tcrc32cx %w0, %w0, %x1" : "+r" (crc) : "r" (v));
+      data += 8;
+      size -= 8;
+    }
+  while (size--)
     {
-      crc32c_table[i] = reflect(i, 8) << 24;
-      for (j = 0; j < 8; j++)
-        crc32c_table[i] = (crc32c_table[i] << 1) ^
-            (crc32c_table[i] & (1 << 31) ? polynomial : 0);
-      crc32c_table[i] = reflect(crc32c_table[i], 32);
+      fsw_u32 v = *data++;
+
+      __asm__ (".arch_extension crc\n\tcrc32cb %w0, %w0, %w1" : "+r" (crc) : "r" (v));
     }
+  return crc;
 }
 
-uint32_t
-grub_getcrc32c (uint32_t crc, const void *buf, int size)
+static int
+crc32c_have_hw (void)
 {
-  int i;
-  const uint8_t *data = buf;
+  fsw_u64 isar0;
 
-  if (! crc32c_table[1])
-    init_crc32c_table ();
+  __asm__ ("mrs %0, id_aa64isar0_el1" : "=r" (isar0));
+  return ((isar0 >> 16) & 0xf) != 0;   /* ID_AA64ISAR0_EL1.CRC32 */
+}
+#define crc32c_hw crc32c_armv8
+#endif
+
+static void
+init_crc32c_table (void)
+{
+  fsw_u32 crc;
+  int i, j;
 
-  crc^= 0xffffffff;
+  if (crc32c_update)
+    return;
 
-  for (i = 0; i < size; i++)
+  for (i = 0; i < 256; i++)
     {
-      crc = (crc >> 8) ^ crc32c_table[(crc & 0xFF) ^ *data];
-      data++;
+      crc = i;
+      for (j = 0; j < 8; j++)
+        crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+      crc32c_table[0][i] = crc;
     }
+  for (i = 0; i < 256; i++)
+    for (j = 1; j < 8; j++)
+      crc32c_table[j][i] = (crc32c_table[j - 1][i] >> 8)
+                           ^ crc32c_table[0][crc32c_table[j - 1][i] & 0xff];
+
+  crc32c_update = crc32c_sb8;
+#ifdef crc32c_hw
+  if (crc32c_have_hw ())
+    crc32c_update = crc32c_hw;
+#endif
+}
 
-  return crc ^ 0xffffffff;
+/* crc32c without the initial and final inversion, like the Linux
+ * crc32c() that ext4 and btrfs use for seeding and chaining.  */
+static fsw_u32
+crc32c_raw (fsw_u32 crc, const void *buf, fsw_u32 size)
+{
+  if (! crc32c_update)
+    init_crc32c_table ();
+
+  return crc32c_update (crc, buf, size);
+}
+
+fsw_u32
+grub_getcrc32c (fsw_u32 crc, const void *buf, int size)
+{
+  return crc32c_raw (crc ^ 0xffffffff, buf, size) ^ 0xffffffff;
 }
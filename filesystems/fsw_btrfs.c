@@ -45,10 +45,18 @@
 #define fsw_ssize_t int
 /* never zip over 2G, 32bit is enough */
 #define grub_off_t int32_t
-#define grub_size_t int32_t
-#define grub_ssize_t int32_t
 #include "crc32c.c"
-#include "gzio.c"
+#include "../gzip/zlib_inflate/inftrees.c"
+#include "../gzip/zlib_inflate/inffast.c"
+#include "../gzip/zlib_inflate/inflate.c"
+/* minilzo copies literals and matches a word at a time only on x86, but
+ * AArch64 firmware runs with unaligned accesses enabled just the same.  */
+#if defined(EFIAARCH64)
+#define LZO_CFG_NO_UNALIGNED 0
+#define LZO_UNALIGNED_OK_2 1
+#define LZO_UNALIGNED_OK_4 1
+#define LZO_UNALIGNED_OK_8 1
+#endif
 #define MINILZO_CFG_SKIP_LZO_PTR 1
 #define MINILZO_CFG_SKIP_LZO_UTIL 1
 #define MINILZO_CFG_SKIP_LZO_STRING 1
@@ -105,7 +113,12 @@ struct btrfs_superblock
     uint32_t sectorsize;
     uint32_t nodesize;
 
-    uint8_t dummy3[0x31];
+    uint8_t dummy3[0x2c];
+#define BTRFS_CSUM_TYPE_CRC32C  0
+    uint16_t csum_type;
+    uint8_t root_level;
+    uint8_t chunk_root_level;
+    uint8_t log_root_level;
     struct btrfs_device this_device;
     char label[0x100];
     uint8_t dummy4[0x100];
@@ -116,7 +129,11 @@ struct btrfs_header
 {
     btrfs_checksum_t checksum;
     btrfs_uuid_t uuid;
-    uint8_t dummy[0x30];
+    uint64_t bytenr;
+    uint64_t flags;
+    btrfs_uuid_t chunk_tree_uuid;
+    uint64_t generation;
+    uint64_t owner;
     uint32_t nitems;
     uint8_t level;
 } __attribute__ ((__packed__));
@@ -125,6 +142,11 @@ struct fsw_btrfs_device_desc
 {
     struct fsw_volume * dev;
     uint64_t id;
+    /* Read statistics, used to choose between the copies of mirrored data.  */
+    uint64_t bytes_read;
+    uint64_t next_paddr;   /* end of the last read, to follow sequential streams */
+    uint32_t reads;
+    uint32_t errors;
 };
 
 #define RECOVER_CACHE_SIZE 17
@@ -136,6 +158,106 @@ struct fsw_btrfs_recover_cache
     BOOLEAN valid;
 };
 
+/* Upper bound for uncompressed file data that cannot be handed to the core
+ * as a physical run (other devices, mirrored or parity profiles) and goes
+ * through a bounce buffer instead.  */
+#define DIRECT_READ_MAX_SECTORS 256
+
+/* Verify crc32c checksums of tree blocks and file data.  Files with
+ * checksums are then read through the bounce buffer above, so that their
+ * data can be checked before it is handed out.  */
+#ifndef BTRFS_VERIFY_CSUM
+#define BTRFS_VERIFY_CSUM 1
+#endif
+
+/* What fsw_btrfs_read_logical_checked checks a buffer against.  A copy of a
+ * mirrored chunk that fails the check is treated like a read error, so the
+ * next copy is tried.  */
+#define BTRFS_CHECK_NONE 0
+#define BTRFS_CHECK_NODE 1      /* one tree block, checksum in its header */
+#define BTRFS_CHECK_DATA 2      /* file data, checksums in the csum tree */
+
+/* Decompressed compressed extents, keyed by their logical address.  Btrfs
+ * limits a compressed extent to 128 KiB of data, the size bound below only
+ * guards against corrupted ram_bytes values.  An extent is decompressed on
+ * demand, in steps of at least DECOMP_STEP bytes, and its stream stays open
+ * until the whole extent has been decompressed.  */
+#define DECOMP_CACHE_SIZE 4
+#define DECOMP_CACHE_MAX_BYTES (1024 * 1024)
+#define DECOMP_STEP 0x8000
+
+/* Idle zstd decompression contexts of a volume, each one a workspace with
+ * an initialised DStream.  Resetting one is much cheaper than allocating
+ * and initialising a new one for every extent.  */
+#define ZSTD_POOL_SIZE 2
+struct fsw_btrfs_zstd_pool
+{
+    unsigned count;
+    void *workspace[ZSTD_POOL_SIZE];
+};
+struct btrfs_decomp_stream;
+struct fsw_btrfs_decomp_cache
+{
+    uint64_t laddr;
+    uint64_t zsize;
+    uint8_t compression;
+    uint32_t first;   /* start of the decompressed data, see below */
+    uint32_t size;    /* decompressed bytes so far */
+    uint32_t total;   /* expected decompressed bytes */
+    uint32_t alloc;   /* buffer size, padded with zeroes */
+    uint32_t stamp;
+    char *buffer;
+    char *zbuf;       /* compressed data, while the stream is open */
+    struct btrfs_decomp_stream *stream;
+};
+
+struct btrfs_key
+{
+    uint64_t object_id;
+    uint8_t type;
+    uint64_t offset;
+} __attribute__ ((__packed__));
+
+/* Whole tree nodes, keyed by their logical address and generation.  */
+#define NODE_CACHE_SIZE 64
+struct fsw_btrfs_node_cache
+{
+    uint64_t bytenr;
+    uint64_t generation;
+    uint32_t stamp;
+    uint8_t *data;   /* nodesize bytes, starting with the header */
+};
+
+/* Path of a recent lower_bound, used to answer searches that land in the
+ * same leaf without descending from the root again.  */
+#define BTRFS_MAX_LEVEL 8
+#define CURSOR_COUNT 4
+struct fsw_btrfs_cursor
+{
+    uint64_t root;
+    unsigned depth;   /* 0 if unused */
+    uint32_t stamp;
+    struct
+    {
+        uint64_t addr;
+        uint64_t generation;
+        unsigned iter;
+        unsigned maxiter;
+    } path[BTRFS_MAX_LEVEL];
+    struct btrfs_key first;  /* key range of the leaf */
+    struct btrfs_key last;
+};
+
+/* One chunk of the logical address space: the system chunks from the
+ * superblock plus everything in the chunk tree, loaded at mount.  */
+struct btrfs_chunk_item;
+struct fsw_btrfs_chunk_map
+{
+    uint64_t start;
+    uint64_t size;
+    struct btrfs_chunk_item *chunk;  /* on-disk item, including the stripes */
+};
+
 struct fsw_btrfs_volume
 {
     struct fsw_volume g;            //!< Generic volume structure
@@ -151,6 +273,10 @@ struct fsw_btrfs_volume
     unsigned num_devices;
     unsigned sectorshift;
     unsigned sectorsize;
+    unsigned nodesize;
+    unsigned csum_type;
+    int verify_csum;
+    uint64_t csum_tree; /* 0 if data checksums are not verified */
     int is_master;
     int rescan_once;
 
@@ -158,14 +284,23 @@ struct fsw_btrfs_volume
     unsigned n_devices_attached;
     unsigned n_devices_allocated;
 
-    /* Cached extent data.  */
-    uint64_t extstart;
-    uint64_t extend;
-    uint64_t extino;
-    uint64_t exttree;
-    uint32_t extsize;
-    struct btrfs_extent_data *extent;
     struct fsw_btrfs_recover_cache *rcache;
+
+    /* Decompressed extent cache.  */
+    struct fsw_btrfs_decomp_cache dcache[DECOMP_CACHE_SIZE];
+    uint32_t dstamp;
+    struct fsw_btrfs_zstd_pool zpool;
+
+    /* Chunk map, sorted by logical address.  */
+    struct fsw_btrfs_chunk_map *chunks;
+    unsigned n_chunks;
+    unsigned n_chunks_allocated;
+
+    /* Tree node cache and the paths of recent searches.  */
+    struct fsw_btrfs_node_cache *ncache;
+    uint32_t nstamp;
+    struct fsw_btrfs_cursor cursors[CURSOR_COUNT];
+    uint32_t cstamp;
 };
 
 enum
@@ -174,18 +309,12 @@ enum
     GRUB_BTRFS_ITEM_TYPE_INODE_REF = 0x0c,
     GRUB_BTRFS_ITEM_TYPE_DIR_ITEM = 0x54,
     GRUB_BTRFS_ITEM_TYPE_EXTENT_ITEM = 0x6c,
+    GRUB_BTRFS_ITEM_TYPE_EXTENT_CSUM = 0x80,
     GRUB_BTRFS_ITEM_TYPE_ROOT_ITEM = 0x84,
     GRUB_BTRFS_ITEM_TYPE_DEVICE = 0xd8,
     GRUB_BTRFS_ITEM_TYPE_CHUNK = 0xe4
 };
 
-struct btrfs_key
-{
-    uint64_t object_id;
-    uint8_t type;
-    uint64_t offset;
-} __attribute__ ((__packed__));
-
 struct btrfs_chunk_item
 {
     uint64_t size;
@@ -226,7 +355,7 @@ struct btrfs_internal_node
 {
     struct btrfs_key key;
     uint64_t addr;
-    uint64_t dummy;
+    uint64_t generation;
 } __attribute__ ((__packed__));
 
 struct btrfs_dir_item
@@ -291,9 +420,22 @@ struct btrfs_inode
     struct btrfs_time otime;
 } __attribute__ ((__packed__));
 
+/* One EXTENT_DATA item of a file, covering [start, end) of the file.  */
+struct btrfs_extent_data;
+struct fsw_btrfs_extent_map
+{
+    uint64_t start;
+    uint64_t end;
+    fsw_size_t size;                 /* size of the item below */
+    struct btrfs_extent_data *data;
+};
+
 struct fsw_btrfs_dnode {
     struct fsw_dnode g;              //!< Generic dnode structure
     struct btrfs_inode *raw;    //!< Full raw inode structure
+    struct fsw_btrfs_extent_map *extents;  //!< EXTENT_DATA items sorted by offset, loaded on first read
+    unsigned n_extents;
+    int extents_loaded;
 };
 
 struct btrfs_extent_data
@@ -327,6 +469,10 @@ struct btrfs_extent_data
 #define GRUB_BTRFS_COMPRESSION_MAX  3
 
 #define GRUB_BTRFS_OBJECT_ID_CHUNK 0x100
+#define GRUB_BTRFS_OBJECT_ID_CSUM_TREE 7
+#define GRUB_BTRFS_OBJECT_ID_EXTENT_CSUM 0xfffffffffffffff6ULL
+
+#define GRUB_BTRFS_INODE_NODATASUM 0x1
 
 struct fsw_btrfs_uuid_list {
     struct fsw_btrfs_volume *master;
@@ -380,6 +526,9 @@ static fsw_status_t btrfs_set_superblock_info(struct fsw_btrfs_volume *vol, stru
     vol->total_bytes = fsw_u64_le_swap(sb->total_bytes);
     vol->bytes_used = fsw_u64_le_swap(sb->bytes_used);
 
+    vol->nodesize = fsw_u32_le_swap(sb->nodesize);
+    vol->csum_type = fsw_u16_le_swap(sb->csum_type);
+    vol->verify_csum = BTRFS_VERIFY_CSUM && vol->csum_type == BTRFS_CSUM_TYPE_CRC32C;
     vol->sectorshift = 0;
     vol->sectorsize = fsw_u32_le_swap(sb->sectorsize);
     for(i=9; i<20; i++) {
@@ -403,14 +552,23 @@ static uint64_t superblock_pos[4] = {
     1048576ULL * 1048576ULL / 4
 };
 
+static fsw_status_t fsw_btrfs_read_logical_checked(struct fsw_btrfs_volume *vol,
+        uint64_t addr, void *buf, fsw_size_t size, int rdepth, int cache_level, int check);
+static fsw_status_t fsw_btrfs_verify_data(struct fsw_btrfs_volume *vol,
+        uint64_t laddr, const uint8_t *buf, uint64_t size);
+
 static fsw_status_t fsw_btrfs_read_logical(struct fsw_btrfs_volume *vol,
-        uint64_t addr, void *buf, fsw_size_t size, int rdepth, int cache_level);
+        uint64_t addr, void *buf, fsw_size_t size, int rdepth, int cache_level)
+{
+    return fsw_btrfs_read_logical_checked (vol, addr, buf, size, rdepth, cache_level, BTRFS_CHECK_NONE);
+}
 
 static fsw_status_t btrfs_read_superblock (struct fsw_volume *vol, struct btrfs_superblock *sb_out)
 {
     unsigned i;
     uint64_t total_blocks = 1024;
     fsw_status_t err = FSW_SUCCESS;
+    int found = 0, bad = 0;
 
     fsw_set_blocksize(vol, BTRFS_DEFAULT_BLOCK_SIZE, BTRFS_DEFAULT_BLOCK_SIZE);
     for (i = 0; i < 4; i++)
@@ -435,16 +593,26 @@ static fsw_status_t btrfs_read_superblock (struct fsw_volume *vol, struct btrfs_
             fsw_block_release(vol, superblock_pos[i], buffer);
             break;
         }
-        if (i == 0 || fsw_u64_le_swap (sb->generation) > fsw_u64_le_swap (sb_out->generation))
+        /* Skip a damaged copy, one of the others may still be good.  */
+        if (BTRFS_VERIFY_CSUM && fsw_u16_le_swap (sb->csum_type) == BTRFS_CSUM_TYPE_CRC32C
+                && grub_getcrc32c (0, buffer + sizeof (sb->checksum),
+                    BTRFS_DEFAULT_BLOCK_SIZE - sizeof (sb->checksum))
+                != fsw_u32_le_swap (*(uint32_t *) sb->checksum))
+        {
+            DPRINT(L"btrfs: superblock %d checksum mismatch\n", i);
+            bad = 1;
+        }
+        else if (!found || fsw_u64_le_swap (sb->generation) > fsw_u64_le_swap (sb_out->generation))
         {
             fsw_memcpy (sb_out, sb, sizeof (*sb));
             total_blocks = fsw_u64_le_swap (sb->this_device.size) >> 12;
+            found = 1;
         }
         fsw_block_release(vol, superblock_pos[i], buffer);
     }
 
-    if ((err == FSW_UNSUPPORTED || !err) && i == 0)
-        return FSW_UNSUPPORTED;
+    if ((err == FSW_UNSUPPORTED || !err) && !found)
+        return bad ? FSW_VOLUME_CORRUPTED : FSW_UNSUPPORTED;
 
     if (err == FSW_UNSUPPORTED)
         err = FSW_SUCCESS;
@@ -503,13 +671,115 @@ static fsw_status_t save_ref (struct fsw_btrfs_leaf_descriptor *desc,
     return FSW_SUCCESS;
 }
 
+#define depth2cache(x)  ((x) >= 4 ? 1 : 5-(x))
+
+/* Return the tree node at logical address bytenr from the node cache,
+ * reading it if necessary.  A non-zero generation must match the node's.
+ * The node stays valid until the next call.  */
+static fsw_status_t fsw_btrfs_get_node (struct fsw_btrfs_volume *vol,
+        uint64_t bytenr, uint64_t generation, int rdepth,
+        struct btrfs_header **node_out)
+{
+    struct fsw_btrfs_node_cache *nc, *victim = NULL;
+    struct btrfs_header *head;
+    fsw_size_t itemsize;
+    fsw_status_t err;
+    unsigned i;
+
+    if (vol->ncache == NULL)
+    {
+        err = fsw_alloc_zero (sizeof (*vol->ncache) * NODE_CACHE_SIZE, (void **)&vol->ncache);
+        if (err)
+            return err;
+    }
+
+    for (i = 0; i < NODE_CACHE_SIZE; i++)
+    {
+        nc = &vol->ncache[i];
+        if (nc->data && nc->bytenr == bytenr
+                && (generation == 0 || nc->generation == generation))
+        {
+            nc->stamp = ++vol->nstamp;
+            *node_out = (struct btrfs_header *) nc->data;
+            return FSW_SUCCESS;
+        }
+        if (!victim || !nc->data || (victim->data && nc->stamp < victim->stamp))
+            victim = nc;
+    }
+
+    nc = victim;
+    if (nc->data == NULL)
+    {
+        nc->data = AllocatePool (vol->nodesize);
+        if (!nc->data)
+            return FSW_OUT_OF_MEMORY;
+    }
+    /* Reading may look up the chunk tree, which must not pick this slot.  */
+    nc->bytenr = ~0ULL;
+    nc->stamp = ++vol->nstamp;
+
+    err = fsw_btrfs_read_logical_checked (vol, bytenr, nc->data, vol->nodesize,
+            rdepth + 1, depth2cache(rdepth),
+            vol->verify_csum ? BTRFS_CHECK_NODE : BTRFS_CHECK_NONE);
+    if (err)
+        return err;
+
+    head = (struct btrfs_header *) nc->data;
+    itemsize = head->level ? sizeof (struct btrfs_internal_node) : sizeof (struct btrfs_leaf_node);
+    if (fsw_u64_le_swap (head->bytenr) != bytenr
+            || (generation && fsw_u64_le_swap (head->generation) != generation)
+            || fsw_u32_le_swap (head->nitems)
+            > (vol->nodesize - sizeof (*head)) / itemsize)
+        return FSW_VOLUME_CORRUPTED;
+
+    nc->bytenr = bytenr;
+    nc->generation = fsw_u64_le_swap (head->generation);
+    *node_out = head;
+    return FSW_SUCCESS;
+}
+
+/* Locate item i of a leaf: its key, size and logical address.  */
+static fsw_status_t leaf_item (struct fsw_btrfs_volume *vol, uint64_t leafaddr,
+        struct btrfs_header *head, unsigned i,
+        struct btrfs_key *key_out, uint64_t *outaddr, fsw_size_t *outsize)
+{
+    struct btrfs_leaf_node *leaf = (struct btrfs_leaf_node *) (head + 1) + i;
+    uint32_t off = fsw_u32_le_swap (leaf->offset);
+    uint32_t size = fsw_u32_le_swap (leaf->size);
+
+    if (off > vol->nodesize - sizeof (*head)
+            || size > vol->nodesize - sizeof (*head) - off)
+        return FSW_VOLUME_CORRUPTED;
+    *key_out = leaf->key;
+    *outsize = size;
+    *outaddr = leafaddr + sizeof (struct btrfs_header) + off;
+    return FSW_SUCCESS;
+}
+
+/* Number of keys in a node that are <= key (keys are stride bytes apart).  */
+static unsigned key_upper_bound (const uint8_t *keys, unsigned stride, unsigned n,
+        const struct btrfs_key *key)
+{
+    unsigned lo = 0, hi = n;
+
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (key_cmp ((const struct btrfs_key *) (keys + mid * stride), key) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
 static int next (struct fsw_btrfs_volume *vol,
         struct fsw_btrfs_leaf_descriptor *desc,
         uint64_t * outaddr, fsw_size_t * outsize,
         struct btrfs_key *key_out)
 {
     fsw_status_t err;
-    struct btrfs_leaf_node leaf;
+    struct btrfs_header *head;
 
     for (; desc->depth > 0; desc->depth--)
     {
@@ -522,41 +792,65 @@ static int next (struct fsw_btrfs_volume *vol,
         return 0;
     while (!desc->data[desc->depth - 1].leaf)
     {
-        struct btrfs_internal_node node;
-        struct btrfs_header head;
-        fsw_memzero(&node, sizeof(node));
-
-        err = fsw_btrfs_read_logical (vol, desc->data[desc->depth - 1].iter
-                * sizeof (node)
-                + sizeof (struct btrfs_header)
-                + desc->data[desc->depth - 1].addr,
-                &node, sizeof (node), 0, 1);
+        struct btrfs_internal_node *node;
+        uint64_t addr, generation;
+
+        err = fsw_btrfs_get_node (vol, desc->data[desc->depth - 1].addr, 0, 0, &head);
         if (err)
             return -err;
+        node = (struct btrfs_internal_node *) (head + 1) + desc->data[desc->depth - 1].iter;
+        addr = fsw_u64_le_swap (node->addr);
+        generation = fsw_u64_le_swap (node->generation);
 
-        err = fsw_btrfs_read_logical (vol, fsw_u64_le_swap (node.addr),
-                &head, sizeof (head), 0, 1);
+        err = fsw_btrfs_get_node (vol, addr, generation, 0, &head);
         if (err)
             return -err;
 
-        save_ref (desc, fsw_u64_le_swap (node.addr), 0,
-                fsw_u32_le_swap (head.nitems), !head.level);
+        err = save_ref (desc, addr, 0, fsw_u32_le_swap (head->nitems), !head->level);
+        if (err)
+            return -err;
     }
-    err = fsw_btrfs_read_logical (vol, desc->data[desc->depth - 1].iter
-            * sizeof (leaf)
-            + sizeof (struct btrfs_header)
-            + desc->data[desc->depth - 1].addr, &leaf,
-            sizeof (leaf), 0, 1);
+    err = fsw_btrfs_get_node (vol, desc->data[desc->depth - 1].addr, 0, 0, &head);
+    if (!err)
+        err = leaf_item (vol, desc->data[desc->depth - 1].addr, head,
+                desc->data[desc->depth - 1].iter, key_out, outaddr, outsize);
     if (err)
         return -err;
-    *outsize = fsw_u32_le_swap (leaf.size);
-    *outaddr = desc->data[desc->depth - 1].addr + sizeof (struct btrfs_header)
-        + fsw_u32_le_swap (leaf.offset);
-    *key_out = leaf.key;
     return 1;
 }
 
-#define depth2cache(x)  ((x) >= 4 ? 1 : 5-(x))
+/* Find a remembered path whose leaf covers key_in.  */
+static struct fsw_btrfs_cursor *find_cursor (struct fsw_btrfs_volume *vol,
+        uint64_t root, const struct btrfs_key *key_in)
+{
+    unsigned i;
+
+    for (i = 0; i < CURSOR_COUNT; i++)
+    {
+        struct fsw_btrfs_cursor *cur = &vol->cursors[i];
+
+        if (cur->depth && cur->root == root
+                && key_cmp (&cur->first, key_in) <= 0
+                && key_cmp (key_in, &cur->last) <= 0)
+            return cur;
+    }
+    return NULL;
+}
+
+static struct fsw_btrfs_cursor *new_cursor (struct fsw_btrfs_volume *vol, uint64_t root)
+{
+    struct fsw_btrfs_cursor *cur = &vol->cursors[0];
+    unsigned i;
+
+    for (i = 1; i < CURSOR_COUNT; i++)
+        if (vol->cursors[i].stamp < cur->stamp)
+            cur = &vol->cursors[i];
+    cur->root = root;
+    cur->depth = 0;
+    cur->stamp = ++vol->cstamp;
+    return cur;
+}
+
 static fsw_status_t lower_bound (struct fsw_btrfs_volume *vol,
         const struct btrfs_key *key_in,
         struct btrfs_key *key_out,
@@ -566,7 +860,11 @@ static fsw_status_t lower_bound (struct fsw_btrfs_volume *vol,
         int rdepth)
 {
     uint64_t addr = fsw_u64_le_swap (root);
-    int depth = -1;
+    uint64_t generation = 0;
+    struct fsw_btrfs_cursor *cur, scratch;
+    struct btrfs_header *head;
+    fsw_status_t err;
+    unsigned depth, i, n;
 
     if (desc)
     {
@@ -585,120 +883,112 @@ static fsw_status_t lower_bound (struct fsw_btrfs_volume *vol,
     DPRINT (L"btrfs: retrieving %lx %x %lx\n",
             key_in->object_id, key_in->type, key_in->offset);
 
+    /* Same leaf as a recent search: take the path from there.  Nested
+     * searches (chunk tree lookups while reading a node) keep their hands
+     * off the cursors of the search they interrupt.  */
+    cur = rdepth == 0 ? find_cursor (vol, root, key_in) : NULL;
+    if (cur)
+    {
+        cur->stamp = ++vol->cstamp;
+        for (depth = 0; desc && depth + 1 < cur->depth; depth++)
+        {
+            err = save_ref (desc, cur->path[depth].addr, cur->path[depth].iter,
+                    cur->path[depth].maxiter, 0);
+            if (err)
+                return err;
+        }
+        depth = cur->depth - 1;
+        addr = cur->path[depth].addr;
+        generation = cur->path[depth].generation;
+    }
+    else
+    {
+        cur = rdepth == 0 ? new_cursor (vol, root) : &scratch;
+        depth = 0;
+    }
+
     while (1)
     {
-        fsw_status_t err;
-        struct btrfs_header head;
-        fsw_memzero(&head, sizeof(head));
-
-reiter:
-        depth++;
-        /* FIXME: preread few nodes into buffer. */
-        err = fsw_btrfs_read_logical (vol, addr, &head, sizeof (head),
-                rdepth + 1, depth2cache(rdepth));
+        err = fsw_btrfs_get_node (vol, addr, generation, rdepth, &head);
         if (err)
+        {
+            cur->depth = 0;
             return err;
-        addr += sizeof (head);
-        if (head.level)
+        }
+        n = fsw_u32_le_swap (head->nitems);
+
+        if (depth < BTRFS_MAX_LEVEL)
         {
-            unsigned i;
-            struct btrfs_internal_node node, node_last;
-            int have_last = 0;
-            fsw_memzero (&node_last, sizeof (node_last));
-            for (i = 0; i < fsw_u32_le_swap (head.nitems); i++)
-            {
-                err = fsw_btrfs_read_logical (vol, addr + i * sizeof (node),
-                        &node, sizeof (node), rdepth + 1, depth2cache(rdepth));
-                if (err)
-                    return err;
+            cur->path[depth].addr = addr;
+            cur->path[depth].generation = fsw_u64_le_swap (head->generation);
+            cur->path[depth].maxiter = n;
+        }
 
-                DPRINT (L"btrfs: internal node (depth %d) %lx %x %lx\n", depth,
-                        node.key.object_id, node.key.type,
-                        node.key.offset);
+        if (head->level)
+        {
+            struct btrfs_internal_node *nodes = (struct btrfs_internal_node *) (head + 1);
 
-                if (key_cmp (&node.key, key_in) == 0)
-                {
-                    err = FSW_SUCCESS;
-                    if (desc)
-                        err = save_ref (desc, addr - sizeof (head), i,
-                                fsw_u32_le_swap (head.nitems), 0);
-                    if (err)
-                        return err;
-                    addr = fsw_u64_le_swap (node.addr);
-                    goto reiter;
-                }
-                if (key_cmp (&node.key, key_in) > 0)
-                    break;
-                node_last = node;
-                have_last = 1;
-            }
-            if (have_last)
+            /* descend into the last child whose key is <= key_in */
+            i = key_upper_bound ((uint8_t *) nodes, sizeof (*nodes), n, key_in);
+
+            DPRINT (L"btrfs: internal node (depth %d) %d of %d\n", depth, i, n);
+
+            if (i == 0)
             {
-                err = FSW_SUCCESS;
+                cur->depth = 0;
+                *outsize = 0;
+                *outaddr = 0;
+                fsw_memzero (key_out, sizeof (*key_out));
                 if (desc)
-                    err = save_ref (desc, addr - sizeof (head), i - 1,
-                            fsw_u32_le_swap (head.nitems), 0);
-                if (err)
-                    return err;
-                addr = fsw_u64_le_swap (node_last.addr);
-                goto reiter;
+                    return save_ref (desc, addr, -1, n, 0);
+                return FSW_SUCCESS;
             }
-            *outsize = 0;
-            *outaddr = 0;
-            fsw_memzero (key_out, sizeof (*key_out));
             if (desc)
-                return save_ref (desc, addr - sizeof (head), -1,
-                        fsw_u32_le_swap (head.nitems), 0);
-            return FSW_SUCCESS;
-        }
-        {
-            unsigned i;
-            struct btrfs_leaf_node leaf, leaf_last;
-            int have_last = 0;
-            for (i = 0; i < fsw_u32_le_swap (head.nitems); i++)
             {
-                err = fsw_btrfs_read_logical (vol, addr + i * sizeof (leaf),
-                        &leaf, sizeof (leaf), rdepth + 1, depth2cache(rdepth));
+                err = save_ref (desc, addr, i - 1, n, 0);
                 if (err)
                     return err;
+            }
+            if (depth < BTRFS_MAX_LEVEL)
+                cur->path[depth].iter = i - 1;
+            addr = fsw_u64_le_swap (nodes[i - 1].addr);
+            generation = fsw_u64_le_swap (nodes[i - 1].generation);
+            depth++;
+            continue;
+        }
 
-                DPRINT (L"btrfs: leaf (depth %d) %lx %x %lx\n", depth,
-                        leaf.key.object_id, leaf.key.type, leaf.key.offset);
+        {
+            struct btrfs_leaf_node *leaves = (struct btrfs_leaf_node *) (head + 1);
 
-                if (key_cmp (&leaf.key, key_in) == 0)
-                {
-                    fsw_memcpy (key_out, &leaf.key, sizeof (*key_out));
-                    *outsize = fsw_u32_le_swap (leaf.size);
-                    *outaddr = addr + fsw_u32_le_swap (leaf.offset);
-                    if (desc)
-                        return save_ref (desc, addr - sizeof (head), i,
-                                fsw_u32_le_swap (head.nitems), 1);
-                    return FSW_SUCCESS;
-                }
+            i = key_upper_bound ((uint8_t *) leaves, sizeof (*leaves), n, key_in);
 
-                if (key_cmp (&leaf.key, key_in) > 0)
-                    break;
+            DPRINT (L"btrfs: leaf (depth %d) %d of %d\n", depth, i, n);
 
-                have_last = 1;
-                leaf_last = leaf;
+            /* Remember the path for searches landing in the same leaf.  */
+            if (n > 0 && depth < BTRFS_MAX_LEVEL)
+            {
+                cur->depth = depth + 1;
+                cur->first = leaves[0].key;
+                cur->last = leaves[n - 1].key;
             }
+            else
+                cur->depth = 0;
 
-            if (have_last)
+            if (i == 0)
             {
-                fsw_memcpy (key_out, &leaf_last.key, sizeof (*key_out));
-                *outsize = fsw_u32_le_swap (leaf_last.size);
-                *outaddr = addr + fsw_u32_le_swap (leaf_last.offset);
+                *outsize = 0;
+                *outaddr = 0;
+                fsw_memzero (key_out, sizeof (*key_out));
                 if (desc)
-                    return save_ref (desc, addr - sizeof (head), i - 1,
-                            fsw_u32_le_swap (head.nitems), 1);
+                    return save_ref (desc, addr, -1, n, 1);
                 return FSW_SUCCESS;
             }
-            *outsize = 0;
-            *outaddr = 0;
-            fsw_memzero (key_out, sizeof (*key_out));
+
+            err = leaf_item (vol, addr, head, i - 1, key_out, outaddr, outsize);
+            if (err)
+                return err;
             if (desc)
-                return save_ref (desc, addr - sizeof (head), -1,
-                        fsw_u32_le_swap (head.nitems), 1);
+                return save_ref (desc, addr, i - 1, n, 1);
             return FSW_SUCCESS;
         }
     }
@@ -724,6 +1014,48 @@ static int btrfs_add_multi_device(struct fsw_btrfs_volume *master, struct fsw_vo
     return FSW_SUCCESS;
 }
 
+/* What scan_disks() remembers about each disk: filesystem uuid and devid.  */
+struct btrfs_scan_key {
+    btrfs_uuid_t uuid;
+    uint64_t device_id;
+};
+
+/* The key must fit into scan_disks()' per-disk buffer.  */
+typedef char btrfs_scan_key_fits[sizeof(struct btrfs_scan_key) <= SCAN_KEY_SIZE ? 1 : -1];
+
+static fsw_status_t scan_disks_probe(struct fsw_volume *dev, void *key) {
+    struct btrfs_scan_key *k = key;
+    struct btrfs_superblock sb;
+    fsw_status_t err;
+
+    /* FSW_UNSUPPORTED means no btrfs signature, read errors are passed on */
+    err = btrfs_read_superblock(dev, &sb);
+    if(err)
+        return err;
+    k->uuid[0] = sb.uuid[0];
+    k->uuid[1] = sb.uuid[1];
+    k->uuid[2] = sb.uuid[2];
+    k->uuid[3] = sb.uuid[3];
+    k->device_id = sb.this_device.device_id;
+    return FSW_SUCCESS;
+}
+
+static int scan_disks_match(struct fsw_volume *volg, const void *key) {
+    struct fsw_btrfs_volume *vol = (struct fsw_btrfs_volume *)volg;
+    struct btrfs_scan_key k;
+    int i;
+
+    if(vol->n_devices_attached >= vol->n_devices_allocated)
+        return 0;
+    fsw_memcpy(&k, key, sizeof(k));
+    if(!uuid_eq(vol->uuid, k.uuid))
+        return 0;
+    for( i = 0; i < vol->n_devices_attached; i++)
+        if(k.device_id == vol->devices_attached[i].id)
+            return 0;
+    return 1;
+}
+
 static int scan_disks_hook(struct fsw_volume *volg, struct fsw_volume *slave) {
     struct fsw_btrfs_volume *vol = (struct fsw_btrfs_volume *)volg;
     struct btrfs_superblock sb;
@@ -751,20 +1083,72 @@ static int do_rescan_once(struct fsw_btrfs_volume *vol) {
     if(vol->rescan_once == 0 || vol->n_devices_attached >= vol->n_devices_allocated)
 	return 0;
     vol->rescan_once = 0;
-    return scan_disks(scan_disks_hook, &vol->g);
+    return scan_disks(scan_disks_probe, scan_disks_match, scan_disks_hook, &vol->g);
 }
 
-static struct fsw_volume *
-find_device (struct fsw_btrfs_volume *vol, uint64_t id) {
+static struct fsw_btrfs_device_desc *
+find_device_desc (struct fsw_btrfs_volume *vol, uint64_t id) {
     int i;
 
     for (i = 0; i < vol->n_devices_attached; i++)
 	if (id == vol->devices_attached[i].id)
-	    return vol->devices_attached[i].dev;
+	    return &vol->devices_attached[i];
+    return NULL;
+}
+
+static struct fsw_volume *
+find_device (struct fsw_btrfs_volume *vol, uint64_t id) {
+    struct fsw_btrfs_device_desc *desc = find_device_desc (vol, id);
+
+    if (desc)
+	return desc->dev;
     DPRINT(L"sub device %d not found\n", id);
     return NULL;
 }
 
+/* Choose which of the `redundancy' copies starting at `stripe' to read first.
+ * Devices that failed before come last.  Among the others, prefer one whose
+ * previous read ended where this one starts, so that a sequential stream
+ * stays on one device and keeps hitting the host's read-ahead, otherwise
+ * the one that has read the least so far.  Concurrent streams thus spread
+ * over the mirrors.  */
+static unsigned pick_mirror (struct fsw_btrfs_volume *vol,
+        struct btrfs_chunk_stripe *stripe, unsigned redundancy, uint64_t stripe_offset)
+{
+    struct fsw_btrfs_device_desc *best = NULL;
+    unsigned i, besti = 0;
+    int bestseq = 0;
+
+    for (i = 0; i < redundancy; i++)
+    {
+        struct fsw_btrfs_device_desc *d = find_device_desc (vol, stripe[i].device_id);
+        int seq;
+
+        if (!d)
+            continue;
+        seq = d->reads && d->next_paddr == fsw_u64_le_swap (stripe[i].offset) + stripe_offset;
+        if (best)
+        {
+            if (d->errors != best->errors)
+            {
+                if (d->errors > best->errors)
+                    continue;
+            }
+            else if (seq != bestseq)
+            {
+                if (!seq)
+                    continue;
+            }
+            else if (d->bytes_read >= best->bytes_read)
+                continue;
+        }
+        best = d;
+        besti = i;
+        bestseq = seq;
+    }
+    return besti;
+}
+
 struct stripe_table {
     struct fsw_volume *dev;
     uint64_t off;
@@ -809,22 +1193,40 @@ static uint8_t powx[255 * 2];
 /* Such an s that x**s = y */
 static unsigned powx_inv[256];
 static const uint8_t poly = 0x1d;
+
+/* Product table of x**mul with every byte value.  Building it once per
+ * block replaces the two dependent table walks per byte, and t[0] = 0
+ * removes the test for zero bytes.  */
+static void gf_mul_table (unsigned mul, uint8_t *t)
+{
+    unsigned n;
+
+    mul %= 255;
+    t[0] = 0;
+    for (n = 1; n < 256; n++)
+	t[n] = powx[mul + powx_inv[n]];
+}
+
 static void block_mulx (unsigned mul, char *buf, uint32_t size)
 {
+    uint8_t t[256];
     uint32_t i;
     uint8_t *p = (uint8_t *) buf;
-    for (i = 0; i < size; i++, p++)
-	if (*p)
-	    *p = powx[mul + powx_inv[*p]];
+
+    gf_mul_table (mul, t);
+    for (i = 0; i < size; i++)
+	p[i] = t[p[i]];
 }
 static void block_mulx_xor (char *dst, unsigned mul, const char *buf, uint32_t size)
 {
+    uint8_t t[256];
     uint32_t i;
     const uint8_t *p = (const uint8_t *) buf;
     uint8_t *q = (uint8_t *) dst;
-    for (i = 0; i < size; i++, p++, q++)
-	if (*p)
-	    *q ^= powx[mul + powx_inv[*p]];
+
+    gf_mul_table (mul, t);
+    for (i = 0; i < size; i++)
+	q[i] ^= t[p[i]];
 }
 
 static void raid6_init_table (void)
@@ -855,10 +1257,10 @@ static struct fsw_btrfs_recover_cache *get_recover_cache(struct fsw_btrfs_volume
 	if(fsw_alloc_zero(sizeof(struct fsw_btrfs_recover_cache) * RECOVER_CACHE_SIZE, (void **)&vol->rcache) != FSW_SUCCESS)
 	    return NULL;
     }
-#ifdef __MAKEWITH_TIANO
-    unsigned hash;
-#else
+#ifdef __MAKEWITH_GNUEFI
     UINTN hash;
+#else
+    unsigned hash;
 #endif
     DivU64x32Remainder(((device_id >> 32) | device_id | (offset >> 32) | offset), RECOVER_CACHE_SIZE, &hash);
     struct fsw_btrfs_recover_cache *rc = &vol->rcache[hash];
@@ -874,17 +1276,133 @@ static struct fsw_btrfs_recover_cache *get_recover_cache(struct fsw_btrfs_volume
     return rc;
 }
 
-static fsw_status_t fsw_btrfs_read_logical (struct fsw_btrfs_volume *vol, uint64_t addr,
-        void *buf, fsw_size_t size, int rdepth, int cache_level)
+static struct fsw_btrfs_chunk_map *fsw_btrfs_find_chunk(struct fsw_btrfs_volume *vol, uint64_t addr)
+{
+    unsigned lo = 0, hi = vol->n_chunks;
+
+    /* last chunk starting at or before addr */
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (vol->chunks[mid].start <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0 || addr - vol->chunks[lo - 1].start >= vol->chunks[lo - 1].size)
+        return NULL;
+    return &vol->chunks[lo - 1];
+}
+
+static fsw_status_t fsw_btrfs_add_chunk(struct fsw_btrfs_volume *vol, uint64_t start,
+        struct btrfs_chunk_item *chunk, fsw_size_t chsize)
+{
+    struct fsw_btrfs_chunk_map *map;
+    struct btrfs_chunk_item *chunk_copy;
+    unsigned lo = 0, hi = vol->n_chunks, i;
+
+    if (chsize < (fsw_size_t) sizeof (*chunk)
+            || chsize < (fsw_size_t) (sizeof (*chunk) + sizeof (struct btrfs_chunk_stripe)
+                * fsw_u16_le_swap (chunk->nstripes))
+            || fsw_u16_le_swap (chunk->nstripes) == 0
+            || fsw_u64_le_swap (chunk->size) == 0)
+        return FSW_VOLUME_CORRUPTED;
+
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (vol->chunks[mid].start < start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    /* system chunks show up in the chunk tree as well */
+    if (lo < vol->n_chunks && vol->chunks[lo].start == start)
+        return FSW_SUCCESS;
+
+    if (vol->n_chunks == vol->n_chunks_allocated)
+    {
+        unsigned n = vol->n_chunks_allocated ? vol->n_chunks_allocated * 2 : 16;
+
+        map = AllocatePool (sizeof (*map) * n);
+        if (!map)
+            return FSW_OUT_OF_MEMORY;
+        if (vol->chunks)
+        {
+            fsw_memcpy (map, vol->chunks, sizeof (*map) * vol->n_chunks);
+            FreePool (vol->chunks);
+        }
+        vol->chunks = map;
+        vol->n_chunks_allocated = n;
+    }
+
+    map = &vol->chunks[lo];
+    chunk_copy = AllocatePool (chsize);
+    if (!chunk_copy)
+        return FSW_OUT_OF_MEMORY;
+    fsw_memcpy (chunk_copy, chunk, chsize);
+    /* the chunk tree comes in order, so this rarely moves anything */
+    for (i = vol->n_chunks; i > lo; i--)
+        vol->chunks[i] = vol->chunks[i - 1];
+    map->chunk = chunk_copy;
+    map->start = start;
+    map->size = fsw_u64_le_swap (chunk->size);
+    vol->n_chunks++;
+    return FSW_SUCCESS;
+}
+
+static void fsw_btrfs_free_chunks(struct fsw_btrfs_volume *vol)
+{
+    unsigned i;
+
+    for (i = 0; i < vol->n_chunks; i++)
+        FreePool (vol->chunks[i].chunk);
+    if (vol->chunks)
+        FreePool (vol->chunks);
+    vol->chunks = NULL;
+    vol->n_chunks = vol->n_chunks_allocated = 0;
+}
+
+/* Check size bytes read from logical address addr, see BTRFS_CHECK_*.  */
+static fsw_status_t fsw_btrfs_check_read (struct fsw_btrfs_volume *vol, int check,
+        uint64_t addr, const uint8_t *buf, uint64_t size)
+{
+    struct btrfs_header *head = (struct btrfs_header *) buf;
+
+    if (check == BTRFS_CHECK_DATA)
+        return fsw_btrfs_verify_data (vol, addr, buf, size);
+    if (check == BTRFS_CHECK_NODE
+            && grub_getcrc32c (0, buf + sizeof (head->checksum), size - sizeof (head->checksum))
+            != fsw_u32_le_swap (*(uint32_t *) head->checksum))
+    {
+        DPRINT (L"btrfs: checksum mismatch in tree block %lx\n", addr);
+        return FSW_VOLUME_CORRUPTED;
+    }
+    return FSW_SUCCESS;
+}
+
+/* Read size bytes from logical address addr.  With a check other than
+ * BTRFS_CHECK_NONE every copy read from a mirrored chunk is checked, and a
+ * copy that fails moves on to the next one.  BTRFS_CHECK_DATA needs addr and
+ * size to be multiples of the sector size.  */
+static fsw_status_t fsw_btrfs_read_logical_checked (struct fsw_btrfs_volume *vol, uint64_t addr,
+        void *buf, fsw_size_t size, int rdepth, int cache_level, int check)
 {
     struct stripe_table *stripe_table = NULL;
     int challoc = 0;
     struct btrfs_chunk_item *chunk = NULL;
     fsw_status_t err = 0;
+    /* a tree block split over chunks or stripes is checked once it is complete */
+    uint64_t addr0 = addr;
+    void *buf0 = buf;
+    fsw_size_t size0 = size;
+    int node_checked = 0;
+
     while (size > 0)
     {
-        uint8_t *ptr;
+        struct fsw_btrfs_chunk_map *map;
         struct btrfs_key *key;
+        uint64_t chstart;
         uint64_t csize;
         struct btrfs_key key_out;
         struct btrfs_key key_in;
@@ -892,23 +1410,15 @@ static fsw_status_t fsw_btrfs_read_logical (struct fsw_btrfs_volume *vol, uint64
         uint64_t chaddr;
 
 	err = 0;
-        for (ptr = vol->bootstrap_mapping; ptr < vol->bootstrap_mapping + sizeof (vol->bootstrap_mapping) - sizeof (struct btrfs_key);)
+        map = fsw_btrfs_find_chunk (vol, addr);
+        if (map)
         {
-            key = (struct btrfs_key *) ptr;
-            if (key->type != GRUB_BTRFS_ITEM_TYPE_CHUNK)
-                break;
-            chunk = (struct btrfs_chunk_item *) (key + 1);
-            if (fsw_u64_le_swap (key->offset) <= addr
-                    && addr < fsw_u64_le_swap (key->offset)
-                    + fsw_u64_le_swap (chunk->size))
-            {
-                goto chunk_found;
-            }
-            ptr += sizeof (*key) + sizeof (*chunk)
-                + sizeof (struct btrfs_chunk_stripe)
-                * fsw_u16_le_swap (chunk->nstripes);
+            chunk = map->chunk;
+            chstart = map->start;
+            goto chunk_found;
         }
 
+        /* Not in the chunk map, look it up in the chunk tree.  */
         key_in.object_id = fsw_u64_le_swap (GRUB_BTRFS_OBJECT_ID_CHUNK);
         key_in.type = GRUB_BTRFS_ITEM_TYPE_CHUNK;
         key_in.offset = fsw_u64_le_swap (addr);
@@ -922,6 +1432,7 @@ static fsw_status_t fsw_btrfs_read_logical (struct fsw_btrfs_volume *vol, uint64
             return FSW_VOLUME_CORRUPTED;
         }
         // "couldn't find the chunk descriptor");
+        chstart = fsw_u64_le_swap (key->offset);
 
         chunk = AllocatePool (chsize);
         if (!chunk) {
@@ -932,6 +1443,8 @@ static fsw_status_t fsw_btrfs_read_logical (struct fsw_btrfs_volume *vol, uint64
         err = fsw_btrfs_read_logical (vol, chaddr, chunk, chsize, rdepth, cache_level < 5 ? cache_level+1 : 5);
         if (err)
 	    goto io_error;
+        /* remember it, a failure here only costs another lookup */
+        fsw_btrfs_add_chunk (vol, chstart, chunk, chsize);
 
 chunk_found:
         {
@@ -945,7 +1458,7 @@ chunk_found:
             UINTREM stripen;
             UINTREM stripeq;
             UINTREM stripe_offset;
-            uint64_t off = addr - fsw_u64_le_swap (key->offset);
+            uint64_t off = addr - chstart;
             unsigned redundancy = 1;
             unsigned i;
 
@@ -956,7 +1469,7 @@ chunk_found:
 	    uint16_t nstripes = fsw_u16_le_swap (chunk->nstripes);
 
             DPRINT(L"btrfs chunk 0x%lx+0xlx %d stripes (%d substripes) of %lx\n",
-                    fsw_u64_le_swap (key->offset),
+                    chstart,
                     fsw_u64_le_swap (chunk->size),
                     nstripes,
                     fsw_u16_le_swap (chunk->nsubstripes),
@@ -1073,23 +1586,28 @@ chunk_found:
                 csize = size;
 
 	    if(redundancy < RAID5_TAG) {
+		unsigned first;
+
 begin_direct_read:
 		err = 0;
-                for (i = 0; !err && i < redundancy; i++)
+		first = pick_mirror (vol, (struct btrfs_chunk_stripe *) (chunk + 1) + stripen,
+			redundancy, stripe_offset);
+                for (i = 0; i < redundancy; i++)
                 {
                     struct btrfs_chunk_stripe *stripe;
+                    struct fsw_btrfs_device_desc *desc;
                     uint64_t paddr;
                     struct fsw_volume *dev;
 
                     stripe = (struct btrfs_chunk_stripe *) (chunk + 1);
-                    /* Right now the redundancy handling is easy.
-                       With RAID5-like it will be more difficult.  */
-                    stripe += stripen + i;
+                    /* Start with the preferred copy, fall back to the others
+                       on a missing device or a read error.  */
+                    stripe += stripen + (first + i) % redundancy;
 
                     paddr = fsw_u64_le_swap (stripe->offset) + stripe_offset;
 
                     DPRINT (L"btrfs: chunk 0x%lx+0x%lx (%d stripes (%d substripes) of %lx) stripe %lx maps to 0x%lx\n",
-                            fsw_u64_le_swap (key->offset),
+                            chstart,
                             fsw_u64_le_swap (chunk->size),
                             nstripes,
                             fsw_u16_le_swap (chunk->nsubstripes),
@@ -1097,9 +1615,13 @@ begin_direct_read:
                             stripen, stripe->offset);
                     DPRINT (L"btrfs: reading paddr 0x%lx for laddr 0x%lx\n", paddr, addr);
 
-                    dev = find_device (vol, stripe->device_id);
-                    if (!dev)
+                    desc = find_device_desc (vol, stripe->device_id);
+                    if (!desc) {
+                        DPRINT(L"sub device %d not found\n", stripe->device_id);
                         continue;
+                    }
+                    dev = desc->dev;
+                    err = 0;
 
                     uint32_t off = paddr & (vol->sectorsize - 1);
                     paddr >>= vol->sectorshift;
@@ -1121,8 +1643,23 @@ begin_direct_read:
                     }
                     DPRINT (L"read logical: err %d csize %d got %d\n",
                                     err, csize, n);
-                    if(n>=csize)
+                    if(n>=csize) {
+                        /* a copy failing its checksum counts like a read error */
+                        if(check == BTRFS_CHECK_DATA
+                                || (check == BTRFS_CHECK_NODE && addr == addr0 && csize == size)) {
+                            err = fsw_btrfs_check_read (vol, check, addr, buf, csize);
+                            if(err) {
+                                desc->errors++;
+                                continue;
+                            }
+                            node_checked = 1;
+                        }
+                        desc->reads++;
+                        desc->bytes_read += csize;
+                        desc->next_paddr = fsw_u64_le_swap (stripe->offset) + stripe_offset + csize;
                         break;
+                    }
+                    desc->errors++;
                 }
                 if (i == redundancy) {
 		    if(do_rescan_once(vol) > 0)
@@ -1275,6 +1812,12 @@ begin_direct_read:
 		    stripe_offset++;
                     DPRINT (L"read logical: err %d csize %d got %d\n", err, csize, n);
                 }
+		// no other copy to fall back to
+		if(check == BTRFS_CHECK_DATA) {
+		    err = fsw_btrfs_check_read (vol, check, addr, buf, csize);
+		    if(err)
+			goto io_error;
+		}
 	    }
         }
         size -= csize;
@@ -1287,6 +1830,8 @@ begin_direct_read:
 	    fsw_free(stripe_table);
 	stripe_table = NULL;
     }
+    if (check == BTRFS_CHECK_NODE && !node_checked)
+        return fsw_btrfs_check_read (vol, check, addr0, buf0, size0);
     return FSW_SUCCESS;
 
 volume_corrupted:
@@ -1299,7 +1844,166 @@ io_error:
     return err;
 }
 
+/* Map a logical address to a run of sectors on the mounted device itself,
+ * so that file data can be read through the block cache without a bounce
+ * buffer.  Only chunks holding a single copy qualify, mirrored and parity
+ * profiles go through fsw_btrfs_read_logical to keep their recovery.
+ * Returns 1 and the physical address and length of the run, or 0.  */
+static int fsw_btrfs_map_direct(struct fsw_btrfs_volume *vol, uint64_t addr,
+        uint64_t *paddr_out, uint64_t *len_out)
+{
+    struct fsw_btrfs_chunk_map *map;
+    struct btrfs_chunk_item *chunk;
+    struct btrfs_chunk_stripe *stripe;
+    uint64_t off, stripe_length, len, paddr;
+    uint16_t nstripes;
+    UINTREM stripen;
+    UINTREM stripe_offset;
+
+    map = fsw_btrfs_find_chunk (vol, addr);
+    if (!map || vol->n_devices_attached == 0
+            || vol->devices_attached[0].dev != &vol->g)
+        return 0;
+    chunk = map->chunk;
+    off = addr - map->start;
+    nstripes = fsw_u16_le_swap (chunk->nstripes);
+
+    switch (fsw_u64_le_swap (chunk->type) & ~GRUB_BTRFS_CHUNK_TYPE_BITS_DONTCARE)
+    {
+        case GRUB_BTRFS_CHUNK_TYPE_SINGLE:
+            stripe_length = DivU64x32 (fsw_u64_le_swap (chunk->size), nstripes, NULL);
+            if (stripe_length == 0 || stripe_length >= 1ULL<<32)
+                return 0;
+            stripen = DivU64x32 (off, (uint32_t)stripe_length, &stripe_offset);
+            len = stripe_length - stripe_offset;
+            break;
+        case GRUB_BTRFS_CHUNK_TYPE_RAID0:
+            {
+                uint64_t middle, high;
+                UINTREM low;
+
+                stripe_length = fsw_u64_le_swap (chunk->stripe_length);
+                if (stripe_length == 0 || stripe_length > 1UL<<30)
+                    return 0;
+                middle = DivU64x32 (off, (uint32_t)stripe_length, &low);
+                high = DivU64x32 (middle, nstripes, &stripen);
+                stripe_offset = low + stripe_length * high;
+                len = stripe_length - low;
+                break;
+            }
+        default:
+            return 0;
+    }
+    if (stripen >= nstripes)
+        return 0;
+
+    stripe = (struct btrfs_chunk_stripe *) (chunk + 1) + stripen;
+    if (stripe->device_id != vol->devices_attached[0].id)
+        return 0;
+    paddr = fsw_u64_le_swap (stripe->offset) + stripe_offset;
+    if (paddr & (vol->sectorsize - 1))
+        return 0;
+
+    *paddr_out = paddr;
+    *len_out = len;
+    return 1;
+}
+
+/* Build the chunk map: the system chunks from the superblock, which are
+ * enough to read the chunk tree, then every chunk item in the chunk tree.  */
+static fsw_status_t fsw_btrfs_load_chunks(struct fsw_btrfs_volume *vol)
+{
+    struct fsw_btrfs_leaf_descriptor desc;
+    struct btrfs_key key_in, key_out;
+    struct btrfs_chunk_item *chunk;
+    uint64_t elemaddr;
+    fsw_size_t elemsize;
+    uint8_t *ptr;
+    fsw_status_t err;
+    int r;
+
+    for (ptr = vol->bootstrap_mapping; ptr < vol->bootstrap_mapping + sizeof (vol->bootstrap_mapping) - sizeof (struct btrfs_key);)
+    {
+        struct btrfs_key *key = (struct btrfs_key *) ptr;
+        fsw_size_t chsize;
+
+        if (key->type != GRUB_BTRFS_ITEM_TYPE_CHUNK)
+            break;
+        chunk = (struct btrfs_chunk_item *) (key + 1);
+        chsize = sizeof (*chunk) + sizeof (struct btrfs_chunk_stripe)
+            * fsw_u16_le_swap (chunk->nstripes);
+        if ((uint8_t *) chunk + chsize > vol->bootstrap_mapping + sizeof (vol->bootstrap_mapping))
+            return FSW_VOLUME_CORRUPTED;
+        err = fsw_btrfs_add_chunk (vol, fsw_u64_le_swap (key->offset), chunk, chsize);
+        if (err)
+            return err;
+        ptr += sizeof (*key) + chsize;
+    }
+
+    key_in.object_id = fsw_u64_le_swap (GRUB_BTRFS_OBJECT_ID_CHUNK);
+    key_in.type = GRUB_BTRFS_ITEM_TYPE_CHUNK;
+    key_in.offset = 0;
+    err = lower_bound (vol, &key_in, &key_out, vol->chunk_tree, &elemaddr, &elemsize, &desc, 0);
+    if (err)
+        return err;
+
+    chunk = NULL;
+    r = 1;
+    if (key_cmp (&key_out, &key_in) < 0)
+        r = next (vol, &desc, &elemaddr, &elemsize, &key_out);
+    for (; r > 0; r = next (vol, &desc, &elemaddr, &elemsize, &key_out))
+    {
+        if (key_out.object_id != key_in.object_id || key_out.type != key_in.type)
+            break;
+        if (elemsize < (fsw_size_t) sizeof (*chunk))
+        {
+            r = -FSW_VOLUME_CORRUPTED;
+            break;
+        }
+        chunk = AllocatePool (elemsize);
+        if (!chunk)
+        {
+            r = -FSW_OUT_OF_MEMORY;
+            break;
+        }
+        err = fsw_btrfs_read_logical (vol, elemaddr, chunk, elemsize, 0, 1);
+        if (!err)
+            err = fsw_btrfs_add_chunk (vol, fsw_u64_le_swap (key_out.offset), chunk, elemsize);
+        FreePool (chunk);
+        if (err)
+        {
+            r = -err;
+            break;
+        }
+    }
+    free_iterator (&desc);
+
+    return r < 0 ? -r : FSW_SUCCESS;
+}
+
+/* Only the primary superblock signature, as btrfs_read_superblock() gives up
+ * when that one is missing.  */
+static fsw_status_t fsw_btrfs_volume_sniff(void *host_data, fsw_sniff_read_t read) {
+    struct {
+        btrfs_checksum_t checksum;
+        btrfs_uuid_t uuid;
+        uint8_t dummy[0x10];
+        uint8_t signature[sizeof (GRUB_BTRFS_SIGNATURE) - 1];
+    } __attribute__ ((__packed__)) head;
+    fsw_status_t err;
+
+    err = read(host_data, superblock_pos[0] * BTRFS_DEFAULT_BLOCK_SIZE, sizeof(head), &head);
+    if (err)
+        return err;
+    if (!fsw_memeq (head.signature, GRUB_BTRFS_SIGNATURE,
+                sizeof (GRUB_BTRFS_SIGNATURE) - 1))
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 static fsw_status_t fsw_btrfs_get_default_root(struct fsw_btrfs_volume *vol, uint64_t root_dir_objectid);
+static fsw_status_t fsw_btrfs_get_root_tree(struct fsw_btrfs_volume *vol,
+        struct btrfs_key *key_in, uint64_t *tree_out);
 static fsw_status_t fsw_btrfs_volume_mount(struct fsw_volume *volg) {
     struct btrfs_superblock sblock;
     struct fsw_btrfs_volume *vol = (struct fsw_btrfs_volume *)volg;
@@ -1319,6 +2023,10 @@ static fsw_status_t fsw_btrfs_volume_mount(struct fsw_volume *volg) {
     if(vol->sectorshift == 0)
         return FSW_UNSUPPORTED;
 
+    if(vol->nodesize < vol->sectorsize || vol->nodesize > 0x10000
+            || (vol->nodesize & (vol->nodesize - 1)))
+        return FSW_UNSUPPORTED;
+
     if(vol->num_devices >= BTRFS_MAX_NUM_DEVICES)
         return FSW_UNSUPPORTED;
 
@@ -1340,7 +2048,7 @@ static fsw_status_t fsw_btrfs_volume_mount(struct fsw_volume *volg) {
     fsw_set_blocksize(volg, vol->sectorsize, vol->sectorsize);
     vol->n_devices_allocated = vol->num_devices;
     vol->rescan_once = vol->num_devices > 1;
-    err = fsw_alloc(sizeof(struct fsw_btrfs_device_desc) * vol->n_devices_allocated,
+    err = fsw_alloc_zero(sizeof(struct fsw_btrfs_device_desc) * vol->n_devices_allocated,
 	(void **)&vol->devices_attached);
     if (err)
         return err;
@@ -1349,6 +2057,12 @@ static fsw_status_t fsw_btrfs_volume_mount(struct fsw_volume *volg) {
     vol->devices_attached[0].dev = volg;
     vol->devices_attached[0].id = sblock.this_device.device_id;
 
+    /* Chunks missing from the map are still looked up in the chunk tree
+     * on demand, so a failure here is not fatal.  */
+    err = fsw_btrfs_load_chunks(vol);
+    if (err)
+        DPRINT(L"btrfs: chunk map incomplete, err %d\n", err);
+
     for (i = 0; i < 0x100; i++)
         if (sblock.label[i] == 0)
             break;
@@ -1371,9 +2085,22 @@ static fsw_status_t fsw_btrfs_volume_mount(struct fsw_volume *volg) {
         return err;
     }
 
+    /* Without a checksum tree, file data is read unchecked.  */
+    if (vol->verify_csum) {
+        struct btrfs_key csum_root_key;
+
+        csum_root_key.object_id = fsw_u64_le_swap(GRUB_BTRFS_OBJECT_ID_CSUM_TREE);
+        csum_root_key.type = GRUB_BTRFS_ITEM_TYPE_ROOT_ITEM;
+        csum_root_key.offset = -1LL;
+        if (fsw_btrfs_get_root_tree (vol, &csum_root_key, &vol->csum_tree))
+            vol->csum_tree = 0;
+    }
+
     return FSW_SUCCESS;
 }
 
+static void fsw_btrfs_decomp_evict(struct fsw_btrfs_decomp_cache *dc);
+static void zstd_pool_free(struct fsw_btrfs_zstd_pool *pool);
 static void fsw_btrfs_volume_free(struct fsw_volume *volg)
 {
     unsigned i;
@@ -1382,10 +2109,19 @@ static void fsw_btrfs_volume_free(struct fsw_volume *volg)
     if (vol==NULL)
         return;
 
-    if (vol->is_master)
+    if (vol->is_master) {
         master_uuid_remove(vol);
+        if (master_uuid_list == NULL)
+            scan_map_free();
+    }
 
     if(vol->devices_attached) {
+	for (i = 0; i < vol->n_devices_attached; i++)
+	    DPRINT(L"btrfs: device %ld read %ld bytes in %d reads, %d errors\n",
+		    fsw_u64_le_swap(vol->devices_attached[i].id),
+		    vol->devices_attached[i].bytes_read,
+		    vol->devices_attached[i].reads,
+		    vol->devices_attached[i].errors);
 	/* The device 0 is closed one layer upper.  */
 	for (i = 1; i < vol->n_devices_attached; i++) {
 	    if(vol->devices_attached[i].dev)
@@ -1393,8 +2129,16 @@ static void fsw_btrfs_volume_free(struct fsw_volume *volg)
 	}
 	FreePool (vol->devices_attached);
     }
-    if(vol->extent)
-        FreePool (vol->extent);
+    fsw_btrfs_free_chunks(vol);
+    if(vol->ncache) {
+	for(i = 0; i < NODE_CACHE_SIZE; i++)
+	    if(vol->ncache[i].data)
+		FreePool(vol->ncache[i].data);
+	FreePool(vol->ncache);
+    }
+    for(i = 0; i < DECOMP_CACHE_SIZE; i++)
+	fsw_btrfs_decomp_evict(&vol->dcache[i]);
+    zstd_pool_free(&vol->zpool);
     if(vol->rcache) {
 	for(i = 0; i < RECOVER_CACHE_SIZE; i++)
 	    if(vol->rcache->buffer)
@@ -1478,11 +2222,14 @@ static fsw_status_t fsw_btrfs_dnode_fill(struct fsw_volume *volg, struct fsw_dno
     return FSW_SUCCESS;
 }
 
+static void fsw_btrfs_free_extents(struct fsw_btrfs_dnode *dno);
+
 static void fsw_btrfs_dnode_free(struct fsw_volume *volg, struct fsw_dnode *dnog)
 {
     struct fsw_btrfs_dnode *dno = (struct fsw_btrfs_dnode *)dnog;
     if (dno->raw)
         FreePool(dno->raw);
+    fsw_btrfs_free_extents(dno);
 }
 
 static fsw_status_t fsw_btrfs_dnode_stat(struct fsw_volume *volg, struct fsw_dnode *dnog, struct fsw_dnode_stat *sb)
@@ -1509,115 +2256,684 @@ static fsw_status_t fsw_btrfs_dnode_stat(struct fsw_volume *volg, struct fsw_dno
     return FSW_SUCCESS;
 }
 
-static fsw_ssize_t grub_btrfs_lzo_decompress(char *ibuf, fsw_size_t isize, grub_off_t off,
-        char *obuf, fsw_size_t osize)
+/* zlib stream as written by btrfs, decoded by the inflater shared with the
+ * gzip loader support.  Like the kernel, a zlib header without a preset
+ * dictionary is skipped and the data inflated raw, so the adler32 trailer is
+ * never computed.  */
+struct btrfs_zlib_stream
 {
-    uint32_t total_size, cblock_size;
-    fsw_size_t ret = 0;
-    unsigned char buf[GRUB_BTRFS_LZO_BLOCK_SIZE];
-    char *ibuf0 = ibuf;
+    struct z_stream_s strm;
+    int done;
+};
 
-#define fsw_get_unaligned32(x) (*(uint32_t *)(x))
-    total_size = fsw_u32_le_swap (fsw_get_unaligned32(ibuf));
-    ibuf += sizeof (total_size);
+static fsw_status_t btrfs_zlib_open(struct btrfs_zlib_stream *zs, char *ibuf, fsw_size_t isize)
+{
+    unsigned char *p = (unsigned char *) ibuf;
+    int wbits = MAX_WBITS;
 
-    if (isize < total_size)
-        return -1;
+    zs->strm.workspace = AllocatePool (zlib_inflate_workspacesize ());
+    if (!zs->strm.workspace)
+        return FSW_OUT_OF_MEMORY;
+    zs->strm.next_in = p;
+    zs->strm.avail_in = isize;
+    zs->done = 0;
+    if (isize > 2 && (p[0] & 0x0f) == Z_DEFLATED && !(p[1] & PRESET_DICT)
+            && ((p[0] << 8) + p[1]) % 31 == 0)
+    {
+        wbits = -((p[0] >> 4) + 8);
+        zs->strm.next_in += 2;
+        zs->strm.avail_in -= 2;
+    }
+    if (zlib_inflateInit2 (&zs->strm, wbits) != Z_OK)
+    {
+        FreePool (zs->strm.workspace);
+        return FSW_VOLUME_CORRUPTED;
+    }
+    return FSW_SUCCESS;
+}
+
+/* Inflate up to osize bytes.  Given room for the whole extent the data is
+ * written straight to obuf and the window is never touched; smaller reads
+ * resume from the window on the next call.  */
+static fsw_ssize_t btrfs_zlib_read(struct btrfs_zlib_stream *zs, char *obuf, fsw_size_t osize)
+{
+    int ret;
 
-    /* Jump forward to first block with requested data.  */
-    while (off >= GRUB_BTRFS_LZO_BLOCK_SIZE)
+    if (zs->done || osize <= 0)
+        return 0;
+    zs->strm.next_out = (unsigned char *) obuf;
+    zs->strm.avail_out = osize;
+    ret = zlib_inflate (&zs->strm, Z_SYNC_FLUSH);
+    /* Z_BUF_ERROR: the input ran out before the end of the stream.  */
+    if (ret == Z_STREAM_END || ret == Z_BUF_ERROR)
+        zs->done = 1;
+    else if (ret != Z_OK)
     {
-        /* Don't let following uint32_t cross the page boundary.  */
-        if (((ibuf - ibuf0) & 0xffc) == 0xffc)
-            ibuf = ((ibuf - ibuf0 + 3) & ~3) + ibuf0;
+        DPRINT (L"BTRFS: zlib_inflate returned %d\n", ret);
+        return -1;
+    }
+    return osize - zs->strm.avail_out;
+}
 
-        cblock_size = fsw_u32_le_swap (fsw_get_unaligned32 (ibuf));
-        ibuf += sizeof (cblock_size);
+static void btrfs_zlib_close(struct btrfs_zlib_stream *zs)
+{
+    FreePool (zs->strm.workspace);
+}
 
-        if (cblock_size > GRUB_BTRFS_LZO_BLOCK_MAX_CSIZE)
-            return -1;
+/* LZO stream as written by btrfs: a 32-bit total size followed by segments of
+ * a 32-bit compressed length and the LZO data of one 4 KiB page, only the
+ * last one may be shorter.  The stream position and a partially consumed page
+ * are kept between reads.  */
+struct btrfs_lzo_stream
+{
+    char *ibuf;
+    uint32_t total_size;
+    uint32_t ipos;
+    uint32_t seg;       /* index of the segment at ipos */
+    uint32_t page_len;
+    uint32_t page_pos;
+    unsigned char page[GRUB_BTRFS_LZO_BLOCK_SIZE];
+};
 
-        off -= GRUB_BTRFS_LZO_BLOCK_SIZE;
-        ibuf += cblock_size;
-    }
+#define fsw_get_unaligned32(x) (*(uint32_t *)(x))
+static fsw_status_t btrfs_lzo_open(struct btrfs_lzo_stream *ls, char *ibuf, fsw_size_t isize)
+{
+    if (isize < (fsw_size_t) sizeof (uint32_t))
+        return FSW_VOLUME_CORRUPTED;
+    ls->ibuf = ibuf;
+    ls->total_size = fsw_u32_le_swap (fsw_get_unaligned32(ibuf));
+    ls->ipos = sizeof (uint32_t);
+    ls->seg = 0;
+    ls->page_len = ls->page_pos = 0;
+    if ((uint32_t) isize < ls->total_size)
+        return FSW_VOLUME_CORRUPTED;
+    return FSW_SUCCESS;
+}
 
-    while (osize > 0)
-    {
-        lzo_uint usize = GRUB_BTRFS_LZO_BLOCK_SIZE;
+/* Length of the segment at ls->ipos, which is moved past the header.  Returns
+ * 1, 0 at the end of the stream or -1.  */
+static int btrfs_lzo_segment(struct btrfs_lzo_stream *ls, uint32_t *cblock_size)
+{
+    /* Don't let following uint32_t cross the page boundary.  */
+    if ((ls->ipos & 0xffc) == 0xffc)
+        ls->ipos = (ls->ipos + 3) & ~3;
+
+    if (ls->ipos + sizeof (*cblock_size) > ls->total_size)
+        return 0;
+    *cblock_size = fsw_u32_le_swap (fsw_get_unaligned32 (ls->ibuf + ls->ipos));
+    ls->ipos += sizeof (*cblock_size);
+
+    if (*cblock_size > GRUB_BTRFS_LZO_BLOCK_MAX_CSIZE
+            || ls->ipos + *cblock_size > ls->total_size)
+        return -1;
+    return 1;
+}
 
-        /* Don't let following uint32_t cross the page boundary.  */
-        if (((ibuf - ibuf0) & 0xffc) == 0xffc)
-            ibuf = ((ibuf - ibuf0 + 3) & ~3) + ibuf0;
+/* Decompress the next segment to obuf, which has room for a whole page.  */
+static int btrfs_lzo_decode(struct btrfs_lzo_stream *ls, unsigned char *obuf, lzo_uint *usize)
+{
+    uint32_t cblock_size;
+    int ret;
+
+    ret = btrfs_lzo_segment (ls, &cblock_size);
+    if (ret <= 0)
+        return ret;
+    *usize = GRUB_BTRFS_LZO_BLOCK_SIZE;
+    if (lzo1x_decompress_safe ((lzo_bytep)ls->ibuf + ls->ipos, cblock_size,
+                obuf, usize, NULL) != 0)
+        return -1;
+    ls->ipos += cblock_size;
+    ls->seg++;
+    return 1;
+}
 
-        cblock_size = fsw_u32_le_swap (fsw_get_unaligned32 (ibuf));
-        ibuf += sizeof (cblock_size);
+/* Decompress the next osize bytes, returns the number of bytes produced
+ * (short only at the end of the stream) or -1.  */
+static fsw_ssize_t btrfs_lzo_read(struct btrfs_lzo_stream *ls, char *obuf, fsw_size_t osize)
+{
+    fsw_size_t ret = 0;
+    int r = 1;
 
-        if (cblock_size > GRUB_BTRFS_LZO_BLOCK_MAX_CSIZE)
-            return -1;
+    while (osize > 0)
+    {
+        lzo_uint usize;
 
-        /* Block partially filled with requested data.  */
-        if (off > 0 || osize < GRUB_BTRFS_LZO_BLOCK_SIZE)
+        /* Rest of the page decompressed by the previous read.  */
+        if (ls->page_pos < ls->page_len)
         {
-            fsw_size_t to_copy = GRUB_BTRFS_LZO_BLOCK_SIZE - off;
+            fsw_size_t to_copy = ls->page_len - ls->page_pos;
 
             if (to_copy > osize)
                 to_copy = osize;
-
-            if (lzo1x_decompress_safe ((lzo_bytep)ibuf, cblock_size, (lzo_bytep)buf, &usize, NULL) != 0)
-                return -1;
-
-            if (to_copy > usize)
-                to_copy = usize;
-            fsw_memcpy(obuf, buf + off, to_copy);
-
+            fsw_memcpy(obuf, ls->page + ls->page_pos, to_copy);
+            ls->page_pos += to_copy;
             osize -= to_copy;
             ret += to_copy;
             obuf += to_copy;
-            ibuf += cblock_size;
-            off = 0;
             continue;
         }
 
-        /* Decompress whole block directly to output buffer.  */
-        if (lzo1x_decompress_safe ((lzo_bytep)ibuf, cblock_size, (lzo_bytep)obuf, &usize, NULL) != 0)
-            return -1;
+        if (osize < GRUB_BTRFS_LZO_BLOCK_SIZE)
+        {
+            /* Block partially filled with requested data.  */
+            r = btrfs_lzo_decode (ls, ls->page, &usize);
+            if (r <= 0)
+                break;
+            ls->page_len = usize;
+            ls->page_pos = 0;
+        }
+        else
+        {
+            /* Decompress whole block directly to output buffer.  */
+            r = btrfs_lzo_decode (ls, (unsigned char *)obuf, &usize);
+            if (r <= 0)
+                break;
+            osize -= usize;
+            ret += usize;
+            obuf += usize;
+        }
+    }
+
+    return r < 0 ? -1 : ret;
+}
+
+/* Move the stream to byte pos of the decompressed data.  The segments in
+ * front of it are stepped over by their length headers without being
+ * decompressed, only the one holding pos is.  */
+static fsw_status_t btrfs_lzo_seek(struct btrfs_lzo_stream *ls, uint32_t pos)
+{
+    uint32_t seg = pos / GRUB_BTRFS_LZO_BLOCK_SIZE;
+    uint32_t cblock_size;
+    lzo_uint usize;
 
-        osize -= usize;
-        ret += usize;
-        obuf += usize;
-        ibuf += cblock_size;
+    if (seg < ls->seg)
+    {
+        ls->ipos = sizeof (uint32_t);
+        ls->seg = 0;
+    }
+    ls->page_len = ls->page_pos = 0;
+    while (ls->seg < seg)
+    {
+        if (btrfs_lzo_segment (ls, &cblock_size) <= 0)
+            return FSW_VOLUME_CORRUPTED;
+        ls->ipos += cblock_size;
+        ls->seg++;
     }
 
-    return ret;
+    pos %= GRUB_BTRFS_LZO_BLOCK_SIZE;
+    if (pos)
+    {
+        if (btrfs_lzo_decode (ls, ls->page, &usize) <= 0 || usize < pos)
+            return FSW_VOLUME_CORRUPTED;
+        ls->page_len = usize;
+        ls->page_pos = pos;
+    }
+    return FSW_SUCCESS;
 }
 
 #include "fsw_btrfs_zstd.h"
 
-typedef fsw_ssize_t (*decompressor_t)(char *ibuf, fsw_size_t isize, grub_off_t off, char *obuf, fsw_size_t osize);
-static decompressor_t btrfs_decompressor_table[GRUB_BTRFS_COMPRESSION_MAX] = {
-	grub_zlib_decompress,
-	grub_btrfs_lzo_decompress,
-	zstd_decompress,
+/* Decompression state of one compressed extent, kept open while the extent
+ * is read so that every byte is decompressed exactly once.  */
+struct btrfs_decomp_stream
+{
+    uint8_t compression;
+    struct fsw_btrfs_zstd_pool *zpool;
+    union
+    {
+        struct btrfs_zlib_stream zlib;
+        struct btrfs_lzo_stream lzo;
+        struct zstd_stream zstd;
+    };
+    uint64_t pos;       /* uncompressed bytes produced so far */
 };
 
+static fsw_status_t btrfs_stream_open(struct btrfs_decomp_stream *ds, uint8_t comp,
+        char *ibuf, fsw_size_t isize, struct fsw_btrfs_zstd_pool *zpool)
+{
+    ds->compression = comp;
+    ds->zpool = zpool;
+    ds->pos = 0;
+    switch (comp)
+    {
+        case GRUB_BTRFS_COMPRESSION_ZLIB:
+            return btrfs_zlib_open (&ds->zlib, ibuf, isize);
+        case GRUB_BTRFS_COMPRESSION_LZO:
+            return btrfs_lzo_open (&ds->lzo, ibuf, isize);
+        case GRUB_BTRFS_COMPRESSION_ZSTD:
+            return zstd_stream_open (&ds->zstd, zpool, ibuf, isize);
+    }
+    return FSW_UNSUPPORTED;
+}
+
+/* Continue decompression with the next osize bytes, returns the number of
+ * bytes produced or -1.  */
+static fsw_ssize_t btrfs_stream_read(struct btrfs_decomp_stream *ds,
+        char *obuf, fsw_size_t osize)
+{
+    fsw_ssize_t ret = -1;
+
+    switch (ds->compression)
+    {
+        case GRUB_BTRFS_COMPRESSION_ZLIB:
+            ret = btrfs_zlib_read (&ds->zlib, obuf, osize);
+            break;
+        case GRUB_BTRFS_COMPRESSION_LZO:
+            ret = btrfs_lzo_read (&ds->lzo, obuf, osize);
+            break;
+        case GRUB_BTRFS_COMPRESSION_ZSTD:
+            ret = zstd_stream_read (&ds->zstd, obuf, osize);
+            break;
+    }
+    if (ret > 0)
+        ds->pos += ret;
+    return ret;
+}
+
+/* Continue decompression at byte pos instead, only LZO streams can seek.  */
+static fsw_status_t btrfs_stream_seek(struct btrfs_decomp_stream *ds, uint64_t pos)
+{
+    fsw_status_t err;
+
+    if (ds->compression != GRUB_BTRFS_COMPRESSION_LZO)
+        return FSW_UNSUPPORTED;
+    err = btrfs_lzo_seek (&ds->lzo, pos);
+    if (!err)
+        ds->pos = pos;
+    return err;
+}
+
+static void btrfs_stream_close(struct btrfs_decomp_stream *ds)
+{
+    switch (ds->compression)
+    {
+        case GRUB_BTRFS_COMPRESSION_ZLIB:
+            btrfs_zlib_close (&ds->zlib);
+            break;
+        case GRUB_BTRFS_COMPRESSION_ZSTD:
+            zstd_stream_close (&ds->zstd, ds->zpool);
+            break;
+    }
+}
+
+/* One-shot decompression of osize bytes at offset off, used for inline
+ * extents.  */
 static fsw_ssize_t btrfs_decompress(uint8_t comp,
 	char *ibuf, fsw_size_t isize,
 	grub_off_t off,
-        char *obuf, fsw_size_t osize)
+        char *obuf, fsw_size_t osize, struct fsw_btrfs_zstd_pool *zpool)
+{
+    struct btrfs_decomp_stream *ds;
+    fsw_ssize_t ret = -1;
+    fsw_status_t err;
+
+    ds = AllocatePool (sizeof (*ds));
+    if (!ds)
+        return -1;
+    if (btrfs_stream_open (ds, comp, ibuf, isize, zpool) != FSW_SUCCESS)
+    {
+        FreePool (ds);
+        return -1;
+    }
+
+    /* Skip to the requested offset, using the output buffer as scratch
+     * unless the stream can seek.  */
+    if (off > 0)
+    {
+        err = btrfs_stream_seek (ds, off);
+        if (err == FSW_SUCCESS)
+            off = 0;
+        else if (err != FSW_UNSUPPORTED)
+            goto out;
+    }
+    while (off > 0)
+    {
+        fsw_ssize_t skip = btrfs_stream_read (ds, obuf, off < osize ? off : osize);
+
+        if (skip <= 0)
+            goto out;
+        off -= skip;
+    }
+    ret = btrfs_stream_read (ds, obuf, osize);
+out:
+    btrfs_stream_close (ds);
+    FreePool (ds);
+    return ret;
+}
+
+static void fsw_btrfs_decomp_finish(struct fsw_btrfs_decomp_cache *dc)
+{
+    if (dc->stream)
+    {
+        btrfs_stream_close (dc->stream);
+        FreePool (dc->stream);
+        dc->stream = NULL;
+    }
+    if (dc->zbuf)
+    {
+        FreePool (dc->zbuf);
+        dc->zbuf = NULL;
+    }
+}
+
+static void fsw_btrfs_decomp_evict(struct fsw_btrfs_decomp_cache *dc)
+{
+    fsw_btrfs_decomp_finish (dc);
+    if (dc->buffer)
+    {
+        FreePool (dc->buffer);
+        dc->buffer = NULL;
+    }
+}
+
+/* Check size bytes of data, read from logical address laddr, against the
+ * checksum tree.  Both are multiples of the sector size.  Sectors without a
+ * checksum, as written for nodatasum files, are taken as they are.  */
+static fsw_status_t fsw_btrfs_verify_data(struct fsw_btrfs_volume *vol,
+        uint64_t laddr, const uint8_t *buf, uint64_t size)
+{
+    struct btrfs_key key_in, key_out;
+    uint64_t elemaddr, end = laddr + size;
+    fsw_size_t elemsize;
+    fsw_status_t err;
+    uint32_t csums[64];
+
+    while (laddr < end)
+    {
+        uint64_t first, covered, n, i;
+
+        key_in.object_id = fsw_u64_le_swap (GRUB_BTRFS_OBJECT_ID_EXTENT_CSUM);
+        key_in.type = GRUB_BTRFS_ITEM_TYPE_EXTENT_CSUM;
+        key_in.offset = fsw_u64_le_swap (laddr);
+        err = lower_bound (vol, &key_in, &key_out, vol->csum_tree, &elemaddr, &elemsize, NULL, 0);
+        if (err)
+            return err;
+
+        /* One crc32c per sector, starting at the sector of the key.  */
+        first = fsw_u64_le_swap (key_out.offset);
+        covered = ((uint64_t) elemsize / sizeof (csums[0])) << vol->sectorshift;
+        if (key_out.object_id != key_in.object_id || key_out.type != key_in.type
+                || first + covered <= laddr)
+        {
+            laddr += vol->sectorsize;
+            buf += vol->sectorsize;
+            continue;
+        }
+
+        i = (laddr - first) >> vol->sectorshift;
+        n = (first + covered - laddr) >> vol->sectorshift;
+        if (n > (end - laddr) >> vol->sectorshift)
+            n = (end - laddr) >> vol->sectorshift;
+        if (n > sizeof (csums) / sizeof (csums[0]))
+            n = sizeof (csums) / sizeof (csums[0]);
+        err = fsw_btrfs_read_logical (vol, elemaddr + i * sizeof (csums[0]),
+                csums, n * sizeof (csums[0]), 0, 1);
+        if (err)
+            return err;
+
+        for (i = 0; i < n; i++)
+        {
+            if (grub_getcrc32c (0, buf, vol->sectorsize) != fsw_u32_le_swap (csums[i]))
+            {
+                DPRINT (L"btrfs: data checksum mismatch at %lx\n", laddr);
+                return FSW_VOLUME_CORRUPTED;
+            }
+            laddr += vol->sectorsize;
+            buf += vol->sectorsize;
+        }
+    }
+    return FSW_SUCCESS;
+}
+
+/* Return the decompressed data of a REGULAR compressed extent from the
+ * per-volume cache, decompressing it further if the bytes from `start' up to
+ * `need' are not available yet.  The buffer is owned by the cache and stays
+ * valid until the next call, its bytes from `start' up to *avail_out are
+ * valid.  `end' is the end of the slice the caller hands out, once the extent
+ * is complete the buffer is zero padded up to it.  */
+static fsw_status_t fsw_btrfs_get_decompressed(struct fsw_btrfs_volume *vol,
+        struct btrfs_extent_data *ext, uint64_t start, uint64_t need, uint64_t end,
+        char **data_out, uint64_t *avail_out)
+{
+    struct fsw_btrfs_decomp_cache *dc = NULL, *victim = NULL;
+    uint64_t laddr = fsw_u64_le_swap (ext->laddr);
+    uint64_t zsize = fsw_u64_le_swap (ext->compressed_size);
+    uint64_t ram = fsw_u64_le_swap (ext->size);
+    uint64_t total, alloc, target;
+    fsw_status_t err;
+    fsw_ssize_t ret;
+    int i;
+
+    for (i = 0; i < DECOMP_CACHE_SIZE; i++)
+    {
+        if (vol->dcache[i].buffer && vol->dcache[i].laddr == laddr
+                && vol->dcache[i].zsize == zsize
+                && vol->dcache[i].compression == ext->compression)
+        {
+            dc = &vol->dcache[i];
+            break;
+        }
+        if (!victim || !vol->dcache[i].buffer
+                || (victim->buffer && vol->dcache[i].stamp < victim->stamp))
+            victim = &vol->dcache[i];
+    }
+
+    if (!dc)
+    {
+        total = (ram > need ? ram : need);
+        alloc = (total > end ? total : end);
+        alloc = (alloc + vol->sectorsize - 1) & ~(uint64_t)(vol->sectorsize - 1);
+        if (zsize == 0 || zsize > DECOMP_CACHE_MAX_BYTES || alloc > DECOMP_CACHE_MAX_BYTES)
+            return FSW_VOLUME_CORRUPTED;
+
+        fsw_btrfs_decomp_evict (victim);
+        dc = victim;
+        dc->laddr = laddr;
+        dc->zsize = zsize;
+        dc->compression = ext->compression;
+        dc->first = dc->size = 0;
+        dc->total = total;
+        dc->alloc = alloc;
+
+        err = fsw_alloc_zero (alloc, (void **)&dc->buffer);
+        if (!err)
+        {
+            dc->zbuf = AllocatePool (zsize);
+            dc->stream = AllocatePool (sizeof (*dc->stream));
+            if (!dc->zbuf || !dc->stream)
+                err = FSW_OUT_OF_MEMORY;
+        }
+        if (!err)
+            err = fsw_btrfs_read_logical_checked (vol, laddr, dc->zbuf, zsize, 0, 0,
+                    vol->csum_tree && !(zsize & (vol->sectorsize - 1))
+                    ? BTRFS_CHECK_DATA : BTRFS_CHECK_NONE);
+        if (!err)
+        {
+            err = btrfs_stream_open (dc->stream, dc->compression, dc->zbuf, zsize, &vol->zpool);
+            if (err)
+            {
+                FreePool (dc->stream);
+                dc->stream = NULL;
+            }
+        }
+        if (err)
+        {
+            fsw_btrfs_decomp_evict (dc);
+            return err == FSW_OUT_OF_MEMORY ? err : FSW_VOLUME_CORRUPTED;
+        }
+    }
+    dc->stamp = ++vol->dstamp;
+
+    /* LZO segments decompress independently: jump to the one holding
+     * `start' instead of decompressing everything in front of it.  Data
+     * decompressed before keeps its place in the buffer, but only the bytes
+     * from dc->first up to dc->size are known to be valid.  */
+    if (dc->stream && dc->compression == GRUB_BTRFS_COMPRESSION_LZO
+            && (start < dc->first
+                || (start & ~(uint64_t)(GRUB_BTRFS_LZO_BLOCK_SIZE - 1)) > dc->size))
+    {
+        start &= ~(uint64_t)(GRUB_BTRFS_LZO_BLOCK_SIZE - 1);
+        if (btrfs_stream_seek (dc->stream, start) != FSW_SUCCESS)
+        {
+            fsw_btrfs_decomp_evict (dc);
+            return FSW_VOLUME_CORRUPTED;
+        }
+        dc->first = dc->size = start;
+    }
+
+    /* Continue where the previous call stopped.  */
+    if (dc->size < need && dc->stream)
+    {
+        target = dc->size + DECOMP_STEP;
+        if (target < need)
+            target = need;
+        /* zlib and zstd decode straight into the destination when it has
+         * room for the whole extent, instead of going through their window.  */
+        if (dc->compression != GRUB_BTRFS_COMPRESSION_LZO && dc->size == 0)
+            target = dc->total;
+        if (target > dc->total)
+            target = dc->total;
+
+        ret = btrfs_stream_read (dc->stream, dc->buffer + dc->size, target - dc->size);
+        if (ret < 0)
+        {
+            fsw_btrfs_decomp_evict (dc);
+            return FSW_VOLUME_CORRUPTED;
+        }
+        dc->size += ret;
+        /* A short read means the stream has ended.  The rest of the buffer
+         * then stays zero, like the tail of the last page of a file.  An
+         * LZO stream that skipped data is kept for seeking back.  */
+        if (dc->size < target || dc->size >= dc->total)
+        {
+            dc->size = dc->alloc;
+            if (dc->first == 0)
+                fsw_btrfs_decomp_finish (dc);
+        }
+    }
+
+    if (need > dc->size || end > dc->alloc)
+        return FSW_VOLUME_CORRUPTED;
+
+    *data_out = dc->buffer;
+    *avail_out = dc->size;
+    return FSW_SUCCESS;
+}
+
+static void fsw_btrfs_free_extents(struct fsw_btrfs_dnode *dno)
 {
-	return btrfs_decompressor_table[comp-1](ibuf, isize, off, obuf, osize);
+    unsigned i;
+
+    for (i = 0; i < dno->n_extents; i++)
+        FreePool (dno->extents[i].data);
+    if (dno->extents)
+        FreePool (dno->extents);
+    dno->extents = NULL;
+    dno->n_extents = 0;
+    dno->extents_loaded = 0;
+}
+
+/* Read all EXTENT_DATA items of a file in one sweep over its leaves.  */
+static fsw_status_t fsw_btrfs_load_extents(struct fsw_btrfs_volume *vol,
+        struct fsw_btrfs_dnode *dno)
+{
+    struct fsw_btrfs_leaf_descriptor desc;
+    struct btrfs_key key_in, key_out;
+    struct btrfs_extent_data *ext;
+    unsigned n_allocated = 0;
+    uint64_t elemaddr;
+    fsw_size_t elemsize;
+    fsw_status_t err;
+    int r;
+
+    key_in.object_id = fsw_u64_le_swap (dno->g.dnode_id);
+    key_in.type = GRUB_BTRFS_ITEM_TYPE_EXTENT_ITEM;
+    key_in.offset = 0;
+    err = lower_bound (vol, &key_in, &key_out, dno->g.tree_id, &elemaddr, &elemsize, &desc, 0);
+    if (err)
+        return err;
+
+    r = 1;
+    if (key_cmp (&key_out, &key_in) < 0)
+        r = next (vol, &desc, &elemaddr, &elemsize, &key_out);
+    for (; r > 0; r = next (vol, &desc, &elemaddr, &elemsize, &key_out))
+    {
+        struct fsw_btrfs_extent_map *map;
+
+        if (key_out.object_id != key_in.object_id || key_out.type != key_in.type)
+            break;
+        if ((fsw_ssize_t) elemsize < ((char *) &ext->inl - (char *) ext))
+        {
+            r = -FSW_VOLUME_CORRUPTED;
+            break;
+        }
+        if (dno->n_extents == n_allocated)
+        {
+            unsigned n = n_allocated ? n_allocated * 2 : 8;
+
+            map = AllocatePool (sizeof (*map) * n);
+            if (!map)
+            {
+                r = -FSW_OUT_OF_MEMORY;
+                break;
+            }
+            if (dno->extents)
+            {
+                fsw_memcpy (map, dno->extents, sizeof (*map) * dno->n_extents);
+                FreePool (dno->extents);
+            }
+            dno->extents = map;
+            n_allocated = n;
+        }
+
+        ext = AllocatePool (elemsize);
+        if (!ext)
+        {
+            r = -FSW_OUT_OF_MEMORY;
+            break;
+        }
+        err = fsw_btrfs_read_logical (vol, elemaddr, ext, elemsize, 0, 1);
+        if (err)
+        {
+            FreePool (ext);
+            r = -err;
+            break;
+        }
+
+        map = &dno->extents[dno->n_extents++];
+        map->start = fsw_u64_le_swap (key_out.offset);
+        map->end = map->start + fsw_u64_le_swap (ext->size);
+        if (ext->type == GRUB_BTRFS_EXTENT_REGULAR
+                && (char *) ext + elemsize
+                >= (char *) &ext->filled + sizeof (ext->filled))
+            map->end = map->start + fsw_u64_le_swap (ext->filled);
+        map->size = elemsize;
+        map->data = ext;
+        DPRINT (L"btrfs: %lx +0x%lx\n", map->start, map->end - map->start);
+    }
+    free_iterator (&desc);
+
+    if (r < 0)
+    {
+        fsw_btrfs_free_extents (dno);
+        return -r;
+    }
+    dno->extents_loaded = 1;
+    return FSW_SUCCESS;
 }
 
 static fsw_status_t fsw_btrfs_get_extent(struct fsw_volume *volg, struct fsw_dnode *dnog,
         struct fsw_extent *extent)
 {
     struct fsw_btrfs_volume *vol = (struct fsw_btrfs_volume *)volg;
-    uint64_t ino = dnog->dnode_id;
-    uint64_t tree = dnog->tree_id;
-    uint64_t pos0 = extent->log_start << vol->sectorshift;
+    struct fsw_btrfs_dnode *dno = (struct fsw_btrfs_dnode *)dnog;
+    uint64_t pos = extent->log_start << vol->sectorshift;
     extent->type = FSW_EXTENT_TYPE_INVALID;
     extent->log_count = 1;
-    uint64_t pos = pos0;
+    extent->flags = 0;
+    struct fsw_btrfs_extent_map *map;
+    struct btrfs_extent_data *ext;
+    unsigned lo, hi;
     fsw_size_t csize;
     fsw_status_t err;
     uint64_t extoff;
@@ -1628,68 +2944,48 @@ static fsw_status_t fsw_btrfs_get_extent(struct fsw_volume *volg, struct fsw_dno
     if (!vol->is_master)
         return FSW_NOT_FOUND;
 
-    if (!vol->extent || vol->extstart > pos || vol->extino != ino
-            || vol->exttree != tree || vol->extend <= pos)
+    if (!dno->extents_loaded)
     {
-        struct btrfs_key key_in, key_out;
-        uint64_t elemaddr;
-        fsw_size_t elemsize;
-
-        if(vol->extent) {
-            FreePool (vol->extent);
-            vol->extent = NULL;
-        }
-        key_in.object_id = ino;
-        key_in.type = GRUB_BTRFS_ITEM_TYPE_EXTENT_ITEM;
-        key_in.offset = fsw_u64_le_swap (pos);
-        err = lower_bound (vol, &key_in, &key_out, tree, &elemaddr, &elemsize, NULL, 0);
-        if (err)
-            return FSW_VOLUME_CORRUPTED;
-        if (key_out.object_id != ino
-                || key_out.type != GRUB_BTRFS_ITEM_TYPE_EXTENT_ITEM)
-        {
-            return FSW_VOLUME_CORRUPTED;
-        }
-        if ((fsw_ssize_t) elemsize < ((char *) &vol->extent->inl
-                    - (char *) vol->extent))
-        {
-            return FSW_VOLUME_CORRUPTED;
-        }
-        vol->extstart = fsw_u64_le_swap (key_out.offset);
-        vol->extsize = elemsize;
-        vol->extent = AllocatePool (elemsize);
-        vol->extino = ino;
-        vol->exttree = tree;
-        if (!vol->extent)
-            return FSW_OUT_OF_MEMORY;
-
-        err = fsw_btrfs_read_logical (vol, elemaddr, vol->extent, elemsize, 0, 1);
+        err = fsw_btrfs_load_extents (vol, dno);
         if (err)
             return err;
+    }
 
-        vol->extend = vol->extstart + fsw_u64_le_swap (vol->extent->size);
-        if (vol->extent->type == GRUB_BTRFS_EXTENT_REGULAR
-                && (char *) vol->extent + elemsize
-                >= (char *) &vol->extent->filled + sizeof (vol->extent->filled))
-            vol->extend =
-                vol->extstart + fsw_u64_le_swap (vol->extent->filled);
+    /* last extent starting at or before pos */
+    lo = 0;
+    hi = dno->n_extents;
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (dno->extents[mid].start <= pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0 || dno->extents[lo - 1].end <= pos)
+    {
+        /* a hole without an extent item, up to the next extent */
+        uint64_t hole_end = lo < dno->n_extents ? dno->extents[lo].start : dno->g.size;
 
-        DPRINT (L"btrfs: %lx +0x%lx\n", fsw_u64_le_swap (key_out.offset), fsw_u64_le_swap (vol->extent->size));
-        if (vol->extend <= pos)
-        {
+        if (hole_end <= pos)
             return FSW_VOLUME_CORRUPTED;
-        }
+        extent->log_count = (hole_end - pos + vol->sectorsize - 1) >> vol->sectorshift;
+        extent->buffer = NULL;
+        extent->type = FSW_EXTENT_TYPE_SPARSE;
+        return FSW_SUCCESS;
     }
+    map = &dno->extents[lo - 1];
+    ext = map->data;
 
-    csize = vol->extend - pos;
-    extoff = pos - vol->extstart;
+    csize = map->end - pos;
+    extoff = pos - map->start;
 
-    if (vol->extent->encryption ||vol->extent->encoding)
+    if (ext->encryption || ext->encoding)
     {
         return FSW_UNSUPPORTED;
     }
 
-    switch(vol->extent->compression) {
+    switch(ext->compression) {
         case GRUB_BTRFS_COMPRESSION_LZO:
         case GRUB_BTRFS_COMPRESSION_ZLIB:
         case GRUB_BTRFS_COMPRESSION_ZSTD:
@@ -1700,19 +2996,26 @@ static fsw_status_t fsw_btrfs_get_extent(struct fsw_volume *volg, struct fsw_dno
     }
 
     count = ( csize + vol->sectorsize - 1) >> vol->sectorshift;
-    switch (vol->extent->type)
+    switch (ext->type)
     {
         case GRUB_BTRFS_EXTENT_INLINE:
             buf = AllocatePool( count << vol->sectorshift);
             if(!buf)
                 return FSW_OUT_OF_MEMORY;
-            if (vol->extent->compression == GRUB_BTRFS_COMPRESSION_NONE)
-                fsw_memcpy (buf, vol->extent->inl + extoff, csize);
-            else if (btrfs_decompress (vol->extent->compression,
-				vol->extent->inl, vol->extsize -
-                            ((uint8_t *) vol->extent->inl
-                             - (uint8_t *) vol->extent),
-                            extoff, buf, csize)
+            if (ext->compression == GRUB_BTRFS_COMPRESSION_NONE)
+            {
+                if (map->size < (fsw_size_t) ((char *) ext->inl - (char *) ext) + extoff + csize)
+                {
+                    FreePool(buf);
+                    return FSW_VOLUME_CORRUPTED;
+                }
+                fsw_memcpy (buf, ext->inl + extoff, csize);
+            }
+            else if (btrfs_decompress (ext->compression,
+				ext->inl, map->size -
+                            ((uint8_t *) ext->inl
+                             - (uint8_t *) ext),
+                            extoff, buf, csize, &vol->zpool)
                         != (fsw_ssize_t) csize)
 	    {
                 FreePool(buf);
@@ -1721,22 +3024,43 @@ static fsw_status_t fsw_btrfs_get_extent(struct fsw_volume *volg, struct fsw_dno
             break;
 
         case GRUB_BTRFS_EXTENT_REGULAR:
-            if (!vol->extent->laddr)
+            if (!ext->laddr)
                 break;
 
-            if (vol->extent->compression == GRUB_BTRFS_COMPRESSION_NONE)
+            if (ext->compression == GRUB_BTRFS_COMPRESSION_NONE)
             {
-                if( count > 64 ) {
-                    count = 64;
+                uint64_t laddr = fsw_u64_le_swap (ext->laddr)
+                        + fsw_u64_le_swap (ext->offset) + extoff;
+                uint64_t paddr, len;
+                int verify = vol->csum_tree
+                        && !(fsw_u64_le_swap (dno->raw->flags) & GRUB_BTRFS_INODE_NODATASUM);
+
+                /* Hand the whole physical run to the core when the data
+                 * sits contiguously on this device.  */
+                if (!verify && fsw_btrfs_map_direct (vol, laddr, &paddr, &len)
+                        && len >= vol->sectorsize)
+                {
+                    len >>= vol->sectorshift;
+                    extent->log_count = count < len ? count : len;
+                    extent->phys_start = paddr >> vol->sectorshift;
+                    extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
+                    return FSW_SUCCESS;
+                }
+
+                /* Anything else is read through a bounded bounce buffer.  */
+                if( count > DIRECT_READ_MAX_SECTORS ) {
+                    count = DIRECT_READ_MAX_SECTORS;
                     csize = count << vol->sectorshift;
                 }
                 buf = AllocatePool( count << vol->sectorshift);
                 if(!buf)
                     return FSW_OUT_OF_MEMORY;
-                err = fsw_btrfs_read_logical (vol,
-                        fsw_u64_le_swap (vol->extent->laddr)
-                        + fsw_u64_le_swap (vol->extent->offset)
-                        + extoff, buf, csize, 0, 0);
+                /* Checksums cover whole sectors.  */
+                if (verify)
+                    err = fsw_btrfs_read_logical_checked (vol, laddr, buf, count << vol->sectorshift,
+                            0, 0, BTRFS_CHECK_DATA);
+                else
+                    err = fsw_btrfs_read_logical (vol, laddr, buf, csize, 0, 0);
                 if (err) {
                     FreePool(buf);
                     return err;
@@ -1744,46 +3068,31 @@ static fsw_status_t fsw_btrfs_get_extent(struct fsw_volume *volg, struct fsw_dno
                 break;
             }
 
-            if (vol->extent->compression > GRUB_BTRFS_COMPRESSION_MAX)
+            if (ext->compression > GRUB_BTRFS_COMPRESSION_MAX)
                     return -FSW_VOLUME_CORRUPTED;
 
             {
-                char *tmp;
-                uint64_t zsize;
-                fsw_ssize_t ret;
-
-                zsize = fsw_u64_le_swap (vol->extent->compressed_size);
-                tmp = AllocatePool (zsize);
-                if (!tmp)
-                    return -FSW_OUT_OF_MEMORY;
-                err = fsw_btrfs_read_logical (vol, fsw_u64_le_swap (vol->extent->laddr), tmp, zsize, 0, 0);
+                uint64_t start = fsw_u64_le_swap (ext->offset) + extoff;
+                uint64_t avail;
+                char *data;
+
+                /* Only the first block has to be there, the slice covers
+                 * whatever has been decompressed so far.  */
+                err = fsw_btrfs_get_decompressed (vol, ext, start,
+                        start + (csize < vol->sectorsize ? csize : vol->sectorsize),
+                        start + (count << vol->sectorshift), &data, &avail);
                 if (err)
-                {
-                    FreePool (tmp);
-                    return -FSW_VOLUME_CORRUPTED;
-                }
-
-                buf = AllocatePool( count << vol->sectorshift);
-                if(!buf) {
-                    FreePool(tmp);
-                    return FSW_OUT_OF_MEMORY;
-                }
-
-		ret = btrfs_decompress ( vol->extent->compression,
-			tmp, zsize,
-			extoff + fsw_u64_le_swap (vol->extent->offset),
-			buf, csize);
-
-                FreePool (tmp);
-
-                if (ret != (fsw_ssize_t) csize) {
-                    FreePool(tmp);
-                    return -FSW_VOLUME_CORRUPTED;
-                }
-
-                break;
+                    return err;
+                if (avail < start + csize)
+                    count = (avail - start) >> vol->sectorshift;
+
+                /* Hand out a slice of the cached data, the cache keeps it.  */
+                extent->log_count = count;
+                extent->buffer = data + start;
+                extent->type = FSW_EXTENT_TYPE_BUFFER;
+                extent->flags |= FSW_EXTENT_FLAG_BORROWED;
+                return FSW_SUCCESS;
             }
-            break;
         default:
             return -FSW_VOLUME_CORRUPTED;
     }
@@ -1823,10 +3132,11 @@ static fsw_status_t fsw_btrfs_readlink(struct fsw_volume *volg, struct fsw_dnode
         struct fsw_extent extent;
         int size;
         extent.log_start = i;
+        extent.buffer = NULL;
         status = fsw_btrfs_get_extent(volg, dnog, &extent);
         if(status || extent.type != FSW_EXTENT_TYPE_BUFFER) {
             FreePool(tmp);
-            if(extent.buffer)
+            if(!status && extent.buffer && !(extent.flags & FSW_EXTENT_FLAG_BORROWED))
                 FreePool(extent.buffer);
             return FSW_VOLUME_CORRUPTED;
         }
@@ -1834,7 +3144,8 @@ static fsw_status_t fsw_btrfs_readlink(struct fsw_volume *volg, struct fsw_dnode
         if(size > (dno->g.size - (i<<vol->sectorshift)))
             size = dno->g.size - (i<<vol->sectorshift);
         fsw_memcpy(tmp + (i<<vol->sectorshift), extent.buffer, size);
-        FreePool(extent.buffer);
+        if(!(extent.flags & FSW_EXTENT_FLAG_BORROWED))
+            FreePool(extent.buffer);
         i += extent.log_count;
     } while( (i << vol->sectorshift) < dno->g.size);
 
@@ -2201,5 +3512,6 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(btrfs) = {
     fsw_btrfs_dir_lookup,
     fsw_btrfs_dir_read,
     fsw_btrfs_readlink,
+    fsw_btrfs_volume_sniff,
 };
 
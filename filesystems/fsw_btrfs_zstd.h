@@ -51,82 +51,90 @@ static inline void put_unaligned_le16(uint16_t v, void *s)
 #define ZSTD_BTRFS_MAX_INPUT (1 << ZSTD_BTRFS_MAX_WINDOWLOG)
 
 
-static fsw_ssize_t zstd_decompress(char *data_in, fsw_size_t srclen,
-		grub_off_t start_byte,
-		char *data_out, fsw_size_t destlen)
-{
+/* A zstd stream kept open between reads, so that a compressed extent read in
+ * pieces is decompressed exactly once.  */
+struct zstd_stream {
 	ZSTD_DStream *stream;
+	void *workspace;
 	ZSTD_inBuffer in_buf;
-	ZSTD_outBuffer out_buf;
-	fsw_ssize_t ret = 0;
-	size_t ret2;
-
-	size_t workspace_size = ZSTD_DStreamWorkspaceBound(ZSTD_BTRFS_MAX_INPUT);
-	void * workspace;
-	
-	in_buf.src = data_in;
-	in_buf.pos = 0;
-	in_buf.size = srclen;
-
-	out_buf.dst = NULL;
-
-	workspace = AllocatePool(workspace_size);
+	int done;
+};
 
-	if(!workspace) {
-		ret = -FSW_OUT_OF_MEMORY;
-		goto finish;
+/* Put the context back into the pool, or free it if the pool is full.  */
+static void zstd_stream_close(struct zstd_stream *zs, struct fsw_btrfs_zstd_pool *pool)
+{
+	if(zs->workspace) {
+		if(pool && pool->count < ZSTD_POOL_SIZE)
+			pool->workspace[pool->count++] = zs->workspace;
+		else
+			FreePool(zs->workspace);
 	}
+	zs->workspace = NULL;
+	zs->stream = NULL;
+}
 
-	stream = ZSTD_initDStream(ZSTD_BTRFS_MAX_INPUT, workspace, workspace_size);
-	if (!stream) {
-		DPRINT(L"BTRFS: ZSTD_initDStream failed\n");
-		ret = -FSW_OUT_OF_MEMORY;
-		goto finish;
-	}
+static void zstd_pool_free(struct fsw_btrfs_zstd_pool *pool)
+{
+	while(pool->count > 0)
+		FreePool(pool->workspace[--pool->count]);
+}
 
-	while(start_byte > 0) {
-	    out_buf.size = start_byte < PAGE_SIZE ? start_byte : PAGE_SIZE;
-	    if(out_buf.dst == NULL)
-		out_buf.dst = AllocatePool(out_buf.size);
-	    out_buf.pos = 0;
+static fsw_status_t zstd_stream_open(struct zstd_stream *zs, struct fsw_btrfs_zstd_pool *pool,
+		char *data_in, fsw_size_t srclen)
+{
+	size_t workspace_size = ZSTD_DStreamWorkspaceBound(ZSTD_BTRFS_MAX_INPUT);
 
-	    ret2 = ZSTD_decompressStream(stream, &out_buf, &in_buf);
-	    if (ZSTD_isError(ret2)) {
-		DPRINT(L"BTRFS: ZSTD_decompressStream returned %d\n", ZSTD_getErrorCode(ret2));
-		ret = -FSW_VOLUME_CORRUPTED;
-		goto finish;
-	    }
+	zs->in_buf.src = data_in;
+	zs->in_buf.pos = 0;
+	zs->in_buf.size = srclen;
+	zs->done = 0;
+
+	/* A pooled context only needs its stream state reset, the DStream
+	 * sits at the start of its workspace.  */
+	if(pool && pool->count > 0) {
+		zs->workspace = pool->workspace[--pool->count];
+		zs->stream = (ZSTD_DStream *)zs->workspace;
+		ZSTD_resetDStream(zs->stream);
+		return FSW_SUCCESS;
+	}
 
-	    if(out_buf.pos == 0 && in_buf.pos == in_buf.size) {
-		DPRINT(L"BTRFS: ZSTD_decompressStream ended early\n");
-		ret = -FSW_VOLUME_CORRUPTED;
-		goto finish;
-	    }
+	zs->workspace = AllocatePool(workspace_size);
+	if(!zs->workspace)
+		return FSW_OUT_OF_MEMORY;
 
-	    start_byte -= out_buf.pos;
+	zs->stream = ZSTD_initDStream(ZSTD_BTRFS_MAX_INPUT, zs->workspace, workspace_size);
+	if (!zs->stream) {
+		DPRINT(L"BTRFS: ZSTD_initDStream failed\n");
+		zstd_stream_close(zs, NULL);
+		return FSW_OUT_OF_MEMORY;
 	}
+	return FSW_SUCCESS;
+}
 
-	if(out_buf.dst)
-		FreePool(out_buf.dst);
+/* Decompress the next destlen bytes of the stream.  Returns the number of
+ * bytes produced, which is short only at the end of the frame, or -1.  */
+static fsw_ssize_t zstd_stream_read(struct zstd_stream *zs,
+		char *data_out, fsw_size_t destlen)
+{
+	ZSTD_outBuffer out_buf;
+	size_t ret2;
 
 	out_buf.dst = data_out;
 	out_buf.size = destlen;
 	out_buf.pos = 0;
 
-	ret2 = ZSTD_decompressStream(stream, &out_buf, &in_buf);
-	if (ZSTD_isError(ret2)) {
-	    DPRINT(L"BTRFS: ZSTD_decompressStream returned %d\n", ZSTD_getErrorCode(ret2));
-	    ret = -FSW_VOLUME_CORRUPTED;
-	    goto finish;
+	while(out_buf.pos < out_buf.size && !zs->done) {
+	    size_t opos = out_buf.pos, ipos = zs->in_buf.pos;
+
+	    ret2 = ZSTD_decompressStream(zs->stream, &out_buf, &zs->in_buf);
+	    if (ZSTD_isError(ret2)) {
+		DPRINT(L"BTRFS: ZSTD_decompressStream returned %d\n", ZSTD_getErrorCode(ret2));
+		return -1;
+	    }
+	    /* frame complete, or no progress possible */
+	    if (ret2 == 0 || (out_buf.pos == opos && zs->in_buf.pos == ipos))
+		zs->done = 1;
 	}
 
-	ret = destlen;
-finish:
-	if(out_buf.dst && out_buf.dst != data_out)
-		FreePool(out_buf.dst);
-	if(workspace)
-		FreePool(workspace);
-	if (out_buf.pos < destlen)
-		memset(data_out + out_buf.pos, 0, destlen - out_buf.pos);
-	return ret;
+	return out_buf.pos;
 }
@@ -38,12 +38,17 @@
  */
 
 #include "fsw_core.h"
+#ifndef HOST_POSIX
 #include "fsw_efi.h"
+#endif
 
 
 // functions
 
 static void fsw_blockcache_free(struct fsw_volume *vol);
+static void fsw_linkcache_free(struct fsw_volume *vol);
+static void fsw_set_geometry(struct fsw_volume *vol);
+static void fsw_dirindex_free_all(struct fsw_volume *vol);
 
 #define MAX_CACHE_LEVEL (5)
 
@@ -77,6 +82,7 @@ fsw_status_t fsw_mount(void *host_data,
     // initialize fields
     vol->phys_blocksize = 512;
     vol->log_blocksize  = 512;
+    fsw_set_geometry(vol);
     vol->label.type     = FSW_STRING_TYPE_EMPTY;
     vol->host_data      = host_data;
     vol->host_table     = host_table;
@@ -98,6 +104,23 @@ errorexit:
     return status;
 }
 
+/**
+ * Quickly check whether a device may hold a file system of the given type,
+ * without allocating a volume. The file system driver reads only the few bytes
+ * holding its superblock magic through the read callback. FSW_UNSUPPORTED
+ * means the device certainly is not of this type; any other result means that
+ * only a full fsw_mount can tell. Drivers without a volume_sniff function
+ * always get FSW_SUCCESS.
+ */
+
+fsw_status_t fsw_sniff(void *host_data, fsw_sniff_read_t read,
+                       struct fsw_fstype_table *fstype_table)
+{
+    if (fstype_table->volume_sniff == NULL)
+        return FSW_SUCCESS;
+    return fstype_table->volume_sniff(host_data, read);
+}
+
 /**
  * Unmount a volume by releasing all memory associated with it. This function is
  * called by the host driver when a volume is no longer needed. It is also called
@@ -108,6 +131,8 @@ errorexit:
 
 void fsw_unmount(struct fsw_volume *vol)
 {
+    fsw_linkcache_free(vol);
+    fsw_dirindex_free_all(vol);
     if (vol->root)
         fsw_dnode_release(vol->root);
     // TODO: check that no other dnodes are still around
@@ -142,6 +167,8 @@ fsw_status_t fsw_volume_stat(struct fsw_volume *vol, struct fsw_volume_stat *sb)
  *
  * Both sizes are measured in bytes, must be powers of 2, and must not be smaller
  * than 512 bytes. The logical block size cannot be smaller than the physical block size.
+ * This is also where the block geometry specialisations of the read path are picked,
+ * and where log_blocksize_bits and phys_blocksize_bits are set for the drivers.
  */
 
 void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 log_blocksize)
@@ -159,6 +186,7 @@ void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 l
 
     vol->phys_blocksize = phys_blocksize;
     vol->log_blocksize = log_blocksize;
+    fsw_set_geometry(vol);
 }
 
 /**
@@ -190,17 +218,24 @@ fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u64 phys_bno, fsw_u32
     if (cache_level > MAX_CACHE_LEVEL)
         cache_level = MAX_CACHE_LEVEL;
 
-    // check block cache
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == phys_bno) {
-            // cache hit!
-            if (vol->bcache[i].cache_level < cache_level)
-                vol->bcache[i].cache_level = cache_level;  // promote the entry
-            vol->bcache[i].refcount++;
-            *buffer_out = vol->bcache[i].data;
-            return FSW_SUCCESS;
+    // check block cache, starting with the entry handed out last (small sequential
+    //  reads ask for the same block many times in a row)
+    i = vol->bcache_last;
+    if (i >= vol->bcache_size || vol->bcache[i].phys_bno != phys_bno) {
+        for (i = 0; i < vol->bcache_size; i++) {
+            if (vol->bcache[i].phys_bno == phys_bno)
+                break;
         }
     }
+    if (i < vol->bcache_size) {
+        // cache hit!
+        if (vol->bcache[i].cache_level < cache_level)
+            vol->bcache[i].cache_level = cache_level;  // promote the entry
+        vol->bcache[i].refcount++;
+        vol->bcache_last = i;
+        *buffer_out = vol->bcache[i].data;
+        return FSW_SUCCESS;
+    }
 
     // find a free entry in the cache table
     for (i = 0; i < vol->bcache_size; i++) {
@@ -257,6 +292,7 @@ fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u64 phys_bno, fsw_u32
     vol->bcache[i].phys_bno = phys_bno;
     vol->bcache[i].cache_level = cache_level;
     vol->bcache[i].refcount = 1;
+    vol->bcache_last = i;
     *buffer_out = vol->bcache[i].data;
     return FSW_SUCCESS;
 }
@@ -273,7 +309,13 @@ void fsw_block_release(struct VOLSTRUCTNAME *vol, fsw_u64 phys_bno, void *buffer
     // TODO: allow the host driver to do its own caching; just call through if
     //  the appropriate function pointers are set
 
-    // update block cache
+    // update block cache; there is only one entry per block, usually the last one handed out
+    i = vol->bcache_last;
+    if (i < vol->bcache_size && vol->bcache[i].phys_bno == phys_bno) {
+        if (vol->bcache[i].refcount > 0)
+            vol->bcache[i].refcount--;
+        return;
+    }
     for (i = 0; i < vol->bcache_size; i++) {
         if (vol->bcache[i].phys_bno == phys_bno && vol->bcache[i].refcount > 0)
             vol->bcache[i].refcount--;
@@ -509,10 +551,282 @@ fsw_status_t fsw_dnode_stat(struct fsw_dnode *dno, struct fsw_dnode_stat *sb)
     return status;
 }
 
+/**
+ * Case-folded name index of a directory, see fsw_dnode_lookup. The volume keeps the
+ * indexes of the FSW_DIRINDEX_MAX most recently searched directories by their tree_id
+ * and dnode_id, so they outlive the dnode but not a walk over a large tree. Entries
+ * remember the dir_read position of their directory entry, so a hit is resolved by
+ * reading just that one entry again. Entries with the same hash are chained through
+ * the next field.
+ */
+
+struct fsw_dirindex_entry {
+    fsw_u32     hash;               //!< Hash of the folded name
+    fsw_u32     next;               //!< Index of the next entry in the bucket, or FSW_DIRINDEX_END
+    fsw_u64     pos;                //!< Directory read position of the entry
+    struct fsw_string name;         //!< Folded name (UTF16)
+};
+
+struct fsw_dirindex {
+    fsw_u64     tree_id;            //!< tree_id of the directory dnode
+    fsw_u64     dnode_id;           //!< dnode_id of the directory dnode
+    fsw_u32     count;              //!< Number of entries
+    fsw_u32     nbuckets;           //!< Number of hash buckets (power of two)
+    fsw_u32     *buckets;           //!< First entry of each bucket, or FSW_DIRINDEX_END
+    struct fsw_dirindex_entry *entries;
+};
+
+#define FSW_DIRINDEX_END (0xffffffff)
+#define FSW_DIRINDEX_MAX (16)
+
+/**
+ * Convert a name to UTF16 with ASCII and Latin-1 letters folded to lower case,
+ * and compute its hash (FNV-1a over the UTF16 characters).
+ */
+
+static fsw_status_t fsw_dirindex_fold(struct fsw_string *name, struct fsw_string *folded, fsw_u32 *hash_out)
+{
+    fsw_status_t    status;
+    fsw_u16         *p;
+    fsw_u32         hash;
+    int             i;
+
+    status = fsw_strdup_coerce(folded, FSW_STRING_TYPE_UTF16, name);
+    if (status)
+        return status;
+
+    p = (fsw_u16 *)folded->data;
+    hash = 2166136261U;
+    for (i = 0; i < folded->len; i++) {
+        if ((p[i] >= 'A' && p[i] <= 'Z') || (p[i] >= 0xC0 && p[i] <= 0xDE && p[i] != 0xD7))
+            p[i] += 0x20;
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    *hash_out = hash;
+    return FSW_SUCCESS;
+}
+
+static void fsw_dirindex_free(struct fsw_dirindex *index)
+{
+    fsw_u32         i;
+
+    for (i = 0; i < index->count; i++)
+        fsw_strfree(&index->entries[i].name);
+    if (index->entries)
+        fsw_free(index->entries);
+    if (index->buckets)
+        fsw_free(index->buckets);
+    fsw_free(index);
+}
+
+/**
+ * Release all name indexes of a volume.
+ */
+
+static void fsw_dirindex_free_all(struct fsw_volume *vol)
+{
+    fsw_u32         i;
+
+    for (i = 0; i < vol->dirindex_count; i++)
+        fsw_dirindex_free(vol->dirindex[i]);
+    if (vol->dirindex)
+        fsw_free(vol->dirindex);
+    vol->dirindex = NULL;
+    vol->dirindex_count = 0;
+}
+
+/**
+ * Build the name index of a directory by reading all of its entries once.
+ */
+
+static fsw_status_t fsw_dirindex_build(struct fsw_dnode *dno, struct fsw_dirindex **index_out)
+{
+    fsw_status_t    status;
+    struct fsw_dirindex *index;
+    struct fsw_dirindex_entry *entry, *new_entries;
+    struct fsw_shandle shand;
+    struct fsw_dnode *child_dno;
+    fsw_u32         capacity, i, b;
+    fsw_u64         pos;
+
+    status = fsw_alloc_zero(sizeof(struct fsw_dirindex), (void **)&index);
+    if (status)
+        return status;
+    index->tree_id = dno->tree_id;
+    index->dnode_id = dno->dnode_id;
+
+    status = fsw_shandle_open(dno, &shand);
+    if (status) {
+        fsw_free(index);
+        return status;
+    }
+
+    // collect all entries
+    capacity = 0;
+    for (;;) {
+        pos = shand.pos;
+        status = fsw_dnode_dir_read(&shand, &child_dno);
+        if (status == FSW_NOT_FOUND) {
+            status = FSW_SUCCESS;
+            break;
+        }
+        if (status)
+            break;
+
+        if (index->count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            status = fsw_alloc(capacity * sizeof(struct fsw_dirindex_entry), &new_entries);
+            if (status) {
+                fsw_dnode_release(child_dno);
+                break;
+            }
+            if (index->entries) {
+                fsw_memcpy(new_entries, index->entries, index->count * sizeof(struct fsw_dirindex_entry));
+                fsw_free(index->entries);
+            }
+            index->entries = new_entries;
+        }
+
+        entry = &index->entries[index->count];
+        entry->pos = pos;
+        status = fsw_dirindex_fold(&child_dno->name, &entry->name, &entry->hash);
+        fsw_dnode_release(child_dno);
+        if (status)
+            break;
+        index->count++;
+    }
+    fsw_shandle_close(&shand);
+
+    // chain the entries into the hash buckets
+    if (status == FSW_SUCCESS) {
+        for (index->nbuckets = 16; index->nbuckets < index->count; index->nbuckets <<= 1)
+            ;
+        status = fsw_alloc(index->nbuckets * sizeof(fsw_u32), &index->buckets);
+    }
+    if (status) {
+        fsw_dirindex_free(index);
+        return status;
+    }
+    for (b = 0; b < index->nbuckets; b++)
+        index->buckets[b] = FSW_DIRINDEX_END;
+    for (i = index->count; i-- > 0; ) {
+        b = index->entries[i].hash & (index->nbuckets - 1);
+        index->entries[i].next = index->buckets[b];
+        index->buckets[b] = i;
+    }
+
+    *index_out = index;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Find the name index of a directory on its volume, building it on first use. The index
+ * moves to the front of the volume's list; when the list is full, the least recently
+ * used index at its end is freed to make room.
+ */
+
+static fsw_status_t fsw_dirindex_get(struct fsw_dnode *dno, struct fsw_dirindex **index_out)
+{
+    fsw_status_t    status;
+    struct fsw_volume *vol = dno->vol;
+    struct fsw_dirindex *index;
+    fsw_u32         i;
+
+    for (i = 0; i < vol->dirindex_count; i++) {
+        index = vol->dirindex[i];
+        if (index->dnode_id == dno->dnode_id && index->tree_id == dno->tree_id)
+            break;
+    }
+
+    if (i == vol->dirindex_count) {
+        if (vol->dirindex == NULL) {
+            status = fsw_alloc(FSW_DIRINDEX_MAX * sizeof(struct fsw_dirindex *), &vol->dirindex);
+            if (status)
+                return status;
+        }
+        status = fsw_dirindex_build(dno, &index);
+        if (status)
+            return status;
+        if (vol->dirindex_count == FSW_DIRINDEX_MAX)
+            fsw_dirindex_free(vol->dirindex[--vol->dirindex_count]);
+        i = vol->dirindex_count++;
+    }
+
+    // move to the front
+    for (; i > 0; i--)
+        vol->dirindex[i] = vol->dirindex[i - 1];
+    vol->dirindex[0] = index;
+
+    *index_out = index;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Look up a name in a directory through its name index, ignoring case. This is only
+ * asked after the file system's own lookup found no exact match. If the index cannot
+ * be built, the name is reported as not found, as the file system's lookup did.
+ */
+
+static fsw_status_t fsw_dirindex_lookup(struct fsw_dnode *dno,
+                                        struct fsw_string *lookup_name, struct fsw_dnode **child_dno_out)
+{
+    fsw_status_t    status;
+    struct fsw_dirindex *index;
+    struct fsw_dirindex_entry *entry;
+    struct fsw_string folded;
+    struct fsw_shandle shand;
+    fsw_u32         hash, i;
+
+    if (fsw_dirindex_get(dno, &index))
+        return FSW_NOT_FOUND;
+
+    status = fsw_dirindex_fold(lookup_name, &folded, &hash);
+    if (status)
+        return status;
+
+    status = FSW_NOT_FOUND;
+    for (i = index->buckets[hash & (index->nbuckets - 1)]; i != FSW_DIRINDEX_END; i = entry->next) {
+        entry = &index->entries[i];
+        if (entry->hash != hash || !fsw_streq(&entry->name, &folded))
+            continue;
+
+        // re-read the directory entry at its recorded position
+        status = fsw_shandle_open(dno, &shand);
+        if (status)
+            break;
+        shand.pos = entry->pos;
+        status = fsw_dnode_dir_read(&shand, child_dno_out);
+        fsw_shandle_close(&shand);
+        break;
+    }
+    fsw_strfree(&folded);
+
+    return status;
+}
+
+/**
+ * Dispatch a directory lookup to the file system. If the host wants case-insensitive
+ * lookups and the file system does not provide them itself, a name it does not find is
+ * looked up again in the core's name index.
+ */
+
+static fsw_status_t fsw_dnode_dir_lookup(struct fsw_dnode *dno,
+                                         struct fsw_string *lookup_name, struct fsw_dnode **child_dno_out)
+{
+    fsw_status_t    status;
+    struct fsw_volume *vol = dno->vol;
+
+    status = vol->fstype_table->dir_lookup(vol, dno, lookup_name, child_dno_out);
+    if (status == FSW_NOT_FOUND && vol->host_table->casefold_lookup && !vol->lookup_ignores_case)
+        status = fsw_dirindex_lookup(dno, lookup_name, child_dno_out);
+    return status;
+}
+
 /**
  * Lookup a directory entry by name. This function is called by the host driver.
  * Given a directory dnode and a file name, it looks up the named entry in the
- * directory.
+ * directory. If the host table asks for it, names are compared ignoring case; an
+ * exact match still takes precedence.
  *
  * If the dnode is not a directory, the call will fail. The caller is responsible for
  * resolving symbolic links before calling this function.
@@ -532,7 +846,7 @@ fsw_status_t fsw_dnode_lookup(struct fsw_dnode *dno,
     if (dno->type != FSW_DNODE_TYPE_DIR)
         return FSW_UNSUPPORTED;
 
-    return dno->vol->fstype_table->dir_lookup(dno->vol, dno, lookup_name, child_dno_out);
+    return fsw_dnode_dir_lookup(dno, lookup_name, child_dno_out);
 }
 
 /**
@@ -624,7 +938,7 @@ fsw_status_t fsw_dnode_lookup_path(struct fsw_dnode *dno,
 
             } else {
                 // do an actual lookup
-                status = vol->fstype_table->dir_lookup(vol, dno, &lookup_name, &child_dno);
+                status = fsw_dnode_dir_lookup(dno, &lookup_name, &child_dno);
                 if (status)
                     goto errorexit;
             }
@@ -744,6 +1058,71 @@ fsw_status_t fsw_dnode_readlink_data(struct fsw_dnode *dno, struct fsw_string *l
     return status;
 }
 
+/**
+ * Find the cached target of a symlink dnode. Returns NULL if the link has not been
+ * resolved yet.
+ */
+
+static struct fsw_dnode * fsw_linkcache_get(struct fsw_dnode *dno)
+{
+    struct fsw_volume *vol = dno->vol;
+    fsw_u32         i;
+
+    for (i = 0; i < vol->linkcache_count; i++) {
+        if (vol->linkcache[i].dnode_id == dno->dnode_id &&
+            vol->linkcache[i].tree_id == dno->tree_id)
+            return vol->linkcache[i].target;
+    }
+    return NULL;
+}
+
+/**
+ * Remember the target of a symlink dnode for the life of the mount. The cache keeps
+ * its own reference to the target dnode. Failure to grow the cache is not an error,
+ * the link is just resolved again next time.
+ */
+
+static void fsw_linkcache_add(struct fsw_dnode *dno, struct fsw_dnode *target_dno)
+{
+    struct fsw_volume *vol = dno->vol;
+    struct fsw_linkcache *new_linkcache;
+    fsw_u32         new_size;
+
+    if (vol->linkcache_count == vol->linkcache_size) {
+        new_size = vol->linkcache_size + 16;
+        if (fsw_alloc(new_size * sizeof(struct fsw_linkcache), &new_linkcache))
+            return;
+        if (vol->linkcache) {
+            fsw_memcpy(new_linkcache, vol->linkcache, vol->linkcache_count * sizeof(struct fsw_linkcache));
+            fsw_free(vol->linkcache);
+        }
+        vol->linkcache = new_linkcache;
+        vol->linkcache_size = new_size;
+    }
+
+    fsw_dnode_retain(target_dno);
+    vol->linkcache[vol->linkcache_count].tree_id = dno->tree_id;
+    vol->linkcache[vol->linkcache_count].dnode_id = dno->dnode_id;
+    vol->linkcache[vol->linkcache_count].target = target_dno;
+    vol->linkcache_count++;
+}
+
+/**
+ * Release all dnodes held by the symlink cache.
+ */
+
+static void fsw_linkcache_free(struct fsw_volume *vol)
+{
+    fsw_u32         i;
+
+    for (i = 0; i < vol->linkcache_count; i++)
+        fsw_dnode_release(vol->linkcache[i].target);
+    if (vol->linkcache)
+        fsw_free(vol->linkcache);
+    vol->linkcache = NULL;
+    vol->linkcache_count = vol->linkcache_size = 0;
+}
+
 /**
  * Resolve a symbolic link. This function can be called by the host driver to make
  * sure the a dnode is fully resolved instead of pointing at a symlink. If the dnode
@@ -753,6 +1132,10 @@ fsw_status_t fsw_dnode_readlink_data(struct fsw_dnode *dno, struct fsw_string *l
  * volume. If the host is an operating system with its own VFS layer, it should
  * resolve symlinks on its own.
  *
+ * Each link is resolved through the file system only once per mount; the dnode
+ * its target path leads to is kept in the volume's symlink cache. This is safe
+ * because all supported file systems are mounted read-only.
+ *
  * If the function returns FSW_SUCCESS, *target_dno_out points at a dnode that is
  * not a symlink. The caller is responsible for calling fsw_dnode_release on it.
  */
@@ -782,16 +1165,22 @@ fsw_status_t fsw_dnode_resolve(struct fsw_dnode *dno, struct fsw_dnode **target_
             goto errorexit;
         }
 
-        // read the link's target
-        status = fsw_dnode_readlink(dno, &target_name);
-        if (status)
-            goto errorexit;
+        target_dno = fsw_linkcache_get(dno);
+        if (target_dno) {
+            fsw_dnode_retain(target_dno);
+        } else {
+            // read the link's target
+            status = fsw_dnode_readlink(dno, &target_name);
+            if (status)
+                goto errorexit;
 
-        // resolve it
-        status = fsw_dnode_lookup_path(dno->parent, &target_name, '/', &target_dno);
-        fsw_strfree(&target_name);
-        if (status)
-            goto errorexit;
+            // resolve it
+            status = fsw_dnode_lookup_path(dno->parent, &target_name, '/', &target_dno);
+            fsw_strfree(&target_name);
+            if (status)
+                goto errorexit;
+            fsw_linkcache_add(dno, target_dno);
+        }
 
         // target_dno becomes the new dno
         fsw_dnode_release(dno);
@@ -835,6 +1224,7 @@ fsw_status_t fsw_shandle_open(struct fsw_dnode *dno, struct fsw_shandle *shand)
     shand->dnode = dno;
     shand->pos = 0;
     shand->extent.type = FSW_EXTENT_TYPE_INVALID;
+    shand->extent.flags = 0;
 
     return FSW_SUCCESS;
 }
@@ -848,102 +1238,87 @@ fsw_status_t fsw_shandle_open(struct fsw_dnode *dno, struct fsw_shandle *shand)
 
 void fsw_shandle_close(struct fsw_shandle *shand)
 {
-    if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER)
+    if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER &&
+        !(shand->extent.flags & FSW_EXTENT_FLAG_BORROWED))
         fsw_free(shand->extent.buffer);
     fsw_dnode_release(shand->dnode);
 }
 
-/**
- * Read data from a shandle (storage handle for a dnode). This function is called by the
- * host driver or internally when data is read from a file. TODO: more
- */
-
-fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout, void *buffer_in)
-{
-    fsw_status_t    status;
-    struct fsw_dnode *dno = shand->dnode;
-    struct fsw_volume *vol = dno->vol;
-    fsw_u8          *buffer, *block_buffer;
-    fsw_u64         buflen, copylen, pos;
-    fsw_u64         log_bno, pos_in_extent, phys_bno, pos_in_physblock;
-    fsw_u32         cache_level;
+// Copies of fsw_shandle_read for the common geometries, where the block/byte
+// conversions become shifts by constants, and the generic fallback. All drivers
+// use equal physical and logical block sizes.
 
-    if (shand->pos >= dno->size) {   // already at EOF
-        *buffer_size_inout = 0;
-        return FSW_SUCCESS;
-    }
+#define FSW_SHANDLE_READ_NAME       fsw_shandle_read_4096
+#define FSW_SHANDLE_READ_LOG_BITS   12
+#define FSW_SHANDLE_READ_PHYS_BITS  12
+#include "fsw_shandle_read.h"
 
-    // initialize vars
-    buffer = buffer_in;
-    buflen = *buffer_size_inout;
-    pos = (fsw_u32)shand->pos;
-    cache_level = (dno->type != FSW_DNODE_TYPE_FILE) ? 1 : 0;
-    // restrict read to file size
-    if (buflen > dno->size - pos)
-        buflen = (fsw_u32)(dno->size - pos);
-
-    while (buflen > 0) {
-        // get extent for the current logical block
-        log_bno = FSW_U64_DIV(pos, vol->log_blocksize);
-        if (shand->extent.type == FSW_EXTENT_TYPE_INVALID ||
-            log_bno < shand->extent.log_start ||
-            log_bno >= shand->extent.log_start + shand->extent.log_count) {
-
-            if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER)
-                fsw_free(shand->extent.buffer);
-
-            // ask the file system for the proper extent
-            shand->extent.log_start = log_bno;
-            status = vol->fstype_table->get_extent(vol, dno, &shand->extent);
-            if (status) {
-                shand->extent.type = FSW_EXTENT_TYPE_INVALID;
-                return status;
-            }
-        }
+#define FSW_SHANDLE_READ_NAME       fsw_shandle_read_2048
+#define FSW_SHANDLE_READ_LOG_BITS   11
+#define FSW_SHANDLE_READ_PHYS_BITS  11
+#include "fsw_shandle_read.h"
 
-        pos_in_extent = pos - shand->extent.log_start * vol->log_blocksize;
+#define FSW_SHANDLE_READ_NAME       fsw_shandle_read_1024
+#define FSW_SHANDLE_READ_LOG_BITS   10
+#define FSW_SHANDLE_READ_PHYS_BITS  10
+#include "fsw_shandle_read.h"
 
-        // dispatch by extent type
-        if (shand->extent.type == FSW_EXTENT_TYPE_PHYSBLOCK) {
-            // convert to physical block number and offset
-            phys_bno = shand->extent.phys_start + FSW_U64_DIV(pos_in_extent, vol->phys_blocksize);
-            pos_in_physblock = pos_in_extent & (vol->phys_blocksize - 1);
-            copylen = vol->phys_blocksize - pos_in_physblock;
-            if (copylen > buflen)
-                copylen = buflen;
+#define FSW_SHANDLE_READ_NAME       fsw_shandle_read_512
+#define FSW_SHANDLE_READ_LOG_BITS   9
+#define FSW_SHANDLE_READ_PHYS_BITS  9
+#include "fsw_shandle_read.h"
 
-            // get one physical block
-            status = fsw_block_get(vol, phys_bno, cache_level, (void **)&block_buffer);
-            if (status)
-                return status;
+#define FSW_SHANDLE_READ_NAME       fsw_shandle_read_generic
+#include "fsw_shandle_read.h"
 
-            // copy data from it
-            fsw_memcpy(buffer, block_buffer + pos_in_physblock, copylen);
-            fsw_block_release(vol, phys_bno, block_buffer);
+static fsw_u32 fsw_blocksize_bits(fsw_u32 blocksize)
+{
+    fsw_u32 bits;
 
-        } else if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER) {
-            copylen = shand->extent.log_count * vol->log_blocksize - pos_in_extent;
-            if (copylen > buflen)
-                copylen = buflen;
-            fsw_memcpy(buffer, (fsw_u8 *)shand->extent.buffer + pos_in_extent, copylen);
+    if (blocksize == 0 || (blocksize & (blocksize - 1)))
+        return 0;
+    for (bits = 0; (1U << bits) < blocksize; bits++)
+        ;
+    return bits;
+}
 
-        } else {   // _SPARSE or _INVALID
-            copylen = shand->extent.log_count * vol->log_blocksize - pos_in_extent;
-            if (copylen > buflen)
-                copylen = buflen;
-            fsw_memzero(buffer, copylen);
+/**
+ * Pick the block geometry specialisations after the block sizes of a volume changed.
+ */
 
+static void fsw_set_geometry(struct fsw_volume *vol)
+{
+    vol->phys_blocksize_bits = fsw_blocksize_bits(vol->phys_blocksize);
+    vol->log_blocksize_bits = fsw_blocksize_bits(vol->log_blocksize);
+
+    vol->shandle_read = fsw_shandle_read_generic;
+    if (vol->phys_blocksize == vol->log_blocksize) {
+        switch (vol->log_blocksize) {
+            case 4096:
+                vol->shandle_read = fsw_shandle_read_4096;
+                break;
+            case 2048:
+                vol->shandle_read = fsw_shandle_read_2048;
+                break;
+            case 1024:
+                vol->shandle_read = fsw_shandle_read_1024;
+                break;
+            case 512:
+                vol->shandle_read = fsw_shandle_read_512;
+                break;
         }
-
-        buffer += copylen;
-        buflen -= copylen;
-        pos    += copylen;
     }
+}
 
-    *buffer_size_inout = (fsw_u32)(pos - shand->pos);
-    shand->pos = pos;
+/**
+ * Read data from a shandle (storage handle for a dnode). This function is called by the
+ * host driver or internally when data is read from a file. The work is done by the copy
+ * for the volume's block geometry that fsw_set_blocksize picked. TODO: more
+ */
 
-    return FSW_SUCCESS;
+fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout, void *buffer_in)
+{
+    return shand->dnode->vol->shandle_read(shand, buffer_size_inout, buffer_in);
 }
 
 // EOF
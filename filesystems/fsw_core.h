@@ -207,6 +207,8 @@ enum {
 struct fsw_dnode;
 struct fsw_host_table;
 struct fsw_fstype_table;
+struct fsw_shandle;
+struct fsw_dirindex;
 
 struct fsw_blockcache {
     fsw_u32     refcount;           //!< Reference count
@@ -215,6 +217,16 @@ struct fsw_blockcache {
     void        *data;              //!< Block data buffer
 };
 
+/**
+ * Core: Remembers the dnode a symbolic link points at, see fsw_dnode_resolve.
+ */
+
+struct fsw_linkcache {
+    fsw_u64     tree_id;            //!< tree_id of the symlink dnode
+    fsw_u64     dnode_id;           //!< dnode_id of the symlink dnode
+    struct fsw_dnode *target;       //!< Dnode the link's target path leads to (retained)
+};
+
 /**
  * Core: Represents a mounted volume.
  */
@@ -222,6 +234,10 @@ struct fsw_blockcache {
 struct fsw_volume {
     fsw_u32     phys_blocksize;     //!< Block size for disk access / file system structures
     fsw_u32     log_blocksize;      //!< Block size for logical file data
+    fsw_u32     phys_blocksize_bits;    //!< log2 of phys_blocksize, 0 if not a power of 2
+    fsw_u32     log_blocksize_bits;     //!< log2 of log_blocksize, 0 if not a power of 2
+    fsw_status_t (*shandle_read)(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout,
+                                 void *buffer);  //!< fsw_shandle_read copy for this block geometry
 
     struct DNODESTRUCTNAME *root;   //!< Root directory dnode
     struct fsw_string label;        //!< Volume label
@@ -230,11 +246,20 @@ struct fsw_volume {
 
     struct fsw_blockcache *bcache;  //!< Array of block cache entries
     fsw_u32     bcache_size;        //!< Number of entries in the block cache array
+    fsw_u32     bcache_last;        //!< Index of the block cache entry handed out last
+
+    struct fsw_linkcache *linkcache;    //!< Array of resolved symlinks
+    fsw_u32     linkcache_count;    //!< Number of used entries in the symlink cache array
+    fsw_u32     linkcache_size;     //!< Number of allocated entries in the symlink cache array
+
+    struct fsw_dirindex **dirindex; //!< Case-folded directory name indexes, most recently used first
+    fsw_u32     dirindex_count;     //!< Number of used entries in the name index array
 
     void        *host_data;         //!< Hook for a host-specific data structure
     struct fsw_host_table *host_table;      //!< Dispatch table for host-specific functions
     struct fsw_fstype_table *fstype_table;  //!< Dispatch table for file system specific functions
     int         host_string_type;   //!< String type used by the host environment
+    int         lookup_ignores_case;    //!< Set by the fs driver if its dir_lookup already ignores case
 };
 
 /**
@@ -279,8 +304,16 @@ struct fsw_extent {
     fsw_u32     log_count;          //!< Logical block count
     fsw_u64     phys_start;         //!< Starting physical block number (for FSW_EXTENT_TYPE_PHYSBLOCK only)
     void        *buffer;            //!< Allocated buffer pointer (for FSW_EXTENT_TYPE_BUFFER only)
+    fsw_u32     flags;              //!< Extent flags, see FSW_EXTENT_FLAG_*
 };
 
+/**
+ * Extent flags. FSW_EXTENT_FLAG_BORROWED marks a FSW_EXTENT_TYPE_BUFFER extent whose
+ * buffer is owned by the file system driver (e.g. a slice of a driver-side cache). The
+ * core does not free such a buffer and does not use it after the next get_extent call.
+ */
+#define FSW_EXTENT_FLAG_BORROWED    (0x0001)
+
 /**
  * Possible extent representation types. FSW_EXTENT_TYPE_INVALID is for shandle's
  * internal use only, it must not be returned from a get_extent function.
@@ -343,8 +376,18 @@ struct fsw_host_table
                                      fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                                      fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
     fsw_status_t EFIAPI (*read_block)(struct fsw_volume *vol, fsw_u64 phys_bno, void *buffer);
+
+    int         casefold_lookup;    //!< Directory lookups should ignore case
 };
 
+/**
+ * Core: Reads len bytes at byte offset pos straight from the device. Passed
+ * to the volume_sniff function of a file system driver, which runs before
+ * any volume structure exists.
+ */
+
+typedef fsw_status_t (*fsw_sniff_read_t)(void *host_data, fsw_u64 pos, fsw_u32 len, void *buffer);
+
 /**
  * Core: Function table for a file system driver.
  */
@@ -372,6 +415,8 @@ struct fsw_fstype_table
                              struct fsw_shandle *shand, struct DNODESTRUCTNAME **child_dno);
     fsw_status_t (*readlink)(struct VOLSTRUCTNAME *vol, struct DNODESTRUCTNAME *dno,
                              struct fsw_string *link_target);
+
+    fsw_status_t (*volume_sniff)(void *host_data, fsw_sniff_read_t read);  //!< Optional quick superblock magic check
 };
 
 
@@ -384,6 +429,8 @@ fsw_status_t fsw_mount(void *host_data,
                        struct fsw_host_table *host_table,
                        struct fsw_fstype_table *fstype_table,
                        struct fsw_volume **vol_out);
+fsw_status_t fsw_sniff(void *host_data, fsw_sniff_read_t read,
+                       struct fsw_fstype_table *fstype_table);
 void         fsw_unmount(struct fsw_volume *vol);
 fsw_status_t fsw_volume_stat(struct fsw_volume *vol, struct fsw_volume_stat *sb);
 
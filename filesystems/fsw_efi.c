@@ -68,6 +68,7 @@ EFI_GUID gMyEfiDriverBindingProtocolGuid = REFIND_EFI_DRIVER_BINDING_PROTOCOL_GU
 EFI_GUID gMyEfiComponentNameProtocolGuid = REFIND_EFI_COMPONENT_NAME_PROTOCOL_GUID;
 EFI_GUID gMyEfiDiskIoProtocolGuid = REFIND_EFI_DISK_IO_PROTOCOL_GUID;
 EFI_GUID gMyEfiBlockIoProtocolGuid = REFIND_EFI_BLOCK_IO_PROTOCOL_GUID;
+EFI_GUID gMyEfiDevicePathProtocolGuid = REFIND_EFI_DEVICE_PATH_PROTOCOL_GUID;
 EFI_GUID gMyEfiFileInfoGuid = EFI_FILE_INFO_ID;
 EFI_GUID gMyEfiFileSystemInfoGuid = EFI_FILE_SYSTEM_INFO_ID;
 EFI_GUID gMyEfiFileSystemVolumeLabelInfoIdGuid = EFI_FILE_SYSTEM_VOLUME_LABEL_INFO_ID;
@@ -155,6 +156,33 @@ struct cache_data {
 static struct cache_data    Caches[NUM_CACHES];
 static int LastRead = -1;
 
+/**
+ * Devices that the file system driver's sniff function has turned down,
+ * identified by handle, device path instance and MediaId. Repeated
+ * ConnectController passes skip them without reading the disk again; a media
+ * change gives them another try. The device path tells a different device
+ * apart that was installed on a freed and reused handle.
+ */
+
+#define NUM_REJECTS 64
+struct reject_data {
+   EFI_HANDLE        Handle;
+   VOID              *DevicePath;
+   UINT32            MediaId;
+};
+
+static struct reject_data   Rejects[NUM_REJECTS];
+static UINTN NextReject = 0;
+
+/**
+ * What fsw_efi_sniff_read() needs to read from a device that has no volume yet.
+ */
+
+struct sniff_data {
+   EFI_DISK_IO       *DiskIo;
+   UINT32            MediaId;
+};
+
 /**
  * Interface structure for the EFI Driver Binding protocol.
  */
@@ -186,7 +214,9 @@ struct fsw_host_table   fsw_efi_host_table = {
     FSW_STRING_TYPE_UTF16,
 
     fsw_efi_change_blocksize,
-    fsw_efi_read_block
+    fsw_efi_read_block,
+
+    1   // UEFI file paths are case-insensitive
 };
 
 extern struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(FSTYPE);
@@ -260,11 +290,48 @@ EFI_STATUS EFIAPI fsw_efi_main(IN EFI_HANDLE         ImageHandle,
 EFI_DRIVER_ENTRY_POINT(fsw_efi_main)
 #endif
 
+/**
+ * Read callback for fsw_sniff(): reads raw bytes through Disk I/O.
+ */
+
+static fsw_status_t fsw_efi_sniff_read(void *host_data, fsw_u64 pos, fsw_u32 len, void *buffer)
+{
+    struct sniff_data   *Sniff = (struct sniff_data *)host_data;
+    EFI_STATUS          Status;
+
+    Status = refit_call5_wrapper(Sniff->DiskIo->ReadDisk, Sniff->DiskIo, Sniff->MediaId,
+                                 pos, len, buffer);
+    return EFI_ERROR(Status) ? FSW_IO_ERROR : FSW_SUCCESS;
+}
+
+static BOOLEAN fsw_efi_is_rejected(EFI_HANDLE Handle, VOID *DevicePath, UINT32 MediaId)
+{
+    UINTN i;
+
+    for (i = 0; i < NUM_REJECTS; i++) {
+        if (Rejects[i].Handle == Handle && Rejects[i].DevicePath == DevicePath &&
+            Rejects[i].MediaId == MediaId)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static VOID fsw_efi_add_reject(EFI_HANDLE Handle, VOID *DevicePath, UINT32 MediaId)
+{
+    Rejects[NextReject].Handle     = Handle;
+    Rejects[NextReject].DevicePath = DevicePath;
+    Rejects[NextReject].MediaId    = MediaId;
+    NextReject = (NextReject + 1) % NUM_REJECTS;
+}
+
 /**
  * Driver Binding EFI protocol, Supported function. This function is called by EFI
- * to test if this driver can handle a certain device. Our implementation only checks
+ * to test if this driver can handle a certain device. Our implementation checks
  * if the device is a disk (i.e. that it supports the Block I/O and Disk I/O protocols)
- * and implicitly checks if the disk is already in use by another driver.
+ * and implicitly checks if the disk is already in use by another driver. It then
+ * lets the file system driver sniff for its superblock magic, so that Start only
+ * runs a full mount on plausible devices. Devices that fail the sniff are
+ * remembered and turned down without any disk access on later calls.
  */
 
 EFI_STATUS EFIAPI fsw_efi_DriverBinding_Supported(IN REFIND_EFI_DRIVER_BINDING_PROTOCOL  *This,
@@ -273,6 +340,9 @@ EFI_STATUS EFIAPI fsw_efi_DriverBinding_Supported(IN REFIND_EFI_DRIVER_BINDING_P
 {
     EFI_STATUS          Status;
     EFI_DISK_IO         *DiskIo;
+    EFI_BLOCK_IO        *BlockIo;
+    VOID                *DevicePath;
+    struct sniff_data   Sniff;
 
     // we check for both DiskIO and BlockIO protocols
 
@@ -286,19 +356,42 @@ EFI_STATUS EFIAPI fsw_efi_DriverBinding_Supported(IN REFIND_EFI_DRIVER_BINDING_P
     if (EFI_ERROR(Status))
         return Status;
 
+    // next, get BlockIO without actually opening it; we only want the MediaId
+    Status = refit_call6_wrapper(BS->OpenProtocol, ControllerHandle,
+                              &gMyEfiBlockIoProtocolGuid,
+                              (VOID **) &BlockIo,
+                              This->DriverBindingHandle,
+                              ControllerHandle,
+                              EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+
+    if (!EFI_ERROR(Status)) {
+        // a reused handle may carry another device, so its device path is part of the key
+        if (EFI_ERROR(refit_call6_wrapper(BS->OpenProtocol, ControllerHandle,
+                                          &gMyEfiDevicePathProtocolGuid,
+                                          &DevicePath,
+                                          This->DriverBindingHandle,
+                                          ControllerHandle,
+                                          EFI_OPEN_PROTOCOL_GET_PROTOCOL)))
+            DevicePath = NULL;
+
+        if (fsw_efi_is_rejected(ControllerHandle, DevicePath, BlockIo->Media->MediaId)) {
+            Status = EFI_UNSUPPORTED;
+        } else {
+            Sniff.DiskIo  = DiskIo;
+            Sniff.MediaId = BlockIo->Media->MediaId;
+            // only a definite "not ours" is remembered, I/O errors are left to Start
+            if (fsw_sniff(&Sniff, fsw_efi_sniff_read, &FSW_FSTYPE_TABLE_NAME(FSTYPE)) == FSW_UNSUPPORTED) {
+                fsw_efi_add_reject(ControllerHandle, DevicePath, Sniff.MediaId);
+                Status = EFI_UNSUPPORTED;
+            }
+        }
+    }
+
     // we were just checking, close it again
     refit_call4_wrapper(BS->CloseProtocol, ControllerHandle,
                       &gMyEfiDiskIoProtocolGuid,
                       This->DriverBindingHandle,
                       ControllerHandle);
-
-    // next, check BlockIO without actually opening it
-    Status = refit_call6_wrapper(BS->OpenProtocol, ControllerHandle,
-                              &gMyEfiBlockIoProtocolGuid,
-                              NULL,
-                              This->DriverBindingHandle,
-                              ControllerHandle,
-                              EFI_OPEN_PROTOCOL_TEST_PROTOCOL);
     return Status;
 }
 
@@ -55,6 +55,11 @@
     0x964e5b21, 0x6459, 0x11d2, {0x8e, 0x39, 0x0, 0xa0, 0xc9, 0x69, 0x72, 0x3b } \
   }
 
+#define REFIND_EFI_DEVICE_PATH_PROTOCOL_GUID \
+  { \
+    0x09576e91, 0x6d3f, 0x11d2, {0x8e, 0x39, 0x0, 0xa0, 0xc9, 0x69, 0x72, 0x3b } \
+  }
+
 /**
  * EFI Host: Private per-volume structure.
  */
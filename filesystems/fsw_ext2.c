@@ -26,6 +26,7 @@
 
 // functions
 
+static fsw_status_t fsw_ext2_volume_sniff(void *host_data, fsw_sniff_read_t read);
 static fsw_status_t fsw_ext2_volume_mount(struct fsw_ext2_volume *vol);
 static void         fsw_ext2_volume_free(struct fsw_ext2_volume *vol);
 static fsw_status_t fsw_ext2_volume_stat(struct fsw_ext2_volume *vol, struct fsw_volume_stat *sb);
@@ -65,8 +66,27 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(ext2) = {
     fsw_ext2_dir_lookup,
     fsw_ext2_dir_read,
     fsw_ext2_readlink,
+    fsw_ext2_volume_sniff,
 };
 
+/**
+ * Check for the ext2 superblock magic without mounting the volume.
+ */
+
+static fsw_status_t fsw_ext2_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t    status;
+    fsw_u16         magic;
+
+    status = read(host_data, EXT2_SUPERBLOCK_BLOCKNO * EXT2_SUPERBLOCK_BLOCKSIZE + EXT2_SUPER_MAGIC_OFFSET,
+                  sizeof(magic), &magic);
+    if (status)
+        return status;
+    if (magic != EXT2_SUPER_MAGIC)
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 /**
  * Mount an ext2 volume. Reads the superblock and constructs the
  * root directory dnode.
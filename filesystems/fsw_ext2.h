@@ -35,6 +35,8 @@
 #define EXT2_SUPERBLOCK_BLOCKSIZE  1024
 //! Block number where the (master copy of the) ext2 superblock resides.
 #define EXT2_SUPERBLOCK_BLOCKNO       1
+//! Byte offset of s_magic within the superblock.
+#define EXT2_SUPER_MAGIC_OFFSET      56
 
 
 /**
@@ -23,10 +23,12 @@
  */
 
 #include "fsw_ext4.h"
+#include "crc32c.c"
 
 
 // functions
 
+static fsw_status_t fsw_ext4_volume_sniff(void *host_data, fsw_sniff_read_t read);
 static fsw_status_t fsw_ext4_volume_mount(struct fsw_ext4_volume *vol);
 static void         fsw_ext4_volume_free(struct fsw_ext4_volume *vol);
 static fsw_status_t fsw_ext4_volume_stat(struct fsw_ext4_volume *vol, struct fsw_volume_stat *sb);
@@ -70,6 +72,7 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(ext4) = {
     fsw_ext4_dir_lookup,
     fsw_ext4_dir_read,
     fsw_ext4_readlink,
+    fsw_ext4_volume_sniff,
 };
 
 
@@ -100,6 +103,111 @@ fsw_ext4_group_first_block_no(struct ext4_super_block *sb, fsw_u32 group_no)
                 sb->s_first_data_block;
 }
 
+/**
+ * Check the metadata_csum checksum of a group descriptor. Only the low
+ * 16 bits of the crc32c are stored.
+ */
+
+static int fsw_ext4_group_desc_csum_ok(struct fsw_ext4_volume *vol, fsw_u32 groupno,
+                                       struct ext4_group_desc *gdesc)
+{
+    fsw_u32         offset = (fsw_u32)((fsw_u8 *)&gdesc->bg_checksum - (fsw_u8 *)gdesc);
+    fsw_u16         dummy_csum = 0;
+    fsw_u32         csum;
+
+    csum = crc32c_raw(vol->csum_seed, &groupno, sizeof(groupno));
+    csum = crc32c_raw(csum, gdesc, offset);
+    csum = crc32c_raw(csum, &dummy_csum, sizeof(dummy_csum));
+    offset += sizeof(dummy_csum);
+    if (offset < vol->sb->s_desc_size)
+        csum = crc32c_raw(csum, (fsw_u8 *)gdesc + offset, vol->sb->s_desc_size - offset);
+    return (csum & 0xFFFF) == gdesc->bg_checksum;
+}
+
+/**
+ * Check the metadata_csum checksum of a freshly read inode and derive the
+ * seed for the checksums of its extent blocks. The checksum is computed
+ * with both of its halves zeroed; the high half only exists in large
+ * inodes with enough extra space.
+ */
+
+static fsw_status_t fsw_ext4_inode_csum(struct fsw_ext4_volume *vol, struct fsw_ext4_dnode *dno)
+{
+    struct ext4_inode *raw = dno->raw;
+    fsw_u8          *base = (fsw_u8 *)raw;
+    fsw_u32         inum = (fsw_u32)dno->g.dnode_id;
+    fsw_u32         offset, csum, provided;
+    fsw_u16         dummy_csum = 0;
+    int             has_hi = 0;
+
+    csum = crc32c_raw(vol->csum_seed, &inum, sizeof(inum));
+    dno->csum_seed = crc32c_raw(csum, &raw->i_generation, sizeof(raw->i_generation));
+
+    offset = (fsw_u32)((fsw_u8 *)&raw->osd2.linux2.l_i_checksum_lo - base);
+    csum = crc32c_raw(dno->csum_seed, base, offset);
+    csum = crc32c_raw(csum, &dummy_csum, sizeof(dummy_csum));
+    offset += sizeof(dummy_csum);
+    csum = crc32c_raw(csum, base + offset, EXT4_GOOD_OLD_INODE_SIZE - offset);
+
+    if (vol->inode_size > EXT4_GOOD_OLD_INODE_SIZE) {
+        offset = (fsw_u32)((fsw_u8 *)&raw->i_checksum_hi - base);
+        csum = crc32c_raw(csum, base + EXT4_GOOD_OLD_INODE_SIZE, offset - EXT4_GOOD_OLD_INODE_SIZE);
+        if (offset + sizeof(raw->i_checksum_hi) <= EXT4_GOOD_OLD_INODE_SIZE + raw->i_extra_isize) {
+            csum = crc32c_raw(csum, &dummy_csum, sizeof(dummy_csum));
+            offset += sizeof(dummy_csum);
+            has_hi = 1;
+        }
+        csum = crc32c_raw(csum, base + offset, vol->inode_size - offset);
+    }
+
+    provided = raw->osd2.linux2.l_i_checksum_lo;
+    if (has_hi)
+        provided |= (fsw_u32)raw->i_checksum_hi << 16;
+    else
+        csum &= 0xFFFF;
+    if (csum != provided) {
+        FSW_MSG_DEBUG((FSW_MSGSTR("fsw_ext4_inode_csum: checksum mismatch in inode %d\n"), inum));
+        return FSW_VOLUME_CORRUPTED;
+    }
+    return FSW_SUCCESS;
+}
+
+/**
+ * Check the metadata_csum checksum of an extent tree block. It is stored
+ * right behind the room for eh_max entries.
+ */
+
+static int fsw_ext4_extent_block_csum_ok(struct fsw_ext4_volume *vol, struct fsw_ext4_dnode *dno,
+                                         void *buffer)
+{
+    struct ext4_extent_header *eh = (struct ext4_extent_header *)buffer;
+    fsw_u32         offset = sizeof(struct ext4_extent_header) + eh->eh_max * sizeof(struct ext4_extent);
+    struct ext4_extent_tail *et;
+
+    if (offset + sizeof(struct ext4_extent_tail) > vol->g.log_blocksize)
+        return 0;
+    et = (struct ext4_extent_tail *)((fsw_u8 *)buffer + offset);
+    return crc32c_raw(dno->csum_seed, buffer, offset) == et->et_checksum;
+}
+
+/**
+ * Check for the ext4 superblock magic without mounting the volume.
+ */
+
+static fsw_status_t fsw_ext4_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t    status;
+    fsw_u16         magic;
+
+    status = read(host_data, EXT4_SUPERBLOCK_BLOCKNO * EXT4_SUPERBLOCK_BLOCKSIZE + EXT4_SUPER_MAGIC_OFFSET,
+                  sizeof(magic), &magic);
+    if (status)
+        return status;
+    if (magic != EXT4_SUPER_MAGIC)
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 /**
  * Mount an ext4 volume. Reads the superblock and constructs the
  * root directory dnode.
@@ -152,6 +260,24 @@ static fsw_status_t fsw_ext4_volume_mount(struct fsw_ext4_volume *vol)
         // Print(L"Ext4 WARNING: This file system needs recovery, trying to use it anyway.\n");
     }
 
+    // metadata checksums: check the superblock now, the rest as it is read
+    if (EXT4_VERIFY_CSUM && vol->sb->s_rev_level == EXT4_DYNAMIC_REV &&
+        (vol->sb->s_feature_ro_compat & EXT4_FEATURE_RO_COMPAT_METADATA_CSUM) &&
+        vol->sb->s_checksum_type == EXT4_CRC32C_CHKSUM)
+    {
+        if (crc32c_raw(~0U, vol->sb, sizeof(struct ext4_super_block) - sizeof(vol->sb->s_checksum))
+            != vol->sb->s_checksum)
+        {
+            FSW_MSG_DEBUG((FSW_MSGSTR("fsw_ext4_volume_mount: superblock checksum mismatch\n")));
+            return FSW_VOLUME_CORRUPTED;
+        }
+        vol->verify_csum = 1;
+        if (vol->sb->s_feature_incompat & EXT4_FEATURE_INCOMPAT_CSUM_SEED)
+            vol->csum_seed = vol->sb->s_checksum_seed;
+        else
+            vol->csum_seed = crc32c_raw(~0U, vol->sb->s_uuid, sizeof(vol->sb->s_uuid));
+    }
+
     blocksize = EXT4_BLOCK_SIZE(vol->sb);
     if (blocksize < EXT4_MIN_BLOCK_SIZE || blocksize > EXT4_MAX_BLOCK_SIZE)
         return FSW_UNSUPPORTED;
@@ -221,6 +347,11 @@ static fsw_status_t fsw_ext4_volume_mount(struct fsw_ext4_volume *vol)
 
         // Get group descriptor table and block number of inode table...
         gdesc = (struct ext4_group_desc *)((char *)buffer + gdesc_index * vol->sb->s_desc_size);
+        if (vol->verify_csum && !fsw_ext4_group_desc_csum_ok(vol, groupno, gdesc)) {
+            FSW_MSG_DEBUG((FSW_MSGSTR("fsw_ext4_volume_mount: checksum mismatch in group descriptor %d\n"), groupno));
+            fsw_block_release(vol, gdesc_bno, buffer);
+            return FSW_VOLUME_CORRUPTED;
+        }
         vol->inotab_bno[groupno] = gdesc->bg_inode_table_lo;
         if (vol->sb->s_desc_size >= EXT4_MIN_DESC_SIZE_64BIT)
             vol->inotab_bno[groupno] |= (fsw_u64)gdesc->bg_inode_table_hi << 32;
@@ -309,6 +440,15 @@ static fsw_status_t fsw_ext4_dnode_fill(struct fsw_ext4_volume *vol, struct fsw_
     if (status)
         return status;
 
+    if (vol->verify_csum) {
+        status = fsw_ext4_inode_csum(vol, dno);
+        if (status) {
+            fsw_free(dno->raw);
+            dno->raw = NULL;
+            return status;
+        }
+    }
+
     // get info from the inode
     dno->g.size = dno->raw->i_size_lo; // TODO: check docs for 64-bit sized files
 
@@ -455,6 +595,10 @@ static fsw_status_t fsw_ext4_get_by_extent(struct fsw_ext4_volume *vol, struct f
                     status = fsw_block_get(vol, phys_bno, 1, (void **)&buffer);
                     if (status)
                         return status;
+                    if (vol->verify_csum && !fsw_ext4_extent_block_csum_ok(vol, dno, buffer)) {
+                        fsw_block_release(vol, phys_bno, buffer);
+                        return FSW_VOLUME_CORRUPTED;
+                    }
                     buf_offset = 0;
                     break;
                 }
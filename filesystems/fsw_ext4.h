@@ -36,6 +36,12 @@
 #define EXT4_SUPERBLOCK_BLOCKSIZE  1024
 //! Block number where the (master copy of the) ext4 superblock resides.
 #define EXT4_SUPERBLOCK_BLOCKNO       1
+//! Byte offset of s_magic within the superblock.
+#define EXT4_SUPER_MAGIC_OFFSET      56
+//! Verify metadata_csum checksums of the superblock, group descriptors, inodes and extent blocks.
+#ifndef EXT4_VERIFY_CSUM
+#define EXT4_VERIFY_CSUM              1
+#endif
 
 
 /**
@@ -50,6 +56,8 @@ struct fsw_ext4_volume {
     fsw_u32     ind_bcnt;           //!< Number of blocks addressable through an indirect block
     fsw_u32     dind_bcnt;          //!< Number of blocks addressable through a double-indirect block
     fsw_u32     inode_size;         //!< Size of inode structure in bytes
+    int         verify_csum;        //!< Metadata checksums present and to be verified
+    fsw_u32     csum_seed;          //!< crc32c seed for metadata checksums
 };
 
 /**
@@ -60,6 +68,7 @@ struct fsw_ext4_dnode {
     struct fsw_dnode g;             //!< Generic dnode structure
     
     struct ext4_inode *raw;         //!< Full raw inode structure
+    fsw_u32     csum_seed;          //!< crc32c seed for checksums of this inode's metadata
 };
 
 
@@ -50,6 +50,7 @@ void dump_str(fsw_u16* p, fsw_u32 len, int swap)
 }
 #endif
 
+static fsw_status_t fsw_hfs_volume_sniff(void *host_data, fsw_sniff_read_t read);
 static fsw_status_t fsw_hfs_volume_mount(struct fsw_hfs_volume *vol);
 static void         fsw_hfs_volume_free(struct fsw_hfs_volume *vol);
 static fsw_status_t fsw_hfs_volume_stat(struct fsw_hfs_volume *vol, struct fsw_volume_stat *sb);
@@ -72,6 +73,8 @@ static fsw_status_t fsw_hfs_read_dirrec(struct fsw_shandle *shand, struct hfs_di
 static fsw_status_t fsw_hfs_readlink(struct fsw_hfs_volume *vol, struct fsw_hfs_dnode *dno,
                                          struct fsw_string *link);
 
+static void         fsw_hfs_btree_free_cache(struct fsw_hfs_btree *btree);
+
 //
 // Dispatch Table
 //
@@ -91,6 +94,7 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(hfs) = {
     fsw_hfs_dir_lookup,  //retrieve the directory entry with the given name
     fsw_hfs_dir_read,	// next directory entry when reading a directory
     fsw_hfs_readlink,   // return FSW_UNSUPPORTED;
+    fsw_hfs_volume_sniff,
 };
 
 static const fsw_u16 fsw_latin_case_fold[] =
@@ -242,6 +246,25 @@ HFSGetDescription(CICell ih, char *str, long strMaxLen)
 */
 
 
+/**
+ * Check for an HFS+, HFSX or HFS (possibly wrapping HFS+) volume header
+ * signature without mounting the volume.
+ */
+
+static fsw_status_t fsw_hfs_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t    status;
+    fsw_u16         signature;
+
+    status = read(host_data, HFS_SUPERBLOCK_BLOCKNO * HFS_BLOCKSIZE, sizeof(signature), &signature);
+    if (status)
+        return status;
+    signature = be16_to_cpu(signature);
+    if (signature != kHFSPlusSigWord && signature != kHFSXSigWord && signature != kHFSSigWord)
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 static fsw_status_t fsw_hfs_volume_mount(struct fsw_hfs_volume *vol)
 {
     fsw_status_t              status, rv;
@@ -370,6 +393,7 @@ static fsw_status_t fsw_hfs_volume_mount(struct fsw_hfs_volume *vol)
         vol->case_sensitive =
                 (signature == kHFSXSigWord) &&
                 (tree_header.keyCompareType == kHFSBinaryCompare);
+        vol->g.lookup_ignores_case = !vol->case_sensitive;
         vol->catalog_tree.root_node = be32_to_cpu (tree_header.rootNode);
         vol->catalog_tree.node_size = be16_to_cpu (tree_header.nodeSize);
 
@@ -479,6 +503,8 @@ static void fsw_hfs_volume_free(struct fsw_hfs_volume *vol)
         fsw_free(vol->primary_voldesc);
         vol->primary_voldesc = NULL;
     }
+    fsw_hfs_btree_free_cache(&vol->catalog_tree);
+    fsw_hfs_btree_free_cache(&vol->extents_tree);
 }
 
 /**
@@ -511,6 +537,13 @@ static fsw_status_t fsw_hfs_dnode_fill(struct fsw_hfs_volume *vol, struct fsw_hf
 
 static void fsw_hfs_dnode_free(struct fsw_hfs_volume *vol, struct fsw_hfs_dnode *dno)
 {
+    if (dno->runs != NULL)
+    {
+        fsw_free(dno->runs);
+        dno->runs = NULL;
+    }
+    dno->run_count = 0;
+    dno->runs_loaded = 0;
 }
 
 static fsw_u32 mac_to_posix(fsw_u32 mac_time)
@@ -539,31 +572,51 @@ static fsw_status_t fsw_hfs_dnode_stat(struct fsw_hfs_volume *vol,
   return FSW_SUCCESS;
 }
 
-static int
-fsw_hfs_find_block(HFSPlusExtentRecord * exts,
-                   fsw_u32             * lbno,
-                   fsw_u32             * pbno)
+/*
+ * Append the extents of one extent record to the run list of a dnode. *used gets
+ * the number of non-empty extents in the record.
+ */
+static fsw_status_t
+fsw_hfs_add_runs(struct fsw_hfs_dnode * dno,
+                 HFSPlusExtentRecord  * exts,
+                 fsw_u32              * lbno,
+                 fsw_u32              * used)
 {
+    fsw_status_t               status;
+    struct fsw_hfs_extent_run *runs;
     int i;
-    fsw_u32 cur_lbno = *lbno;
 
+    *used = 0;
     for (i = 0; i < 8; i++)
     {
         fsw_u32 start = be32_to_cpu ((*exts)[i].startBlock);
         fsw_u32 count = be32_to_cpu ((*exts)[i].blockCount);
 
-        if (cur_lbno < count)
+        if (count == 0)
+            break;
+
+        /* grow in steps of one extent record */
+        if ((dno->run_count & 7) == 0)
         {
-            *pbno = start + cur_lbno;
-            return 1;
+            status = fsw_alloc((dno->run_count + 8) * sizeof(struct fsw_hfs_extent_run), &runs);
+            if (status)
+                return status;
+            if (dno->runs != NULL)
+            {
+                fsw_memcpy(runs, dno->runs, dno->run_count * sizeof(struct fsw_hfs_extent_run));
+                fsw_free(dno->runs);
+            }
+            dno->runs = runs;
         }
+        dno->runs[dno->run_count].log_start = *lbno;
+        dno->runs[dno->run_count].phys_start = start;
+        dno->runs[dno->run_count].count = count;
+        dno->run_count++;
 
-        cur_lbno -= count;
+        *lbno += count;
+        (*used)++;
     }
-
-    *lbno = cur_lbno;
-
-    return 0;
+    return FSW_SUCCESS;
 }
 
 /* Find record offset, numbering starts from the end */
@@ -591,6 +644,96 @@ fsw_hfs_btree_rec (struct fsw_hfs_btree   * btree,
 }
 
 
+/* Release the node cache of a B-tree */
+static void
+fsw_hfs_btree_free_cache (struct fsw_hfs_btree * btree)
+{
+    fsw_u32 i;
+
+    if (btree->cache == NULL)
+        return;
+    for (i = 0; i < HFS_BNODE_CACHE_SIZE; i++)
+    {
+        if (btree->cache[i].data != NULL)
+            fsw_free(btree->cache[i].data);
+    }
+    fsw_free(btree->cache);
+    btree->cache = NULL;
+}
+
+/*
+ * Get a B-tree node through the per-tree node cache. Index nodes are pinned, leaf
+ * nodes are replaced in LRU order. The returned node stays valid until the next
+ * call on the same tree.
+ */
+static fsw_status_t
+fsw_hfs_btree_get_node (struct fsw_hfs_btree * btree,
+                        fsw_u32                num,
+                        BTNodeDescriptor    ** node_out)
+{
+    fsw_status_t          status;
+    struct fsw_hfs_bnode *slot, *victim = NULL;
+    BTNodeDescriptor     *node;
+    fsw_u32               i;
+
+    if (btree->cache == NULL)
+    {
+        status = fsw_alloc_zero(HFS_BNODE_CACHE_SIZE * sizeof(struct fsw_hfs_bnode),
+                                (void **)&btree->cache);
+        if (status)
+            return status;
+    }
+
+    for (i = 0; i < HFS_BNODE_CACHE_SIZE; i++)
+    {
+        slot = &btree->cache[i];
+        if (slot->valid && slot->num == num)
+        {
+            slot->stamp = ++btree->stamp;
+            *node_out = (BTNodeDescriptor*)slot->data;
+            return FSW_SUCCESS;
+        }
+        /* prefer unused slots, then the least recently used unpinned one */
+        if (victim == NULL
+            || (victim->valid && !slot->valid)
+            || (victim->valid && slot->valid && victim->pinned && !slot->pinned)
+            || (victim->valid && slot->valid && victim->pinned == slot->pinned
+                && slot->stamp < victim->stamp))
+            victim = slot;
+    }
+
+    slot = victim;
+    slot->valid = 0;
+    if (slot->data == NULL)
+    {
+        status = fsw_alloc(btree->node_size, &slot->data);
+        if (status)
+            return status;
+    }
+
+    if (fsw_hfs_read_file (btree->file,
+                           (fsw_u64)num * btree->node_size,
+                           btree->node_size, slot->data) <= 0)
+        return FSW_VOLUME_CORRUPTED;
+
+    node = (BTNodeDescriptor*)slot->data;
+    if (be16_to_cpu(*(fsw_u16*)(slot->data + btree->node_size - 2)) != sizeof(BTNodeDescriptor))
+        BP("corrupted node\n");
+    if (be16_to_cpu(node->numRecords) > (btree->node_size - sizeof(BTNodeDescriptor)) / 2)
+        return FSW_VOLUME_CORRUPTED;
+
+    slot->num = num;
+    slot->valid = 1;
+    slot->pinned = (node->kind == kBTIndexNode);
+    slot->stamp = ++btree->stamp;
+    *node_out = node;
+    return FSW_SUCCESS;
+}
+
+/*
+ * Search a B-tree for a key. On success *result points to the leaf node in the
+ * node cache, it must not be freed and stays valid until the tree is accessed again.
+ */
 static fsw_status_t
 fsw_hfs_btree_search (struct fsw_hfs_btree * btree,
                       BTreeKey             * key,
@@ -600,144 +743,81 @@ fsw_hfs_btree_search (struct fsw_hfs_btree * btree,
 {
     BTNodeDescriptor* node;
     fsw_u32 currnode;
-    fsw_u32 rec;
+    fsw_u32 depth;
     fsw_status_t status;
-    fsw_u8* buffer = NULL;
 
     currnode = btree->root_node;
-    status = fsw_alloc(btree->node_size, &buffer);
-    if (status)
-        return status;
-    node = (BTNodeDescriptor*)buffer;
 
-    while (1)
+    /* the tree depth is limited to 8 levels, bound the walk against loops */
+    for (depth = 0; depth < 64; depth++)
     {
-        int cmp = 0;
-        int match;
-        fsw_u32 count;
-
-    readnode:
-        match = 0;
-        /* Read a node.  */
-        if (fsw_hfs_read_file (btree->file,
-                               (fsw_u64)currnode * btree->node_size,
-                               btree->node_size, buffer) <= 0)
-        {
-            status = FSW_VOLUME_CORRUPTED;
-            break;
-        }
+        fsw_u32 count, lower, upper;
+        int cmp;
 
-        if (be16_to_cpu(*(fsw_u16*)(buffer + btree->node_size - 2)) != sizeof(BTNodeDescriptor))
-            BP("corrupted node\n");
+        status = fsw_hfs_btree_get_node (btree, currnode, &node);
+        if (status)
+            return status;
 
         count = be16_to_cpu (node->numRecords);
 
-#if 1
-        for (rec = 0; rec < count; rec++)
+        /* find the first record greater or equal to the key */
+        lower = 0;
+        upper = count;
+        cmp = -1;
+        while (lower < upper)
         {
-             BTreeKey *currkey;
-
-             currkey = fsw_hfs_btree_rec (btree, node, rec);
-             cmp = compare_keys (currkey, key);
-             //fprintf(stderr, "rec=%d cmp=%d kind=%d \n", rec, cmp, node->kind);
-
-             /* Leaf node. */
-             if (node->kind == kBTLeafNode)
-             {
-               if (cmp == 0)
-               {
-                 /* Found!  */
-                 *result = node;
-                 *key_offset = rec;
-
-                 status = FSW_SUCCESS;
-                 goto done;
-               }
-             }
-             else if (node->kind == kBTIndexNode)
-             {
-                 fsw_u32 *pointer;
-
-                 if (cmp > 0)
-                     break;
-
-                 pointer = (fsw_u32 *) ((char *) currkey
-                                        + be16_to_cpu (currkey->length16)
-                                        + 2);
-                 currnode = be32_to_cpu (*pointer);
-                 match = 1;
-             }
+            fsw_u32 index = lower + (upper - lower) / 2;
+
+            cmp = compare_keys (fsw_hfs_btree_rec (btree, node, index), key);
+            if (cmp < 0)
+                lower = index + 1;
+            else
+                upper = index;
         }
 
-        if (node->kind == kBTLeafNode && cmp < 0 && node->fLink)
+        if (node->kind == kBTLeafNode)
+        {
+            if (lower < count
+                && compare_keys (fsw_hfs_btree_rec (btree, node, lower), key) == 0)
+            {
+                /* Found!  */
+                *result = node;
+                *key_offset = lower;
+                return FSW_SUCCESS;
+            }
+            /* all records are smaller, the key may start the next leaf */
+            if (lower == count && count > 0 && node->fLink)
+            {
+                currnode = be32_to_cpu(node->fLink);
+                continue;
+            }
+            return FSW_NOT_FOUND;
+        }
+        else if (node->kind == kBTIndexNode)
         {
-            currnode = be32_to_cpu(node->fLink);
-            goto readnode;
+            BTreeKey *currkey;
+            fsw_u32  *pointer;
+
+            /* follow the last record not greater than the key */
+            if (lower < count
+                && compare_keys (fsw_hfs_btree_rec (btree, node, lower), key) == 0)
+                lower++;
+            if (lower == 0)
+                return FSW_NOT_FOUND;
+
+            currkey = fsw_hfs_btree_rec (btree, node, lower - 1);
+            pointer = (fsw_u32 *) ((char *) currkey
+                                   + be16_to_cpu (currkey->length16)
+                                   + 2);
+            currnode = be32_to_cpu (*pointer);
         }
-        else if (!match)
+        else
         {
-            status = FSW_NOT_FOUND;
-            break;
+            return FSW_VOLUME_CORRUPTED;
         }
-#else
-         /* Perform binary search */
-         fsw_u32 lower = 0;
-         fsw_u32 upper = count - 1;
-         fsw_s32 cmp = -1;
-         BTreeKey *currkey = NULL;
-
-         if (count == 0)
-         {
-             status = FSW_NOT_FOUND;
-             goto done;
-         }
-
-         while (lower <= upper)
-         {
-             fsw_u32 index = (lower + upper) / 2;
-
-             currkey = fsw_hfs_btree_rec (btree, node, index);
-
-             cmp = compare_keys (currkey, key);
-             if (cmp < 0)  upper = index - 1;
-             if (cmp > 0)  lower = index + 1;
-             if (cmp == 0)
-             {
-                 /* Found!  */
-                 *result = node;
-                 *key_offset = rec;
-
-                 status = FSW_SUCCESS;
-                 goto done;
-             }
-         }
-
-         if (cmp < 0)
-             currkey = fsw_hfs_btree_rec (btree, node, upper);
-
-         if (node->kind == kBTIndexNode && currkey)
-         {
-             fsw_u32 *pointer;
-
-             pointer = (fsw_u32 *) ((char *) currkey
-                                    + be16_to_cpu (currkey->length16)
-                                    + 2);
-             currnode = be32_to_cpu (*pointer);
-         }
-         else
-         {
-             status = FSW_NOT_FOUND;
-             break;
-         }
-#endif
     }
 
-
-  done:
-    if (buffer != NULL && status != FSW_SUCCESS)
-        fsw_free(buffer);
-
-    return status;
+    return FSW_VOLUME_CORRUPTED;
 }
 typedef struct
 {
@@ -846,13 +926,7 @@ fsw_hfs_btree_iterate_node (struct fsw_hfs_btree * btree,
                             void                  * param)
 {
   fsw_status_t status;
-  /* We modify node, so make a copy */
   BTNodeDescriptor*     node = first_node;
-  fsw_u8* buffer = NULL;
-
-  status = fsw_alloc(btree->node_size, &buffer);
-  if (status)
-      return status;
 
   while (1)
   {
@@ -885,21 +959,13 @@ fsw_hfs_btree_iterate_node (struct fsw_hfs_btree * btree,
           break;
       }
 
-      if (fsw_hfs_read_file (btree->file,
-                             next_node * btree->node_size,
-                             btree->node_size, buffer) <= 0)
-      {
-          status = FSW_VOLUME_CORRUPTED;
-          return 1;
-      }
+      status = fsw_hfs_btree_get_node (btree, next_node, &node);
+      if (status)
+          break;
 
-      node = (BTNodeDescriptor*)buffer;
       first_rec = 0;
   }
  done:
-  if (buffer)
-      fsw_free(buffer);
-
   return status;
 }
 
@@ -983,6 +1049,7 @@ fsw_hfs_cmp_catkey (BTreeKey *key1, BTreeKey *key2)
   }
 }
 
+/* Case-insensitive compare, key2 must be case-folded and free of null characters */
 static int
 fsw_hfs_cmpi_catkey (BTreeKey *key1, BTreeKey *key2)
 {
@@ -1022,12 +1089,8 @@ fsw_hfs_cmpi_catkey (BTreeKey *key1, BTreeKey *key2)
     };
     ac = (fsw_u16)lc;
 
-    /* get next valid character from ckey2 */
-    for (lc = 0; lc == 0 && bpos < ckey2->nodeName.length; bpos++) {
-      bc = p2[bpos];
-      lc = bc ? fsw_to_lower(bc) : 0;
-    };
-    bc = (fsw_u16)lc;
+    /* next character from ckey2, already case-folded by the caller */
+    bc = bpos < ckey2->nodeName.length ? p2[bpos++] : 0;
 
     if (ac != bc || (ac == 0  && bc == 0))
       return ac - bc;
@@ -1047,57 +1110,82 @@ static fsw_status_t fsw_hfs_get_extent(struct fsw_hfs_volume * vol,
                                        struct fsw_extent     * extent)
 {
     fsw_status_t         status;
-    fsw_u32              lbno;
-    HFSPlusExtentRecord  *exts;
-    BTNodeDescriptor     *node = NULL;
-
-    extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
-    extent->log_count = 1;
-    lbno = extent->log_start;
-
-    /* we only care about data forks atm, do we? */
-    exts = &dno->extents;
-
-    while (1)
+    fsw_u32              lbno, used;
+    fsw_u32              lower, upper;
+
+    /*
+     * Build the complete extent list of the data fork on first access: the
+     * inline record plus every record from the extents overflow file.
+     */
+    if (!dno->runs_loaded)
     {
-        struct HFSPlusExtentKey* key;
-        struct HFSPlusExtentKey  overflowkey;
-        fsw_u32                  ptr;
-        fsw_u32                  phys_bno;
+        HFSPlusExtentRecord      *exts = &dno->extents;
 
-        if (fsw_hfs_find_block(exts, &lbno, &phys_bno))
+        lbno = 0;
+        while (1)
         {
-            extent->phys_start = phys_bno + vol->emb_block_off;
-            status = FSW_SUCCESS;
-            break;
+            struct HFSPlusExtentKey* key;
+            struct HFSPlusExtentKey  overflowkey;
+            BTNodeDescriptor        *node;
+            fsw_u32                  ptr;
+
+            status = fsw_hfs_add_runs(dno, exts, &lbno, &used);
+            if (status)
+                goto fail;
+
+            /* a partly used record is the last one, the extents file never overflows */
+            if (used < 8 || dno->g.dnode_id == kHFSExtentsFileID)
+                break;
+
+            /* Find appropriate overflow record */
+            overflowkey.fileID = dno->g.dnode_id;
+            overflowkey.forkType = 0;
+            overflowkey.startBlock = lbno;
+
+            status = fsw_hfs_btree_search (&vol->extents_tree,
+                                           (BTreeKey*)&overflowkey,
+                                           fsw_hfs_cmp_extkey,
+                                           &node, &ptr);
+            if (status == FSW_NOT_FOUND)
+                break;
+            if (status)
+                goto fail;
+
+            key = (struct HFSPlusExtentKey *)
+                    fsw_hfs_btree_rec (&vol->extents_tree, node, ptr);
+            exts = (HFSPlusExtentRecord*) (key + 1);
         }
+        dno->runs_loaded = 1;
+    }
 
+    /* binary search for the run holding the block */
+    lbno = extent->log_start;
+    lower = 0;
+    upper = dno->run_count;
+    while (lower < upper)
+    {
+        fsw_u32 index = lower + (upper - lower) / 2;
+        struct fsw_hfs_extent_run *run = &dno->runs[index];
 
-        /* Find appropriate overflow record */
-        overflowkey.fileID = dno->g.dnode_id;
-        overflowkey.startBlock = extent->log_start - lbno;
-
-        if (node != NULL)
+        if (lbno < run->log_start)
+            upper = index;
+        else if (lbno - run->log_start >= run->count)
+            lower = index + 1;
+        else
         {
-            fsw_free(node);
-            node = NULL;
+            extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
+            extent->phys_start = run->phys_start + (lbno - run->log_start) + vol->emb_block_off;
+            extent->log_count = run->count - (lbno - run->log_start);
+            return FSW_SUCCESS;
         }
-
-        status = fsw_hfs_btree_search (&vol->extents_tree,
-                                       (BTreeKey*)&overflowkey,
-                                       fsw_hfs_cmp_extkey,
-                                       &node, &ptr);
-        if (status)
-            break;
-
-        key = (struct HFSPlusExtentKey *)
-                fsw_hfs_btree_rec (&vol->extents_tree, node, ptr);
-        exts = (HFSPlusExtentRecord*) (key + 1);
     }
+    return FSW_NOT_FOUND;
 
-    if (node != NULL)
-        fsw_free(node);
-
+fail:
+    if (dno->runs != NULL)
+        fsw_free(dno->runs);
+    dno->runs = NULL;
+    dno->run_count = 0;
     return status;
 }
 
@@ -1229,6 +1317,19 @@ static fsw_status_t fsw_hfs_dir_lookup(struct fsw_hfs_volume * vol,
 
     catkey.keyLength = (fsw_u16)(5 + rec_name.size);
 
+    /* case-fold the search key once, the comparison only folds the on-disk side */
+    if (!vol->case_sensitive)
+    {
+        fsw_u16 len = 0;
+
+        for (i = 0; i < catkey.nodeName.length; i++)
+        {
+            if (catkey.nodeName.unicode[i] != 0)
+                catkey.nodeName.unicode[len++] = fsw_to_lower(catkey.nodeName.unicode[i]);
+        }
+        catkey.nodeName.length = len;
+    }
+
     status = fsw_hfs_btree_search (&vol->catalog_tree,
                                    (BTreeKey*)&catkey,
                                    vol->case_sensitive ?
@@ -1287,9 +1388,6 @@ create:
 
 done:
 
-    if (node != NULL)
-        fsw_free(node);
-
     if (free_data)
         fsw_strfree(&rec_name);
 
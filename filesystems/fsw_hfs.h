@@ -88,6 +88,17 @@ typedef enum {
     FSW_HFS_PLUS_EMB
 } fsw_hfs_kind;
 
+/**
+ * HFS: One contiguous run of a fork, in allocation blocks.
+ */
+
+struct fsw_hfs_extent_run
+{
+  fsw_u32                   log_start;  //!< First logical block of the run
+  fsw_u32                   phys_start; //!< First allocation block of the run
+  fsw_u32                   count;      //!< Number of blocks in the run
+};
+
 /**
  * HFS: Dnode structure with HFS-specific data.
  */
@@ -99,6 +110,24 @@ struct fsw_hfs_dnode
   fsw_u32                   ctime;
   fsw_u32                   mtime;
   fsw_u64                   used_bytes;
+  struct fsw_hfs_extent_run * runs;     //!< Complete extent list of the data fork, sorted
+  fsw_u32                   run_count;  //!< Number of entries in runs
+  int                       runs_loaded; //!< Set once runs has been built
+};
+
+//! Number of B-tree nodes cached per tree.
+#define HFS_BNODE_CACHE_SIZE     64
+
+/**
+ * HFS: Cached B-tree node.
+ */
+struct fsw_hfs_bnode
+{
+    fsw_u32                  num;       //!< Node number
+    fsw_u32                  stamp;     //!< Last access, for LRU replacement
+    int                      valid;     //!< Data holds node num
+    int                      pinned;    //!< Index node, kept in the cache
+    fsw_u8                 * data;      //!< Raw node contents
 };
 
 /**
@@ -109,6 +138,8 @@ struct fsw_hfs_btree
     fsw_u32                  root_node;
     fsw_u32                  node_size;
     struct fsw_hfs_dnode*    file;
+    struct fsw_hfs_bnode   * cache;     //!< Node cache, allocated on first use
+    fsw_u32                  stamp;     //!< Node cache access counter
 };
 
 
@@ -80,6 +80,7 @@
 // extern MESSAGE_LOG_PROTOCOL *Msg;
 // functions
 
+static fsw_status_t fsw_iso9660_volume_sniff(void *host_data, fsw_sniff_read_t read);
 static fsw_status_t fsw_iso9660_volume_mount(struct fsw_iso9660_volume *vol);
 static void         fsw_iso9660_volume_free(struct fsw_iso9660_volume *vol);
 static fsw_status_t fsw_iso9660_volume_stat(struct fsw_iso9660_volume *vol, struct fsw_volume_stat *sb);
@@ -103,6 +104,14 @@ static fsw_status_t fsw_iso9660_readlink(struct fsw_iso9660_volume *vol, struct
 static fsw_status_t rr_find_sp(struct iso9660_dirrec *dirrec, struct fsw_rock_ridge_susp_sp **psp);
 static fsw_status_t rr_find_nm(struct fsw_iso9660_volume *vol, struct iso9660_dirrec *dirrec, int off, struct fsw_string *str);
 static fsw_status_t rr_read_ce(struct fsw_iso9660_volume *vol, union fsw_rock_ridge_susp_ce *ce, fsw_u8 *begin);
+
+static fsw_status_t fsw_iso9660_read_path_table(struct fsw_iso9660_volume *vol, fsw_u32 location, fsw_u32 size,
+                                                fsw_u32 root_extent);
+static void         fsw_iso9660_free_path_table(struct fsw_iso9660_volume *vol);
+static fsw_status_t fsw_iso9660_pt_lookup(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno,
+                                          struct fsw_string *key, struct fsw_string *lookup_name,
+                                          struct fsw_iso9660_dnode **child_dno_out);
+static fsw_status_t fsw_iso9660_dir_index(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno);
 //static void dump_dirrec(struct iso9660_dirrec *dirrec);
 //
 // Dispatch Table
@@ -123,6 +132,7 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(iso9660) = {
     fsw_iso9660_dir_lookup,
     fsw_iso9660_dir_read,
     fsw_iso9660_readlink,
+    fsw_iso9660_volume_sniff,
 };
 
 static fsw_status_t rr_find_sp(struct iso9660_dirrec *dirrec, struct fsw_rock_ridge_susp_sp **psp)
@@ -253,6 +263,202 @@ static fsw_status_t rr_read_ce(struct fsw_iso9660_volume *vol, union fsw_rock_ri
     }*/
     return FSW_SUCCESS;
 }
+
+/**
+ * Compare two names byte by byte. This defines the order of the path table and
+ * directory name indices; it does not need to match the ISO9660 collating order.
+ */
+
+static int fsw_iso9660_namecmp(const void *name1, fsw_u32 len1, const void *name2, fsw_u32 len2)
+{
+    const fsw_u8    *n1 = name1, *n2 = name2;
+    fsw_u32         i, len;
+
+    len = (len1 < len2) ? len1 : len2;
+    for (i = 0; i < len; i++) {
+        if (n1[i] != n2[i])
+            return (int)n1[i] - (int)n2[i];
+    }
+    return (len1 < len2) ? -1 : (len1 > len2);
+}
+
+typedef int (*fsw_iso9660_cmp_t)(void *ctx, fsw_u32 a, fsw_u32 b);
+
+static void fsw_iso9660_sift_down(fsw_u32 *idx, fsw_u32 root, fsw_u32 count, fsw_iso9660_cmp_t cmp, void *ctx)
+{
+    fsw_u32 child, tmp;
+
+    while ((child = 2 * root + 1) < count) {
+        if (child + 1 < count && cmp(ctx, idx[child], idx[child + 1]) < 0)
+            child++;
+        if (cmp(ctx, idx[root], idx[child]) >= 0)
+            return;
+        tmp = idx[root];
+        idx[root] = idx[child];
+        idx[child] = tmp;
+        root = child;
+    }
+}
+
+/**
+ * Fill an index array with 0..count-1 and heap sort it using the given comparison
+ * function. The comparison functions break ties by index, so the result is stable.
+ */
+
+static void fsw_iso9660_sort(fsw_u32 *idx, fsw_u32 count, fsw_iso9660_cmp_t cmp, void *ctx)
+{
+    fsw_u32 i, tmp;
+
+    for (i = 0; i < count; i++)
+        idx[i] = i;
+    if (count < 2)
+        return;
+    for (i = count / 2; i-- > 0; )
+        fsw_iso9660_sift_down(idx, i, count, cmp, ctx);
+    for (i = count - 1; i > 0; i--) {
+        tmp = idx[0];
+        idx[0] = idx[i];
+        idx[i] = tmp;
+        fsw_iso9660_sift_down(idx, 0, i, cmp, ctx);
+    }
+}
+
+static int fsw_iso9660_pt_cmp_name(void *ctx, fsw_u32 a, fsw_u32 b)
+{
+    struct fsw_iso9660_ptentry *pt = ctx;
+    int r;
+
+    if (pt[a].parent != pt[b].parent)
+        return (pt[a].parent < pt[b].parent) ? -1 : 1;
+    r = fsw_iso9660_namecmp(pt[a].name, pt[a].name_len, pt[b].name, pt[b].name_len);
+    if (r)
+        return r;
+    return (a < b) ? -1 : (a > b);
+}
+
+static int fsw_iso9660_pt_cmp_extent(void *ctx, fsw_u32 a, fsw_u32 b)
+{
+    struct fsw_iso9660_ptentry *pt = ctx;
+
+    if (pt[a].extent_location != pt[b].extent_location)
+        return (pt[a].extent_location < pt[b].extent_location) ? -1 : 1;
+    return (a < b) ? -1 : (a > b);
+}
+
+static int fsw_iso9660_dirent_cmp_name(void *ctx, fsw_u32 a, fsw_u32 b)
+{
+    struct fsw_iso9660_dirent *d = ctx;
+    int r;
+
+    r = fsw_iso9660_namecmp(d[a].name.data, d[a].name.len, d[b].name.data, d[b].name.len);
+    if (r)
+        return r;
+    return (a < b) ? -1 : (a > b);
+}
+
+/**
+ * Load the type L path table into memory. The path table lists every directory
+ * of the volume together with its parent and extent, which lets dir_lookup
+ * resolve directory components without reading the parent directory. A
+ * missing or inconsistent path table is not fatal; lookups then go through
+ * the directory name index only.
+ */
+
+static fsw_status_t fsw_iso9660_read_path_table(struct fsw_iso9660_volume *vol, fsw_u32 location, fsw_u32 size,
+                                                fsw_u32 root_extent)
+{
+    fsw_status_t    status;
+    void            *buffer;
+    fsw_u32         i, off, count, copylen, bno, parent;
+    fsw_u8          *rec;
+    struct fsw_iso9660_ptentry *e;
+
+    if (location == 0 || size < 10 || size > ISO9660_PATH_TABLE_MAX)
+        return FSW_UNSUPPORTED;
+
+    // read the raw table
+    status = fsw_alloc(size, &vol->path_table);
+    if (status)
+        return status;
+    for (off = 0; off < size; off += copylen) {
+        bno = location + (off >> ISO9660_BLOCKSIZE_BITS);
+        status = fsw_block_get(vol, bno, 0, &buffer);
+        if (status)
+            return status;
+        copylen = size - off;
+        if (copylen > ISO9660_BLOCKSIZE)
+            copylen = ISO9660_BLOCKSIZE;
+        fsw_memcpy(vol->path_table + off, buffer, copylen);
+        fsw_block_release(vol, bno, buffer);
+    }
+
+    // count the records; each one has 8 fixed bytes and an identifier padded to even length
+    for (count = 0, off = 0; off + 8 <= size; count++) {
+        rec = vol->path_table + off;
+        if (rec[0] == 0 || off + 8 + rec[0] > size)
+            break;
+        off += 8 + rec[0] + (rec[0] & 1);
+    }
+    if (count == 0)
+        return FSW_VOLUME_CORRUPTED;
+
+    status = fsw_alloc(count * sizeof(struct fsw_iso9660_ptentry), &vol->pt);
+    if (status)
+        return status;
+    status = fsw_alloc(count * sizeof(fsw_u32), &vol->pt_by_name);
+    if (status)
+        return status;
+    status = fsw_alloc(count * sizeof(fsw_u32), &vol->pt_by_extent);
+    if (status)
+        return status;
+
+    for (i = 0, off = 0; i < count; i++) {
+        rec = vol->path_table + off;
+        e = &vol->pt[i];
+        e->name_len = rec[0];
+        e->name = rec + 8;
+        e->extent_location = rec[2] | (rec[3] << 8) | (rec[4] << 16) | ((fsw_u32)rec[5] << 24);
+        parent = rec[6] | (rec[7] << 8);
+        // directory numbers are 1-based and parents always precede their children
+        if (parent == 0 || parent > i + 1)
+            return FSW_VOLUME_CORRUPTED;
+        e->parent = parent - 1;
+        off += 8 + rec[0] + (rec[0] & 1);
+    }
+    if (vol->pt[0].parent != 0 || vol->pt[0].extent_location != root_extent)
+        return FSW_VOLUME_CORRUPTED;
+
+    fsw_iso9660_sort(vol->pt_by_name, count, fsw_iso9660_pt_cmp_name, vol->pt);
+    fsw_iso9660_sort(vol->pt_by_extent, count, fsw_iso9660_pt_cmp_extent, vol->pt);
+    vol->pt_count = count;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Release the in-memory path table.
+ */
+
+static void fsw_iso9660_free_path_table(struct fsw_iso9660_volume *vol)
+{
+    if (vol->path_table) {
+        fsw_free(vol->path_table);
+        vol->path_table = NULL;
+    }
+    if (vol->pt) {
+        fsw_free(vol->pt);
+        vol->pt = NULL;
+    }
+    if (vol->pt_by_name) {
+        fsw_free(vol->pt_by_name);
+        vol->pt_by_name = NULL;
+    }
+    if (vol->pt_by_extent) {
+        fsw_free(vol->pt_by_extent);
+        vol->pt_by_extent = NULL;
+    }
+    vol->pt_count = 0;
+}
+
 /*
 static void dump_dirrec(struct iso9660_dirrec *dirrec)
 {
@@ -264,6 +470,25 @@ static void dump_dirrec(struct iso9660_dirrec *dirrec)
         DEBUG((DEBUG_INFO, "%d: (%d:%x)%c ", i, r[i], r[i], r[i]));
     }
 }*/
+/**
+ * Check that the first volume descriptor carries a "CD" standard identifier
+ * without mounting the volume.
+ */
+
+static fsw_status_t fsw_iso9660_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t    status;
+    struct iso9660_volume_descriptor voldesc;
+
+    status = read(host_data, (fsw_u64)ISO9660_SUPERBLOCK_BLOCKNO * ISO9660_BLOCKSIZE,
+                  sizeof(voldesc), &voldesc);
+    if (status)
+        return status;
+    if (!fsw_memeq(voldesc.standard_identifier, "CD", 2))
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 /**
  * Mount an ISO9660 volume. Reads the superblock and constructs the
  * root directory dnode.
@@ -376,6 +601,13 @@ static fsw_status_t fsw_iso9660_volume_mount(struct fsw_iso9660_volume *vol)
         }
     }
 #endif
+
+    // load the path table for directory lookups, it is optional
+    if (fsw_iso9660_read_path_table(vol, pvoldesc->location_type_l_path_table,
+                                    ISOINT(pvoldesc->path_table_size),
+                                    ISOINT(rootdir.extent_location)) != FSW_SUCCESS)
+        fsw_iso9660_free_path_table(vol);
+
     // release volume descriptors
     fsw_free(vol->primary_voldesc);
     vol->primary_voldesc = NULL;
@@ -397,6 +629,7 @@ static void fsw_iso9660_volume_free(struct fsw_iso9660_volume *vol)
 {
     if (vol->primary_voldesc)
         fsw_free(vol->primary_voldesc);
+    fsw_iso9660_free_path_table(vol);
 }
 
 /**
@@ -438,6 +671,15 @@ static fsw_status_t fsw_iso9660_dnode_fill(struct fsw_iso9660_volume *vol, struc
 
 static void fsw_iso9660_dnode_free(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno)
 {
+    fsw_u32 i;
+
+    if (dno->dirents) {
+        for (i = 0; i < dno->dirent_count; i++)
+            fsw_strfree(&dno->dirents[i].name);
+        fsw_free(dno->dirents);
+    }
+    if (dno->dirents_by_name)
+        fsw_free(dno->dirents_by_name);
 }
 
 /**
@@ -484,56 +726,256 @@ static fsw_status_t fsw_iso9660_get_extent(struct fsw_iso9660_volume *vol, struc
 }
 
 /**
- * Lookup a directory's child dnode by name. This function is called on a directory
- * to retrieve the directory entry with the given name. A dnode is constructed for
- * this entry and returned. The core makes sure that fsw_iso9660_dnode_fill has been called
- * and the dnode is actually a directory.
+ * Set up a dnode for an entry of a directory's name index.
  */
 
-static fsw_status_t fsw_iso9660_dir_lookup(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno,
-                                           struct fsw_string *lookup_name, struct fsw_iso9660_dnode **child_dno_out)
+static fsw_status_t fsw_iso9660_dirent_dnode(struct fsw_iso9660_dnode *dno, struct fsw_iso9660_dirent *d,
+                                             struct fsw_iso9660_dnode **child_dno_out)
+{
+    fsw_status_t    status;
+
+    status = fsw_dnode_create(dno, d->ino, FSW_DNODE_TYPE_UNKNOWN, &d->name, child_dno_out);
+    if (status == FSW_SUCCESS)
+        fsw_memcpy(&(*child_dno_out)->dirrec, &d->dirrec, sizeof(struct iso9660_dirrec));
+    return status;
+}
+
+/**
+ * Build the name index of a directory. All directory records are read and their
+ * names (including Rock Ridge names) decoded once; the entries are kept in on-disk
+ * order for dir_read and a second array sorts them by name for dir_lookup. The
+ * index lives as long as the dnode.
+ */
+
+static fsw_status_t fsw_iso9660_dir_index(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno)
 {
     fsw_status_t    status;
     struct fsw_shandle shand;
     struct iso9660_dirrec_buffer dirrec_buffer;
     struct iso9660_dirrec *dirrec = &dirrec_buffer.dirrec;
+    struct fsw_iso9660_dirent *dirents = NULL;
+    struct fsw_iso9660_dirent *new_dirents, *d;
+    fsw_u32         *by_name = NULL;
+    fsw_u32         i, count = 0, allocated = 0, pos;
 
-    // Preconditions: The caller has checked that dno is a directory node.
+    if (dno->indexed)
+        return FSW_SUCCESS;
 
-    // setup handle to read the directory
     status = fsw_shandle_open(dno, &shand);
     if (status)
         return status;
 
-    // scan the directory for the file
-    while (1) {
-        // read next entry
+    while (shand.pos < dno->g.size) {
+        pos = (fsw_u32)shand.pos;
         status = fsw_iso9660_read_dirrec(vol, &shand, &dirrec_buffer);
         if (status)
             goto errorexit;
         if (dirrec->dirrec_length == 0) {
-            // end of directory reached
-            status = FSW_NOT_FOUND;
-            goto errorexit;
+            // records never cross a block boundary, the rest of this block is padding
+            shand.pos = (pos & ~(vol->g.log_blocksize - 1)) + vol->g.log_blocksize;
+            continue;
         }
 
         // skip . and ..
         if (dirrec->file_identifier_length == 1 &&
-            (dirrec->file_identifier[0] == 0 || dirrec->file_identifier[0] == 1))
+            (dirrec->file_identifier[0] == 0 || dirrec->file_identifier[0] == 1)) {
+            if (dirrec_buffer.name.data != dirrec->file_identifier)
+                fsw_strfree(&dirrec_buffer.name);
             continue;
+        }
+
+        if (count == allocated) {
+            allocated = allocated ? allocated << 1 : 32;
+            status = fsw_alloc(allocated * sizeof(struct fsw_iso9660_dirent), &new_dirents);
+            if (status)
+                goto errorexit;
+            if (dirents) {
+                fsw_memcpy(new_dirents, dirents, count * sizeof(struct fsw_iso9660_dirent));
+                fsw_free(dirents);
+            }
+            dirents = new_dirents;
+        }
+
+        d = &dirents[count];
+        d->ino = dirrec_buffer.ino;
+        d->pos = pos;
+        d->next_pos = (fsw_u32)shand.pos;
+        fsw_memcpy(&d->dirrec, dirrec, sizeof(struct iso9660_dirrec));
+        if (dirrec_buffer.name.data == dirrec->file_identifier) {
+            status = fsw_strdup_coerce(&d->name, FSW_STRING_TYPE_ISO88591, &dirrec_buffer.name);
+            if (status)
+                goto errorexit;
+        } else {
+            d->name = dirrec_buffer.name;   // take over the decoded Rock Ridge name
+        }
+        count++;
+    }
+
+    if (count > 0) {
+        status = fsw_alloc(count * sizeof(fsw_u32), &by_name);
+        if (status)
+            goto errorexit;
+        fsw_iso9660_sort(by_name, count, fsw_iso9660_dirent_cmp_name, dirents);
+    }
 
-        // compare name
-        if (fsw_streq(lookup_name, &dirrec_buffer.name))  // TODO: compare case-insensitively
+    dno->dirents = dirents;
+    dno->dirents_by_name = by_name;
+    dno->dirent_count = count;
+    dno->indexed = 1;
+    fsw_shandle_close(&shand);
+    return FSW_SUCCESS;
+
+errorexit:
+    for (i = 0; i < count; i++)
+        fsw_strfree(&dirents[i].name);
+    if (dirents)
+        fsw_free(dirents);
+    fsw_shandle_close(&shand);
+    return status;
+}
+
+/**
+ * Resolve a subdirectory through the path table. Returns FSW_NOT_FOUND if the
+ * path table does not know the name, in which case the caller falls back to
+ * the directory's name index (the name may still belong to a file).
+ */
+
+static fsw_status_t fsw_iso9660_pt_lookup(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno,
+                                          struct fsw_string *key, struct fsw_string *lookup_name,
+                                          struct fsw_iso9660_dnode **child_dno_out)
+{
+    fsw_status_t    status;
+    fsw_u32         extent, parent, lo, hi, mid;
+    struct fsw_iso9660_ptentry *e = NULL;
+    struct fsw_string name;
+    struct iso9660_dirrec dirrec;
+    struct iso9660_dirrec *dot;
+    void            *buffer;
+
+    // find the path table entry of the directory itself
+    extent = ISOINT(dno->dirrec.extent_location);
+    lo = 0;
+    hi = vol->pt_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (vol->pt[vol->pt_by_extent[mid]].extent_location < extent)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo >= vol->pt_count || vol->pt[vol->pt_by_extent[lo]].extent_location != extent)
+        return FSW_NOT_FOUND;
+    parent = vol->pt_by_extent[lo];
+
+    // binary search for the child by (parent, name)
+    lo = 0;
+    hi = vol->pt_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        e = &vol->pt[vol->pt_by_name[mid]];
+        if (e->parent < parent ||
+            (e->parent == parent && fsw_iso9660_namecmp(e->name, e->name_len, key->data, key->len) < 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (; lo < vol->pt_count; lo++) {
+        e = &vol->pt[vol->pt_by_name[lo]];
+        if (e->parent != parent || fsw_iso9660_namecmp(e->name, e->name_len, key->data, key->len) != 0)
+            return FSW_NOT_FOUND;
+        name.type = FSW_STRING_TYPE_ISO88591;
+        name.len = name.size = e->name_len;
+        name.data = e->name;
+        if (vol->pt_by_name[lo] != parent && fsw_streq(lookup_name, &name))
             break;
     }
+    if (lo >= vol->pt_count)
+        return FSW_NOT_FOUND;
+
+    // the directory's own "." record supplies the rest of the directory record
+    status = fsw_block_get(vol, e->extent_location, 1, &buffer);
+    if (status)
+        return status;
+    dot = (struct iso9660_dirrec *)buffer;
+    if (dot->dirrec_length >= sizeof(struct iso9660_dirrec) && (dot->file_flags & 0x02) &&
+        ISOINT(dot->extent_location) == e->extent_location) {
+        fsw_memcpy(&dirrec, dot, sizeof(struct iso9660_dirrec));
+        status = FSW_SUCCESS;
+    } else {
+        status = FSW_NOT_FOUND;
+    }
+    fsw_block_release(vol, e->extent_location, buffer);
+    if (status)
+        return status;
 
     // setup a dnode for the child item
-    status = fsw_dnode_create(dno, dirrec_buffer.ino, FSW_DNODE_TYPE_UNKNOWN, &dirrec_buffer.name, child_dno_out);
+    status = fsw_dnode_create(dno, (fsw_u64)e->extent_location << ISO9660_BLOCKSIZE_BITS, FSW_DNODE_TYPE_UNKNOWN,
+                              &name, child_dno_out);
     if (status == FSW_SUCCESS)
-        fsw_memcpy(&(*child_dno_out)->dirrec, dirrec, sizeof(struct iso9660_dirrec));
+        fsw_memcpy(&(*child_dno_out)->dirrec, &dirrec, sizeof(struct iso9660_dirrec));
+    return status;
+}
+
+/**
+ * Lookup a directory's child dnode by name. This function is called on a directory
+ * to retrieve the directory entry with the given name. A dnode is constructed for
+ * this entry and returned. The core makes sure that fsw_iso9660_dnode_fill has been called
+ * and the dnode is actually a directory.
+ *
+ * Without Rock Ridge, subdirectories are found in the path table. Everything else
+ * is found by binary search in the directory's name index.
+ */
+
+static fsw_status_t fsw_iso9660_dir_lookup(struct fsw_iso9660_volume *vol, struct fsw_iso9660_dnode *dno,
+                                           struct fsw_string *lookup_name, struct fsw_iso9660_dnode **child_dno_out)
+{
+    fsw_status_t    status;
+    struct fsw_string key;
+    struct fsw_iso9660_dirent *d;
+    fsw_u32         lo, hi, mid;
+
+    // Preconditions: The caller has checked that dno is a directory node.
+
+    // all names on the volume are ISO-8859-1, bring the lookup name into the same form
+    status = fsw_strdup_coerce(&key, FSW_STRING_TYPE_ISO88591, lookup_name);
+    if (status)
+        return status;
+
+    // Rock Ridge names are not in the path table, only use it on plain volumes
+    if (vol->pt != NULL && !vol->fRockRidge) {
+        status = fsw_iso9660_pt_lookup(vol, dno, &key, lookup_name, child_dno_out);
+        if (status != FSW_NOT_FOUND)
+            goto errorexit;
+    }
+
+    status = fsw_iso9660_dir_index(vol, dno);
+    if (status)
+        goto errorexit;
+
+    // binary search for the first entry with the name, then confirm with the exact comparison
+    lo = 0;
+    hi = dno->dirent_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        d = &dno->dirents[dno->dirents_by_name[mid]];
+        if (fsw_iso9660_namecmp(d->name.data, d->name.len, key.data, key.len) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    status = FSW_NOT_FOUND;
+    for (; lo < dno->dirent_count; lo++) {
+        d = &dno->dirents[dno->dirents_by_name[lo]];
+        if (fsw_iso9660_namecmp(d->name.data, d->name.len, key.data, key.len) != 0)
+            break;
+        if (fsw_streq(lookup_name, &d->name)) {  // TODO: compare case-insensitively
+            status = fsw_iso9660_dirent_dnode(dno, d, child_dno_out);
+            break;
+        }
+    }
 
 errorexit:
-    fsw_shandle_close(&shand);
+    fsw_strfree(&key);
     return status;
 }
 
@@ -549,43 +991,31 @@ static fsw_status_t fsw_iso9660_dir_read(struct fsw_iso9660_volume *vol, struct
                                          struct fsw_shandle *shand, struct fsw_iso9660_dnode **child_dno_out)
 {
     fsw_status_t    status;
-    struct iso9660_dirrec_buffer dirrec_buffer;
-    struct iso9660_dirrec *dirrec = &dirrec_buffer.dirrec;
+    fsw_u32         lo, hi, mid;
 
     // Preconditions: The caller has checked that dno is a directory node. The caller
     //  has opened a storage handle to the directory's storage and keeps it around between
     //  calls.
-    /* (vasily) directory nodes are 4096 bytes that is two logical blocks so read dir operation
-     * should read both blocks.
-     */
-
-    while (1) {
-        // read next entry
-        if (shand->pos >= dno->g.size)
-            return FSW_NOT_FOUND; // end of directory
-        status = fsw_iso9660_read_dirrec(vol, shand, &dirrec_buffer);
-        if (status)
-            return status;
-        if (dirrec->dirrec_length == 0)
-        {
-            // try the next block
-            shand->pos =(shand->pos & ~(vol->g.log_blocksize - 1)) + vol->g.log_blocksize;
-            continue;
-        }
 
-        // skip . and ..
-        if (dirrec->file_identifier_length == 1 &&
-            (dirrec->file_identifier[0] == 0 || dirrec->file_identifier[0] == 1))
-            continue;
-        break;
-    }
+    status = fsw_iso9660_dir_index(vol, dno);
+    if (status)
+        return status;
 
-    // setup a dnode for the child item
-    status = fsw_dnode_create(dno, dirrec_buffer.ino, FSW_DNODE_TYPE_UNKNOWN, &dirrec_buffer.name, child_dno_out);
-    if (status == FSW_SUCCESS)
-        fsw_memcpy(&(*child_dno_out)->dirrec, dirrec, sizeof(struct iso9660_dirrec));
+    // find the first entry at or behind the current position
+    lo = 0;
+    hi = dno->dirent_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (dno->dirents[mid].pos < shand->pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo >= dno->dirent_count)
+        return FSW_NOT_FOUND; // end of directory
 
-    return status;
+    shand->pos = dno->dirents[lo].next_pos;
+    return fsw_iso9660_dirent_dnode(dno, &dno->dirents[lo], child_dno_out);
 }
 
 /**
@@ -603,7 +1033,7 @@ static fsw_status_t fsw_iso9660_read_dirrec(struct fsw_iso9660_volume *vol, stru
     int sp_off;
     int rc;
 
-    dirrec_buffer->ino = (ISOINT(((struct fsw_iso9660_dnode *)shand->dnode)->dirrec.extent_location)
+    dirrec_buffer->ino = ((fsw_u64)ISOINT(((struct fsw_iso9660_dnode *)shand->dnode)->dirrec.extent_location)
                           << ISO9660_BLOCKSIZE_BITS)
         + (fsw_u32)shand->pos;
 
@@ -632,6 +1062,10 @@ static fsw_status_t fsw_iso9660_read_dirrec(struct fsw_iso9660_volume *vol, stru
         dirrec->dirrec_length < 33 + dirrec->file_identifier_length)
         return FSW_VOLUME_CORRUPTED;
 
+    // directories are numbered by their extent, so path table lookups yield the same dnode
+    if (dirrec->file_flags & 0x02)
+        dirrec_buffer->ino = (fsw_u64)ISOINT(dirrec->extent_location) << ISO9660_BLOCKSIZE_BITS;
+
 //    DEBUG((DEBUG_INFO, "%a:%d, dirrec_length: %d\n", __FILE__, __LINE__, dirrec->dirrec_length));
 
     // read variable size part of directory record
@@ -46,6 +46,8 @@
 //! Block size for ISO9660 volumes.
 #define ISO9660_BLOCKSIZE          2048
 #define ISO9660_BLOCKSIZE_BITS       11
+//! Upper limit for the path table size we are willing to keep in memory.
+#define ISO9660_PATH_TABLE_MAX     (4*1024*1024)
 //! Block number where the ISO9660 superblock resides.
 #define ISO9660_SUPERBLOCK_BLOCKNO   16
 //Slice - we already have shifted blockIO by 16
@@ -133,12 +135,35 @@ struct iso9660_primary_volume_descriptor {
 #pragma pack()
 
 struct iso9660_dirrec_buffer {
-    fsw_u32     ino;
+    fsw_u64     ino;
     struct fsw_string name;
     struct iso9660_dirrec dirrec;
     char        dirrec_buffer[222];
 };
 
+/**
+ * ISO9660: One directory from the path table, kept in memory after mount.
+ */
+
+struct fsw_iso9660_ptentry {
+    fsw_u32     extent_location;    //!< First block of the directory's extent
+    fsw_u32     parent;             //!< Path table index of the parent directory (0-based)
+    fsw_u8      *name;              //!< Directory identifier, points into the raw path table
+    fsw_u32     name_len;           //!< Length of the directory identifier
+};
+
+/**
+ * ISO9660: One entry of a directory's name index, built on first access.
+ */
+
+struct fsw_iso9660_dirent {
+    fsw_u64     ino;                //!< dnode id for the entry
+    fsw_u32     pos;                //!< Offset of the directory record in the directory
+    fsw_u32     next_pos;           //!< Offset just behind the directory record
+    struct fsw_string name;         //!< Decoded name (Rock Ridge name if present)
+    struct iso9660_dirrec dirrec;   //!< Fixed part of the directory record
+};
+
 
 /**
  * ISO9660: Volume structure with ISO9660-specific data.
@@ -154,6 +179,12 @@ struct fsw_iso9660_volume {
     int rr_susp_skip;
 
     struct iso9660_primary_volume_descriptor *primary_voldesc;  //!< Full Primary Volume Descriptor
+
+    fsw_u8      *path_table;        //!< Raw type L path table, NULL if not loaded
+    struct fsw_iso9660_ptentry *pt; //!< Parsed path table entries in on-disk order
+    fsw_u32     *pt_by_name;        //!< Entry indices sorted by parent and name
+    fsw_u32     *pt_by_extent;      //!< Entry indices sorted by extent location
+    fsw_u32     pt_count;           //!< Number of path table entries
 };
 
 /**
@@ -164,6 +195,11 @@ struct fsw_iso9660_dnode {
     struct fsw_dnode g;             //!< Generic dnode structure
 
     struct iso9660_dirrec dirrec;   //!< Fixed part of the directory record (i.e. w/o name)
+
+    int         indexed;            //!< Set once the name index below has been built
+    struct fsw_iso9660_dirent *dirents; //!< Directory entries in on-disk order
+    fsw_u32     *dirents_by_name;   //!< Entry indices sorted by name
+    fsw_u32     dirent_count;       //!< Number of directory entries
 };
 
 
@@ -23,6 +23,9 @@
 #include "fsw_core.h"
 
 #define Print(x...)	/* */
+#ifndef DPRINT
+#define DPRINT(x...)	/* */
+#endif
 
 static inline fsw_u8 GETU8(fsw_u8 *buf, int pos)
 {
@@ -102,6 +105,15 @@ struct extent_map
     int used;
 };
 
+#define MFT_CACHE_SIZE	32
+
+struct mft_cache_slot
+{
+    fsw_u64 mftno;		/* MFT no, BADMFT if unused */
+    fsw_u32 stamp;		/* last access, for LRU replacement */
+    fsw_u8 *buf;		/* fixed-up MFT record */
+};
+
 struct ntfs_mft
 {
     fsw_u64 mftno;		/* current MFT no */
@@ -119,10 +131,39 @@ struct ntfs_attr
     int type;			/* current attribute type */
 };
 
+#define IDX_CACHE_SIZE	8
+#define CUNIT_CACHE_SIZE	4
+
+struct ntfs_cunit
+{
+    fsw_u64 vcn;		/* first vcn of compress chunk, BADVCN if unused */
+    fsw_u32 stamp;		/* last access, for LRU replacement */
+    unsigned int full:1;	/* in-compressable chunk */
+    unsigned int zero:1;	/* empty chunk */
+    unsigned int error:1;	/* decompress error */
+    fsw_u64 lcn[16];		/* cluster map of compress chunk */
+    fsw_u8 *buf;		/* decompressed chunk */
+};
+
+struct ntfs_idxnode
+{
+    fsw_u64 block;		/* index block#, 0 for AT_INDEX_ROOT */
+    fsw_u32 stamp;		/* last access, for LRU replacement */
+    fsw_u8 *buf;		/* fixed-up index block, NULL for root */
+    fsw_u8 *data;		/* index node header */
+    int len;			/* valid size of index node */
+    int *ent;			/* offsets of index entries, end entry included */
+    int count;			/* number of entries */
+};
+
 struct fsw_ntfs_volume
 {
     struct fsw_volume g;
     struct extent_map extmap;	/* MFT extent map */
+    struct mft_cache_slot mftcache[MFT_CACHE_SIZE];	/* recently read MFT records */
+    fsw_u32 mftstamp;		/* MFT cache access counter */
+    fsw_u32 mfthits;		/* MFT cache hits */
+    fsw_u32 mftmisses;		/* MFT cache misses */
     fsw_u64 totalbytes;		/* volume size */
     const fsw_u16 *upcase;	/* upcase map for non-ascii */
     int upcount;		/* upcase map size */
@@ -140,23 +181,23 @@ struct fsw_ntfs_dnode
     struct ntfs_attr attr;	/* AT_INDEX_ALLOCATION:$I30/AT_DATA */
     fsw_u8 *idxroot;		/* AT_INDEX_ROOT:$I30 */
     fsw_u8 *idxbmp;		/* AT_BITMAP:$I30 */
+    struct ntfs_idxnode *idxcache;	/* decoded index nodes, slot 0 is AT_INDEX_ROOT */
+    fsw_u32 idxstamp;		/* index cache access counter */
     unsigned int embeded:1;	/* embeded AT_DATA */
     unsigned int has_idxtree:1;	/* valid AT_INDEX_ALLOCATION:$I30 */
     unsigned int compressed:1;	/* compressed AT_DATA */
     unsigned int unreadable:1;	/* unreadable/encrypted AT_DATA */
-    unsigned int cpfull:1;	/* in-compressable chunk */
-    unsigned int cpzero:1;	/* empty chunk */
-    unsigned int cperror:1;	/* decompress error */
     unsigned int islink:1;	/* is symlink: AT_REPARSE_POINT */
+    unsigned int has_runlist:1;	/* runlist decoded */
     int idxsz;			/* size of index block */
     int rootsz;			/* size of idxroot: AT_INDEX_ROOT:$I30 */
     int bmpsz;			/* size of idxbmp: AT_BITMAP:$I30 */
-    struct extent_slot cext;	/* cached extent */
+    struct extent_map runlist;	/* decoded runlist of attr, sorted by vcn, lcn 0 as sparse */
     fsw_u64 fsize;		/* logical file size */
     fsw_u64 finited;		/* initialized file size */
-    fsw_u64 cvcn;		/* vcn of compress chunk: cbuf */
-    fsw_u64 clcn[16];		/* cluster map of compress chunk */
-    fsw_u8 *cbuf;		/* compress chunk/index block/symlink target */
+    struct ntfs_cunit *cunits;	/* recently used compress chunks */
+    fsw_u32 cstamp;		/* compress chunk cache access counter */
+    fsw_u8 *cbuf;		/* symlink target */
 };
 
 static fsw_status_t fixup(fsw_u8 *record, char *magic, int sectorsize, int size)
@@ -454,7 +495,7 @@ static fsw_status_t load_atlist(struct fsw_ntfs_volume *vol, struct ntfs_mft *mf
     return read_attribute_direct(vol, ptr, len, &mft->atlst, &mft->atlen);
 }
 
-static fsw_status_t read_mft(struct fsw_ntfs_volume *vol, fsw_u8 *mft, fsw_u64 mftno)
+static fsw_status_t read_mft_direct(struct fsw_ntfs_volume *vol, fsw_u8 *mft, fsw_u64 mftno)
 {
     int l = 0;
     int r = vol->extmap.used - 1;
@@ -518,6 +559,69 @@ static fsw_status_t read_mft(struct fsw_ntfs_volume *vol, fsw_u8 *mft, fsw_u64 m
     return FSW_NOT_FOUND;
 }
 
+static void init_mft_cache(struct fsw_ntfs_volume *vol)
+{
+    int i;
+    for(i=0; i<MFT_CACHE_SIZE; i++) {
+	vol->mftcache[i].mftno = BADMFT;
+	vol->mftcache[i].stamp = 0;
+	vol->mftcache[i].buf = NULL;
+    }
+    vol->mftstamp = 0;
+    vol->mfthits = 0;
+    vol->mftmisses = 0;
+}
+
+static void free_mft_cache(struct fsw_ntfs_volume *vol)
+{
+    int i;
+    DPRINT(L"MFT cache: %d hits %d misses\n", vol->mfthits, vol->mftmisses);
+    for(i=0; i<MFT_CACHE_SIZE; i++) {
+	if(vol->mftcache[i].buf)
+	    fsw_free(vol->mftcache[i].buf);
+	vol->mftcache[i].buf = NULL;
+	vol->mftcache[i].mftno = BADMFT;
+    }
+}
+
+/* read a fixed-up MFT record, served from the per-volume record cache if possible */
+static fsw_status_t read_mft(struct fsw_ntfs_volume *vol, fsw_u8 *mft, fsw_u64 mftno)
+{
+    struct mft_cache_slot *slot, *victim;
+    fsw_status_t err;
+    int i;
+
+    victim = &vol->mftcache[0];
+    for(i=0; i<MFT_CACHE_SIZE; i++) {
+	slot = &vol->mftcache[i];
+	if(slot->mftno == mftno) {
+	    vol->mfthits++;
+	    slot->stamp = ++vol->mftstamp;
+	    fsw_memcpy(mft, slot->buf, 1<<vol->mftbits);
+	    return FSW_SUCCESS;
+	}
+	/* prefer an unused slot, otherwise the least recently used one */
+	if(slot->mftno == BADMFT) {
+	    if(victim->mftno != BADMFT)
+		victim = slot;
+	} else if(victim->mftno != BADMFT && slot->stamp < victim->stamp) {
+	    victim = slot;
+	}
+    }
+
+    vol->mftmisses++;
+    err = read_mft_direct(vol, mft, mftno);
+    if(err != FSW_SUCCESS)
+	return err;
+
+    if(victim->buf == NULL && fsw_alloc(1<<vol->mftbits, &victim->buf) != FSW_SUCCESS)
+	return FSW_SUCCESS;	/* just don't cache it */
+    fsw_memcpy(victim->buf, mft, 1<<vol->mftbits);
+    victim->mftno = mftno;
+    victim->stamp = ++vol->mftstamp;
+    return FSW_SUCCESS;
+}
+
 static void init_attr(struct fsw_ntfs_volume *vol, struct ntfs_attr *attr, int type)
 {
     fsw_memzero(attr, sizeof(*attr));
@@ -642,6 +746,18 @@ static int tobits(fsw_u32 val)
     return 31 - __builtin_clz(val);
 }
 
+static fsw_status_t fsw_ntfs_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t err;
+    fsw_u8 oemid[8];
+
+    if ((err = read(host_data, 3, sizeof(oemid), oemid)) != FSW_SUCCESS)
+        return err;
+    if (!fsw_memeq(oemid, "NTFS    ", 8))
+        return FSW_UNSUPPORTED;
+    return FSW_SUCCESS;
+}
+
 static fsw_status_t fsw_ntfs_volume_mount(struct fsw_volume *volg)
 {
     struct fsw_ntfs_volume *vol = (struct fsw_ntfs_volume *)volg;
@@ -653,6 +769,8 @@ static fsw_status_t fsw_ntfs_volume_mount(struct fsw_volume *volg)
     fsw_u64 mft_start[2];
     struct ntfs_mft mft0;
 
+    init_mft_cache(vol);
+    volg->lookup_ignores_case = 1;    // dir_lookup compares upcased names
     fsw_set_blocksize(volg, 512, 512);
     if ((err = fsw_block_get(volg, 0, 0, (void **)&buffer)) != FSW_SUCCESS)
 	return FSW_UNSUPPORTED;
@@ -765,6 +883,7 @@ static void fsw_ntfs_volume_free(struct fsw_volume *volg)
     struct fsw_ntfs_volume *vol = (struct fsw_ntfs_volume *)volg;
     if(vol->extmap.extent)
 	fsw_free(vol->extmap.extent);
+    free_mft_cache(vol);
     if(vol->upcase && vol->upcase != upcase)
 	fsw_free((void *)vol->upcase);
 }
@@ -783,10 +902,35 @@ static void fsw_ntfs_dnode_free(struct fsw_volume *vol, struct fsw_dnode *dnog)
     struct fsw_ntfs_dnode *dno = (struct fsw_ntfs_dnode *)dnog;
     free_mft(&dno->mft);
     free_attr(&dno->attr);
+    if(dno->runlist.extent) {
+	fsw_free(dno->runlist.extent);
+	dno->runlist.extent = NULL;
+	dno->runlist.total = dno->runlist.used = 0;
+    }
+    dno->has_runlist = 0;
     if(dno->idxroot)
 	fsw_free(dno->idxroot);
     if(dno->idxbmp)
 	fsw_free(dno->idxbmp);
+    if(dno->idxcache) {
+	int i;
+	for(i=0; i<IDX_CACHE_SIZE; i++) {
+	    if(dno->idxcache[i].buf)
+		fsw_free(dno->idxcache[i].buf);
+	    if(dno->idxcache[i].ent)
+		fsw_free(dno->idxcache[i].ent);
+	}
+	fsw_free(dno->idxcache);
+	dno->idxcache = NULL;
+    }
+    if(dno->cunits) {
+	int i;
+	for(i=0; i<CUNIT_CACHE_SIZE; i++)
+	    if(dno->cunits[i].buf)
+		fsw_free(dno->cunits[i].buf);
+	fsw_free(dno->cunits);
+	dno->cunits = NULL;
+    }
     if(dno->cbuf)
 	fsw_free(dno->cbuf);
 }
@@ -881,7 +1025,6 @@ static fsw_status_t fsw_ntfs_dnode_fill(struct fsw_volume *volg, struct fsw_dnod
 	    dno->unreadable = 1;
 	else if(attribute_compressed(dno->attr.ptr, dno->attr.len))
 	    dno->compressed = 1;
-	dno->cvcn = BADVCN;
 	dno->g.size = dno->fsize;
     }
     return FSW_SUCCESS;
@@ -937,46 +1080,126 @@ static fsw_status_t fsw_ntfs_dnode_stat(struct fsw_volume *volg, struct fsw_dnod
     return FSW_SUCCESS;
 }
 
-static fsw_status_t fsw_ntfs_dnode_get_lcn(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u64 vcn, fsw_u64 *lcnp)
+static fsw_status_t add_run(struct extent_map *map, fsw_u64 vcn, fsw_u64 lcn, fsw_u64 cnt)
+{
+    int u = map->used;
+    if(u > 0) {
+	struct extent_slot *p = &map->extent[u-1];
+	if(p->vcn + p->cnt == vcn &&
+		((p->lcn == 0 && lcn == 0) || (p->lcn && lcn && p->lcn + p->cnt == lcn))) {
+	    p->cnt += cnt;
+	    return FSW_SUCCESS;
+	}
+    }
+    if(u >= map->total) {
+	struct extent_slot *e;
+	int total = map->extent ? u*2 : 16;
+	if(fsw_alloc(total * sizeof(struct extent_slot), &e)!=FSW_SUCCESS)
+	    return FSW_OUT_OF_MEMORY;
+	if(map->extent) {
+	    fsw_memcpy(e, map->extent, u*sizeof(struct extent_slot));
+	    fsw_free(map->extent);
+	}
+	map->extent = e;
+	map->total = total;
+    }
+    map->extent[u].vcn = vcn;
+    map->extent[u].lcn = lcn;
+    map->extent[u].cnt = cnt;
+    map->used++;
+    return FSW_SUCCESS;
+}
+
+/*
+ * decode the complete runlist of a non-resident attribute, following all
+ * AT_ATTRIBUTE_LIST fragments in vcn order, so that later lookups never
+ * touch the mapping pairs again.
+ */
+static fsw_status_t load_runlist(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno)
 {
     fsw_status_t err;
-    if(vcn >= dno->cext.vcn && vcn < dno->cext.vcn+dno->cext.cnt) {
-	*lcnp = dno->cext.lcn + vcn - dno->cext.vcn;
-	return FSW_SUCCESS;
+    fsw_u64 vcn = 0;
+
+    for(;;) {
+	if(!attribute_has_vcn(dno->attr.ptr, dno->attr.len, vcn)) {
+	    err = find_attribute(vol, &dno->mft, &dno->attr, vcn);
+	    if(err == FSW_NOT_FOUND)
+		break;
+	    if(err != FSW_SUCCESS)
+		return err;
+	    if(!attribute_has_vcn(dno->attr.ptr, dno->attr.len, vcn))
+		break;
+	}
+	fsw_u8 *ptr = dno->attr.ptr;
+	int len = dno->attr.len;
+	fsw_u64 pos = 0;
+	fsw_u64 lcn, cnt;
+	fsw_u64 svcn = attribute_first_vcn(ptr, len);
+	fsw_u64 evcn = attribute_last_vcn(ptr, len) + 1;
+	if(evcn <= svcn)
+	    break;		/* empty attribute */
+	if(svcn != vcn)
+	    return FSW_VOLUME_CORRUPTED;
+	int off = GETU16(ptr, 0x20);
+	ptr += off;
+	len -= off;
+	while(len > 0 && svcn < evcn && get_extent(&ptr, &len, &lcn, &cnt, &pos)==FSW_SUCCESS) {
+	    if(cnt > evcn - svcn)
+		cnt = evcn - svcn;
+	    if((err = add_run(&dno->runlist, svcn, lcn, cnt)) != FSW_SUCCESS)
+		return err;
+	    svcn += cnt;
+	}
+	vcn = evcn;
     }
-    if(!attribute_has_vcn(dno->attr.ptr, dno->attr.len, vcn)) {
-	err = find_attribute(vol, &dno->mft, &dno->attr, vcn);
-	if( err != FSW_SUCCESS )
+    dno->has_runlist = 1;
+    return FSW_SUCCESS;
+}
+
+/*
+ * map vcn to lcn, *cntp gets the number of clusters left in the run.
+ * sparse runs return FSW_NOT_FOUND with *cntp set.
+ */
+static fsw_status_t fsw_ntfs_dnode_get_run(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u64 vcn, fsw_u64 *lcnp, fsw_u64 *cntp)
+{
+    fsw_status_t err;
+    if(!dno->has_runlist) {
+	err = load_runlist(vol, dno);
+	if(err != FSW_SUCCESS) {
+	    dno->runlist.used = 0;
 	    return err;
-	if(!attribute_has_vcn(dno->attr.ptr, dno->attr.len, vcn))
-	    return FSW_VOLUME_CORRUPTED;
+	}
     }
-    fsw_u8 *ptr = dno->attr.ptr;
-    int len = dno->attr.len;
-    fsw_u64 pos = 0;
-    fsw_u64 lcn, cnt;
-    fsw_u64 svcn = attribute_first_vcn(ptr, len);
-    fsw_u64 evcn = attribute_last_vcn(ptr, len) + 1;
-    int off = GETU16(ptr, 0x20);
-    ptr += off;
-    len -= off;
-    while(len > 0 && get_extent(&ptr, &len, &lcn, &cnt, &pos)==FSW_SUCCESS) {
-	if(vcn >= svcn && vcn < svcn+cnt) {
-	    dno->cext.vcn = svcn;
-	    dno->cext.lcn = lcn;
-	    dno->cext.cnt = cnt;
-	    if(lcn == 0)
+
+    int l = 0;
+    int r = dno->runlist.used - 1;
+    int m;
+    struct extent_slot *e = dno->runlist.extent;
+
+    *cntp = 1;
+    while(l <= r) {
+	m = (l+r)/2;
+	if(vcn < e[m].vcn) {
+	    r = m - 1;
+	} else if(vcn >= e[m].vcn + e[m].cnt) {
+	    l = m + 1;
+	} else {
+	    *cntp = e[m].cnt - (vcn - e[m].vcn);
+	    if(e[m].lcn == 0)
 		return FSW_NOT_FOUND;
-	    *lcnp = lcn + vcn - svcn;
+	    *lcnp = e[m].lcn + (vcn - e[m].vcn);
 	    return FSW_SUCCESS;
 	}
-	svcn += cnt;
-	if(svcn >= evcn)
-	    break;
     }
     return FSW_NOT_FOUND;
 }
 
+static fsw_status_t fsw_ntfs_dnode_get_lcn(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u64 vcn, fsw_u64 *lcnp)
+{
+    fsw_u64 cnt;
+    return fsw_ntfs_dnode_get_run(vol, dno, vcn, lcnp, &cnt);
+}
+
 static int fsw_ntfs_read_buffer(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u8 *buf, fsw_u64 offset, int size)
 {
     if(dno->embeded) {
@@ -1075,6 +1298,13 @@ static int ntfs_decomp_1page(fsw_u8 *src, int slen, fsw_u8 *dst) {
     while(soff < slen) {
 	int j;
 	int tag = src[soff++];
+	if(tag == 0 && soff + 8 <= slen && doff + 8 <= 0x1000) {
+	    /* eight literals in a row, copy them as one word */
+	    *(fsw_u64 *)(dst+doff) = *(fsw_u64 *)(src+soff);
+	    soff += 8;
+	    doff += 8;
+	    continue;
+	}
 	for(j = 0; j < 8 && soff < slen; j++) {
 	    if(tag & (1<<j)){
 		int len;
@@ -1084,11 +1314,21 @@ static int ntfs_decomp_1page(fsw_u8 *src, int slen, fsw_u8 *dst) {
 		if(!doff || soff + 2 > slen)
 		    return -1;
 		len = GETU16(src, soff); soff += 2;
-		bits = __builtin_clz((doff-1)>>3)-19;
+		bits = __builtin_clz(((doff-1)>>3)|1)-19;
 		back = (len >> bits) + 1;
 		len = (len & ((1<<bits)-1)) + 3;
 		if(doff < back || doff + len > 0x1000)
 		    return -1;
+		if(back >= 8) {
+		    /* source and destination words never overlap */
+		    for(; len >= 8; len -= 8, doff += 8)
+			*(fsw_u64 *)(dst+doff) = *(fsw_u64 *)(dst+doff-back);
+		} else if(back == 1) {
+		    /* run of a single byte */
+		    fsw_u8 c = dst[doff-1];
+		    while(len-- > 0)
+			dst[doff++] = c;
+		}
 		while(len-- > 0) {
 		    dst[doff] = dst[doff-back];
 		    doff++;
@@ -1135,6 +1375,28 @@ static int ntfs_decomp(fsw_u8 *src, int slen, fsw_u8 *dst, int npage) {
     return 0;
 }
 
+/* find a compress chunk in the per-dnode LRU, or the slot to load it into */
+static struct ntfs_cunit *fsw_ntfs_find_cunit(struct fsw_ntfs_dnode *dno, fsw_u64 vcn, int *hit)
+{
+    struct ntfs_cunit *cu, *victim;
+    int i;
+
+    victim = &dno->cunits[0];
+    for(i=0; i<CUNIT_CACHE_SIZE; i++) {
+	cu = &dno->cunits[i];
+	if(cu->vcn == vcn) {
+	    *hit = 1;
+	    cu->stamp = ++dno->cstamp;
+	    return cu;
+	}
+	if(cu->stamp < victim->stamp)
+	    victim = cu;
+    }
+    *hit = 0;
+    victim->stamp = ++dno->cstamp;
+    return victim;
+}
+
 static fsw_status_t fsw_ntfs_get_extent_compressed(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, struct fsw_extent *extent)
 {
     if(vol->clbits > 16)
@@ -1143,78 +1405,88 @@ static fsw_status_t fsw_ntfs_get_extent_compressed(struct fsw_ntfs_volume *vol,
     if((extent->log_start << vol->clbits) > dno->fsize)
 	return FSW_NOT_FOUND;
 
-    int i;
+    int i, hit;
     fsw_u64 vcn = extent->log_start & ~15;
+    struct ntfs_cunit *cu;
+
+    if(dno->cunits == NULL) {
+	fsw_status_t err = fsw_alloc_zero(CUNIT_CACHE_SIZE * sizeof(struct ntfs_cunit), (void **)&dno->cunits);
+	if(err != FSW_SUCCESS)
+	    return err;
+	for(i=0; i<CUNIT_CACHE_SIZE; i++)
+	    dno->cunits[i].vcn = BADVCN;
+    }
 
-    if(vcn == dno->cvcn)
+    cu = fsw_ntfs_find_cunit(dno, vcn, &hit);
+    if(hit)
 	goto hit;
-    dno->cvcn = vcn;
-    dno->cperror = 0;
-    dno->cpfull = 0;
-    dno->cpzero = 0;
+    cu->vcn = vcn;
+    cu->error = 0;
+    cu->full = 0;
+    cu->zero = 0;
 
     for(i=0; i<16; i++) {
 	fsw_status_t err;
-	err = fsw_ntfs_dnode_get_lcn(vol, dno, vcn+i, &dno->clcn[i]);
+	err = fsw_ntfs_dnode_get_lcn(vol, dno, vcn+i, &cu->lcn[i]);
 	if(err == FSW_NOT_FOUND) {
 	    break;
 	} else if(err != FSW_SUCCESS) {
 	    Print(L"BAD LCN\n");
-	    dno->cperror = 1;
+	    cu->error = 1;
 	    return FSW_VOLUME_CORRUPTED;
 	}
     }
     if(i == 0)
-	dno->cpzero = 1;
+	cu->zero = 1;
     else if(i==16)
-	dno->cpfull = 1;
+	cu->full = 1;
     else {
 	fsw_status_t err;
-	if(dno->cbuf == NULL) {
-	    err = fsw_alloc(16<<vol->clbits, &dno->cbuf);
+	if(cu->buf == NULL) {
+	    err = fsw_alloc(16<<vol->clbits, &cu->buf);
 	    if(err != FSW_SUCCESS) {
-		dno->cvcn = BADVCN;
+		cu->vcn = BADVCN;
 		return err;
 	    }
 	}
 	fsw_u8 *src;
 	err = fsw_alloc(i << vol->clbits, &src);
 	if(err != FSW_SUCCESS) {
-	    dno->cvcn = BADVCN;
+	    cu->vcn = BADVCN;
 	    return err;
 	}
 	int b;
 	for(b=0; b<i; b++) {
 	    char *block;
-	    if (fsw_block_get(&vol->g, dno->clcn[b], 0, (void **)&block) != FSW_SUCCESS) {
-		dno->cperror = 1;
+	    if (fsw_block_get(&vol->g, cu->lcn[b], 0, (void **)&block) != FSW_SUCCESS) {
+		cu->error = 1;
 		Print(L"Read ERROR at block %d\n", i);
 		break;
 	    }
 	    fsw_memcpy(src+(b<<vol->clbits), block, 1<<vol->clbits);
-	    fsw_block_release(&vol->g, dno->clcn[b], block);
+	    fsw_block_release(&vol->g, cu->lcn[b], block);
 	}
 
 	if(dno->fsize >= ((vcn+16)<<vol->clbits))
 	    b = 16<<vol->clbits>>12;
 	else
 	    b = (dno->fsize - (vcn << vol->clbits) + 0xfff)>>12;
-	if(!dno->cperror && ntfs_decomp(src, i<<vol->clbits, dno->cbuf, b) < 0)
-	    dno->cperror = 1;
+	if(!cu->error && ntfs_decomp(src, i<<vol->clbits, cu->buf, b) < 0)
+	    cu->error = 1;
 	fsw_free(src);
     }
 hit:
-    if(dno->cperror)
+    if(cu->error)
 	return FSW_VOLUME_CORRUPTED;
     i = extent->log_start - vcn;
-    if(dno->cpfull) {
-	fsw_u64 lcn = dno->clcn[i];
+    if(cu->full) {
+	fsw_u64 lcn = cu->lcn[i];
 	extent->phys_start = lcn;
 	extent->log_count = 1;
 	extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
-	for(i++, lcn++; i<16 && lcn==dno->clcn[i]; i++, lcn++)
+	for(i++, lcn++; i<16 && lcn==cu->lcn[i]; i++, lcn++)
 		extent->log_count++;
-    } else if(dno->cpzero) {
+    } else if(cu->zero) {
 	extent->log_count = 16 - i;
 	extent->buffer = NULL;
 	extent->type = FSW_EXTENT_TYPE_SPARSE;
@@ -1222,7 +1494,7 @@ hit:
 	extent->log_count = 1;
 	fsw_status_t err = fsw_alloc(1<<vol->clbits, &extent->buffer);
 	if(err != FSW_SUCCESS) return err;
-	fsw_memcpy(extent->buffer, dno->cbuf + (i<<vol->clbits), 1<<vol->clbits);
+	fsw_memcpy(extent->buffer, cu->buf + (i<<vol->clbits), 1<<vol->clbits);
 	extent->type = FSW_EXTENT_TYPE_BUFFER;
     }
     return FSW_SUCCESS;
@@ -1241,10 +1513,12 @@ static fsw_status_t fsw_ntfs_get_extent_sparse(struct fsw_ntfs_volume *vol, stru
 	extent->type = FSW_EXTENT_TYPE_SPARSE;
 	return FSW_SUCCESS;
     }
-    fsw_u64 lcn;
-    err = fsw_ntfs_dnode_get_lcn(vol, dno, extent->log_start, &lcn);
+    fsw_u64 lcn, cnt = 1;
+    err = fsw_ntfs_dnode_get_run(vol, dno, extent->log_start, &lcn, &cnt);
+    if(cnt > 0x10000)
+	cnt = 0x10000;
     if(err == FSW_NOT_FOUND) {
-	extent->log_count = 1;
+	extent->log_count = cnt;
 	extent->buffer = NULL;
 	extent->type = FSW_EXTENT_TYPE_SPARSE;
 	return FSW_SUCCESS;
@@ -1252,9 +1526,7 @@ static fsw_status_t fsw_ntfs_get_extent_sparse(struct fsw_ntfs_volume *vol, stru
     if(err != FSW_SUCCESS)
 	return err;
     extent->phys_start = lcn;
-    extent->log_count = 1;
-    if(extent->log_start >= dno->cext.vcn && extent->log_start < dno->cext.vcn+dno->cext.cnt)
-	extent->log_count = dno->cext.cnt + extent->log_start - dno->cext.vcn;
+    extent->log_count = cnt;
     extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
     return FSW_SUCCESS;
 }
@@ -1293,30 +1565,44 @@ static fsw_status_t load_upcase(struct fsw_ntfs_volume *vol)
     return err;
 }
 
+static fsw_u16 ntfs_upcase_char(struct fsw_ntfs_volume *vol, fsw_u16 c)
+{
+    if(c < 0x80)
+	return upcase[c];
+    /*
+     * Only load upcase table when an international char is met.
+     * We assume international char never upcased to ASCII.
+     */
+    if(!vol->upcase) {
+	load_upcase(vol);
+	if(!vol->upcase) {
+	    /* use raw value & prevent load again */
+	    vol->upcase = upcase;
+	    vol->upcount = 0;
+	}
+    }
+    if(c < vol->upcount)
+	c = vol->upcase[c];
+    return c;
+}
+
+/* upcase an UTF16-LE name in place, done once for a lookup key */
+static void ntfs_upcase_name(struct fsw_ntfs_volume *vol, fsw_u8 *p, int s)
+{
+    for(; s > 0; p+=2, s--)
+	*(fsw_u16 *)p = fsw_u16_le_swap(ntfs_upcase_char(vol, GETU16(p, 0)));
+}
+
+/* compare an upcased key against an on-disk name */
 static int ntfs_filename_cmp(struct fsw_ntfs_volume *vol, fsw_u8 *p1, int s1, fsw_u8 *p2, int s2)
 {
     while(s1 > 0 && s2 > 0) {
 	fsw_u16 c1 = GETU16(p1,0);
 	fsw_u16 c2 = GETU16(p2,0);
-	if(c1 < 0x80 || c2 < 0x80) {
-	    if(c1 < 0x80) c1 = upcase[c1];
-	    if(c2 < 0x80) c2 = upcase[c2];
-	} else {
-	    /*
-	     * Only load upcase table if both char is international.
-	     * We assume international char never upcased to ASCII.
-	     */
-	    if(!vol->upcase) {
-		load_upcase(vol);
-		if(!vol->upcase) {
-		    /* use raw value & prevent load again */
-		    vol->upcase = upcase;
-		    vol->upcount = 0;
-		}
-	    }
-	    if(c1 < vol->upcount) c1 = vol->upcase[c1];
-	    if(c2 < vol->upcount) c2 = vol->upcase[c2];
-	}
+	if(c2 < 0x80)
+	    c2 = upcase[c2];
+	else if(c1 >= 0x80)
+	    c2 = ntfs_upcase_char(vol, c2);
 	if(c1 < c2)
 	    return -1;
 	if(c1 > c2)
@@ -1349,33 +1635,108 @@ static fsw_status_t fsw_ntfs_create_subnode(struct fsw_ntfs_dnode *dno, fsw_u8 *
     return fsw_dnode_create(&dno->g, mftno, type, &s, child_dno);
 }
 
-static fsw_u8 *fsw_ntfs_read_index_block(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u64 block)
+/* record the offsets of all entries of an index node, end entry included */
+static fsw_status_t fsw_ntfs_parse_index_node(struct ntfs_idxnode *node, fsw_u8 *data, int len)
 {
-    if(dno->cbuf==NULL) {
-	if(fsw_alloc(dno->idxsz, &dno->cbuf) != FSW_SUCCESS)
-	    return NULL;
-    } else if(block == dno->cvcn)
-	return dno->cbuf;
+    int off, max;
+
+    /* size the offset table for the whole buffer, the cache slot is reused for other blocks */
+    max = len / 0x10 + 1;
+    if(node->ent == NULL && fsw_alloc(max * sizeof(int), &node->ent) != FSW_SUCCESS)
+	return FSW_OUT_OF_MEMORY;
+
+    /* real index size */
+    if(GETU32(data, 4) < len)
+	len = GETU32(data, 4);
+    node->data = data;
+    node->len = len;
+    node->count = 0;
+
+    /* skip index header */
+    off = GETU32(data, 0);
+    while(off + 0x18 <= len && node->count < max) {
+	int n = GETU16(data, off+8);
+	node->ent[node->count++] = off;
+	if(GETU8(data, off+12) & 2)
+	    break;
+	if(n < 0x10)
+	    return FSW_VOLUME_CORRUPTED;
+	off += n;
+    }
+    return FSW_SUCCESS;
+}
 
-    dno->cvcn = BADVCN;
-    if(fsw_ntfs_read_buffer(vol, dno, dno->cbuf, (block-1)*dno->idxsz, dno->idxsz) != dno->idxsz)
-	return NULL;
-    if(fixup(dno->cbuf, "INDX", 1<<vol->sctbits, dno->idxsz) != FSW_SUCCESS)
-	return NULL;
+/* get a decoded index node, AT_INDEX_ROOT for block 0, from the per-dnode cache */
+static fsw_status_t fsw_ntfs_get_index_node(struct fsw_ntfs_volume *vol, struct fsw_ntfs_dnode *dno, fsw_u64 block, struct ntfs_idxnode **out)
+{
+    struct ntfs_idxnode *node, *victim;
+    fsw_status_t err;
+    int i;
+
+    if(dno->idxcache == NULL) {
+	err = fsw_alloc_zero(IDX_CACHE_SIZE * sizeof(struct ntfs_idxnode), (void **)&dno->idxcache);
+	if(err != FSW_SUCCESS)
+	    return err;
+	for(i=0; i<IDX_CACHE_SIZE; i++)
+	    dno->idxcache[i].block = BADVCN;
+	node = &dno->idxcache[0];
+	if(dno->rootsz - 16 < 0x18)
+	    return FSW_NOT_FOUND;
+	err = fsw_ntfs_parse_index_node(node, dno->idxroot + 16, dno->rootsz - 16);
+	if(err != FSW_SUCCESS)
+	    return err;
+	node->block = 0;
+    }
+
+    if(block == 0) {
+	node = &dno->idxcache[0];
+	if(node->block != 0)
+	    return FSW_NOT_FOUND;
+	*out = node;
+	return FSW_SUCCESS;
+    }
 
-    dno->cvcn = block;
-    return dno->cbuf;
+    victim = &dno->idxcache[1];
+    for(i=1; i<IDX_CACHE_SIZE; i++) {
+	node = &dno->idxcache[i];
+	if(node->block == block) {
+	    node->stamp = ++dno->idxstamp;
+	    *out = node;
+	    return FSW_SUCCESS;
+	}
+	if(node->stamp < victim->stamp)
+	    victim = node;
+    }
+
+    node = victim;
+    node->block = BADVCN;
+    if(node->buf == NULL) {
+	err = fsw_alloc(dno->idxsz, &node->buf);
+	if(err != FSW_SUCCESS)
+	    return err;
+    }
+    if(fsw_ntfs_read_buffer(vol, dno, node->buf, (block-1)*dno->idxsz, dno->idxsz) != dno->idxsz)
+	return FSW_VOLUME_CORRUPTED;
+    err = fixup(node->buf, "INDX", 1<<vol->sctbits, dno->idxsz);
+    if(err != FSW_SUCCESS)
+	return err;
+    err = fsw_ntfs_parse_index_node(node, node->buf + 24, dno->idxsz - 24);
+    if(err != FSW_SUCCESS)
+	return err;
+
+    node->block = block;
+    node->stamp = ++dno->idxstamp;
+    *out = node;
+    return FSW_SUCCESS;
 }
 
 static fsw_status_t fsw_ntfs_dir_lookup(struct fsw_volume *volg, struct fsw_dnode *dnog, struct fsw_string *lookup_name, struct fsw_dnode **child_dno)
 {
     struct fsw_ntfs_volume *vol = (struct fsw_ntfs_volume *)volg;
     struct fsw_ntfs_dnode *dno = (struct fsw_ntfs_dnode *)dnog;
+    struct ntfs_idxnode *node;
     int depth = 0;
     struct fsw_string s;
-    fsw_u8 *buf;
-    int len;
-    int off;
     fsw_status_t err;
     fsw_u64 block;
     fsw_u8 cpb;
@@ -1384,66 +1745,54 @@ static fsw_status_t fsw_ntfs_dir_lookup(struct fsw_volume *volg, struct fsw_dnod
     err = fsw_strdup_coerce(&s, FSW_STRING_TYPE_UTF16_LE, lookup_name);
     if(err)
 	return err;
-
-    /* start from AT_INDEX_ROOT */
-    buf = dno->idxroot + 16;
-    len = dno->rootsz - 16;
-    if(len < 0x18)
-	goto notfound;
+    ntfs_upcase_name(vol, s.data, s.len);
 
     cpb = GETU8(dno->idxroot, 12);
     if(cpb == 0) cpb = 1;
 
+    /* start from AT_INDEX_ROOT */
+    block = 0;
     while(depth < 10) {
-	/* real index size */
-	if(GETU32(buf, 4) < len)
-	    len = GETU32(buf, 4);
-
-	/* skip index header */
-	off = GETU32(buf, 0);
-	if(off >= len)
-	    goto notfound;
-
-	block = 0;
-	while(off + 0x18 <= len) {
-	    int flag = GETU8(buf, off+12);
-	    int next = off + GETU16(buf, off+8);
-	    int cmp;
-
-	    if(flag & 2) {
-		/* the end of index entry */
-		cmp = -1;
-		Print(L"depth %d len %x off %x flag %x next %x cmp %d\n", depth, len, off, flag, next, cmp);
-	    } else {
-		int nlen = GETU8(buf, off+0x50);
-		fsw_u8 *name = buf+off+0x52;
-		cmp = ntfs_filename_cmp(vol, s.data, s.len, name, nlen);
-		Print(L"depth %d len %x off %x flag %x next %x cmp %d name %d[%.*ls]\n", depth, len, off, flag, next, cmp, nlen, nlen, name);
-	    }
+	int lo, hi, names;
+	fsw_u8 *buf;
 
+	if(fsw_ntfs_get_index_node(vol, dno, block, &node) != FSW_SUCCESS)
+	    break;
+	buf = node->data;
+
+	/* binary search the named entries, the end entry sorts after all */
+	names = node->count;
+	if(names > 0 && (GETU8(buf, node->ent[names-1]+12) & 2))
+	    names--;
+	lo = 0;
+	hi = names;
+	while(lo < hi) {
+	    int mid = (lo + hi) / 2;
+	    int off = node->ent[mid];
+	    int nlen = GETU8(buf, off+0x50);
+	    int cmp = ntfs_filename_cmp(vol, s.data, s.len, buf+off+0x52, nlen);
 	    if(cmp == 0) {
 		fsw_strfree(&s);
 		return fsw_ntfs_create_subnode(dno, buf+off, child_dno);
-	    } else if(cmp < 0) {
-		if(!(flag & 1) || !dno->has_idxtree)
-		    goto notfound;
-		block = FSW_U64_DIV(GETU64(buf, next-8), cpb) + 1;
-		break;
-	    } else { /* cmp > 0 */
-		off = next;
 	    }
+	    if(cmp < 0)
+		hi = mid;
+	    else
+		lo = mid + 1;
 	}
-	if(!block)
-	    break;
 
-	if(!(buf = fsw_ntfs_read_index_block(vol, dno, block)))
+	/* descend into the subnode left of the first greater entry */
+	if(lo >= node->count)
+	    break;
+	int off = node->ent[lo];
+	int flag = GETU8(buf, off+12);
+	int next = off + GETU16(buf, off+8);
+	if(!(flag & 1) || !dno->has_idxtree)
 	    break;
-	buf += 24;
-	len = dno->idxsz - 24;
+	block = FSW_U64_DIV(GETU64(buf, next-8), cpb) + 1;
 	depth++;
     }
 
-notfound:
     fsw_strfree(&s);
     return FSW_NOT_FOUND;
 }
@@ -1484,25 +1833,19 @@ static fsw_status_t fsw_ntfs_dir_read(struct fsw_volume *volg, struct fsw_dnode
     mblocks = FSW_U64_DIV(dno->fsize, dno->idxsz);
 
     while(block <= mblocks) {
+	struct ntfs_idxnode *node;
 	fsw_u8 *buf;
 	int len;
-	if(block == 0) {
-	    /* AT_INDEX_ROOT */
-	    buf = dno->idxroot + 16;
-	    len = dno->rootsz - 16;
-	    if(len < 0x18)
-		goto miss;
-	} else if(!test_idxbmp(dno, block) || !(buf = fsw_ntfs_read_index_block(vol, dno, block)))
+	if(block > 0 && !test_idxbmp(dno, block))
 	{
-	    /* unused or bad index block */
+	    /* unused index block */
+	    goto miss;
+	} else if(fsw_ntfs_get_index_node(vol, dno, block, &node) != FSW_SUCCESS) {
+	    /* bad AT_INDEX_ROOT or AT_INDEX_ALLOCATION block */
 	    goto miss;
-	} else {
-	    /* AT_INDEX_ALLOCATION block */
-	    buf += 24;
-	    len = dno->idxsz - 24;
 	}
-	if(GETU32(buf, 4) < len)
-	    len = GETU32(buf, 4);
+	buf = node->data;
+	len = node->len;
 	if(off == 0)
 	    off = GETU32(buf, 0);
 	Print(L"block %d len %x off %x\n", block, len, off);
@@ -1586,6 +1929,7 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(ntfs) = {
     fsw_ntfs_dir_lookup,
     fsw_ntfs_dir_read,
     fsw_ntfs_readlink,
+    fsw_ntfs_volume_sniff,
 };
 
 // EOF
@@ -26,6 +26,7 @@
 
 // functions
 
+static fsw_status_t fsw_reiserfs_volume_sniff(void *host_data, fsw_sniff_read_t read);
 static fsw_status_t fsw_reiserfs_volume_mount(struct fsw_reiserfs_volume *vol);
 static void         fsw_reiserfs_volume_free(struct fsw_reiserfs_volume *vol);
 static fsw_status_t fsw_reiserfs_volume_stat(struct fsw_reiserfs_volume *vol, struct fsw_volume_stat *sb);
@@ -72,6 +73,7 @@ struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(reiserfs) = {
     fsw_reiserfs_dir_lookup,
     fsw_reiserfs_dir_read,
     fsw_reiserfs_readlink,
+    fsw_reiserfs_volume_sniff,
 };
 
 // misc data
@@ -82,6 +84,30 @@ static fsw_u32  superblock_offsets[3] = {
     0
 };
 
+/**
+ * Check for one of the reiserfs magic strings at either superblock location
+ * without mounting the volume.
+ */
+
+static fsw_status_t fsw_reiserfs_volume_sniff(void *host_data, fsw_sniff_read_t read)
+{
+    fsw_status_t    status;
+    struct reiserfs_super_block_v1 sb;
+    int             i;
+
+    for (i = 0; superblock_offsets[i]; i++) {
+        status = read(host_data, (fsw_u64)superblock_offsets[i] << REISERFS_SUPERBLOCK_BLOCKSIZEBITS,
+                      sizeof(sb), &sb);
+        if (status)
+            return status;
+        if (fsw_memeq(sb.s_magic, REISERFS_SUPER_MAGIC_STRING, 8) ||
+            fsw_memeq(sb.s_magic, REISER2FS_SUPER_MAGIC_STRING, 9) ||
+            fsw_memeq(sb.s_magic, REISER2FS_JR_SUPER_MAGIC_STRING, 9))
+            return FSW_SUCCESS;
+    }
+    return FSW_UNSUPPORTED;
+}
+
 /**
  * Mount an reiserfs volume. Reads the superblock and constructs the
  * root directory dnode.
@@ -144,6 +170,8 @@ static fsw_status_t fsw_reiserfs_volume_mount(struct fsw_reiserfs_volume *vol)
     // set real blocksize
     blocksize = vol->sb->s_v1.s_blocksize;
     fsw_set_blocksize(vol, blocksize, blocksize);
+    if (vol->g.log_blocksize_bits < 9)      // not a power of 2 of at least 512 bytes
+        return FSW_VOLUME_CORRUPTED;
 
     // get other info from superblock
     /*
@@ -333,7 +361,7 @@ static fsw_status_t fsw_reiserfs_get_extent(struct fsw_reiserfs_volume *vol, str
     fsw_status_t    status;
     fsw_u64         search_offset, intra_offset;
     struct fsw_reiserfs_item item;
-    fsw_u32         intra_bno, nr_item;
+    fsw_u32         intra_bno, nr_item, file_bcnt;
 
     // Preconditions: The caller has checked that the requested logical block
     //  is within the file's size. The dnode has complete information, i.e.
@@ -346,7 +374,7 @@ static fsw_status_t fsw_reiserfs_get_extent(struct fsw_reiserfs_volume *vol, str
     extent->log_count = 1;
 
     // get the item for the requested block
-    search_offset = (fsw_u64)extent->log_start * vol->g.log_blocksize + 1;
+    search_offset = (extent->log_start << vol->g.log_blocksize_bits) + 1;
     status = fsw_reiserfs_item_search(vol, dno->dir_id, dno->g.dnode_id, search_offset, &item);
     if (status)
         return status;
@@ -364,7 +392,7 @@ static fsw_status_t fsw_reiserfs_get_extent(struct fsw_reiserfs_volume *vol, str
             FSW_MSG_ASSERT((FSW_MSGSTR("fsw_reiserfs_get_extent: intra_offset not block-aligned for indirect block\n")));
             goto bail;
         }
-        intra_bno = (fsw_u32)FSW_U64_DIV(intra_offset, vol->g.log_blocksize);
+        intra_bno = (fsw_u32)FSW_U64_SHR(intra_offset, vol->g.log_blocksize_bits);
         nr_item = item.ih.ih_item_len / sizeof(fsw_u32);
         if (intra_bno >= nr_item) {
             FSW_MSG_ASSERT((FSW_MSGSTR("fsw_reiserfs_get_extent: indirect block too small\n")));
@@ -373,7 +401,16 @@ static fsw_status_t fsw_reiserfs_get_extent(struct fsw_reiserfs_volume *vol, str
         extent->type = FSW_EXTENT_TYPE_PHYSBLOCK;
         extent->phys_start = ((fsw_u32 *)item.item_data)[intra_bno];
 
-        // TODO: check if the following blocks can be aggregated into one extent
+        // check if the following blocks can be aggregated into one extent
+        if (extent->phys_start != 0) {
+            file_bcnt = (fsw_u32)FSW_U64_SHR(dno->g.size + vol->g.log_blocksize - 1, vol->g.log_blocksize_bits);
+            while (intra_bno + extent->log_count < nr_item &&              // indirect item has more block pointers
+                   extent->log_start + extent->log_count < file_bcnt &&    // file has more blocks
+                   ((fsw_u32 *)item.item_data)[intra_bno + extent->log_count] == extent->phys_start + extent->log_count)
+                extent->log_count++;
+        } else {
+            extent->type = FSW_EXTENT_TYPE_SPARSE;
+        }
 
         fsw_reiserfs_item_release(vol, &item);
         return FSW_SUCCESS;
@@ -402,18 +439,6 @@ static fsw_status_t fsw_reiserfs_get_extent(struct fsw_reiserfs_volume *vol, str
 bail:
     fsw_reiserfs_item_release(vol, &item);
     return FSW_VOLUME_CORRUPTED;
-
-    /*    
-    // check if the following blocks can be aggregated into one extent
-    file_bcnt = (fsw_u32)((dno->g.size + vol->g.log_blocksize - 1) & (vol->g.log_blocksize - 1));
-    while (path[i]           + extent->log_count < buf_bcnt &&    // indirect block has more block pointers
-           extent->log_start + extent->log_count < file_bcnt) {   // file has more blocks
-        if (buffer[path[i] + extent->log_count] == buffer[path[i] + extent->log_count - 1] + 1)
-            extent->log_count++;
-        else
-            break;
-    }
-    */
 }
 
 /**
@@ -504,7 +529,7 @@ static fsw_status_t fsw_reiserfs_dir_read(struct fsw_reiserfs_volume *vol, struc
 {
     fsw_status_t    status;
     struct fsw_reiserfs_item item;
-    fsw_u32         nr_item, i, name_offset, next_name_offset, name_len;
+    fsw_u32         nr_item, i, lo, hi, name_offset, next_name_offset, name_len;
     fsw_u32         child_dir_id;
     struct reiserfs_de_head *dhead;
     struct fsw_string entry_name;
@@ -513,8 +538,6 @@ static fsw_status_t fsw_reiserfs_dir_read(struct fsw_reiserfs_volume *vol, struc
     //  has opened a storage handle to the directory's storage and keeps it around between
     //  calls.
 
-    // BIG TODOS: Use binary search within the item.
-
     // adjust pointer to first entry if necessary
     if (shand->pos == 0)
         shand->pos = FIRST_ITEM_OFFSET;
@@ -531,11 +554,19 @@ static fsw_status_t fsw_reiserfs_dir_read(struct fsw_reiserfs_volume *vol, struc
     for(;;) {
 
         // search the directory item
+        // entries are sorted by offset, skip the ones already returned
         dhead = (struct reiserfs_de_head *)item.item_data;
         nr_item = item.ih.u.ih_entry_count;
-        for (i = 0; i < nr_item; i++, dhead++) {
-            if (dhead->deh_offset < shand->pos)
-                continue;  // not yet past the last entry returned
+        lo = 0;
+        hi = nr_item;
+        while (lo < hi) {
+            i = lo + (hi - lo) / 2;
+            if (dhead[i].deh_offset < shand->pos)
+                lo = i + 1;
+            else
+                hi = i;
+        }
+        for (i = lo, dhead += lo; i < nr_item; i++, dhead++) {
             if (dhead->deh_offset == DOT_OFFSET || dhead->deh_offset == DOT_DOT_OFFSET)
                 continue;  // never report . or ..
 
@@ -629,7 +660,59 @@ static int fsw_reiserfs_compare_key(struct reiserfs_key *key,
 }
 
 /**
- * Find an item by key in the reiserfs tree.
+ * Binary search over the sorted keys of a tree node. The keys start at key_base and
+ * are key_stride bytes apart (plain keys in internal nodes, item heads in leaves).
+ * Returns the number of keys that are less than or equal to the search key.
+ */
+
+static fsw_u32 fsw_reiserfs_key_upper_bound(fsw_u8 *key_base, fsw_u32 key_stride, fsw_u32 nr_key,
+                                            fsw_u32 dir_id, fsw_u32 objectid, fsw_u64 offset)
+{
+    fsw_u32 lo, hi, mid;
+
+    lo = 0;
+    hi = nr_key;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (fsw_reiserfs_compare_key((struct reiserfs_key *)(key_base + mid * key_stride),
+                                     dir_id, objectid, offset) == FIRST_GREATER)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+/**
+ * Fill the item result fields from an item head in the current leaf block.
+ */
+
+static void fsw_reiserfs_item_fill(struct fsw_reiserfs_item *item, struct item_head *ihead,
+                                   fsw_u32 leaf_bno, fsw_u8 *buffer)
+{
+    fsw_memcpy(&item->ih, ihead, sizeof(struct item_head));
+    item->item_type = (fsw_u32)FSW_U64_SHR(ihead->ih_key.u.k_offset_v2.v, 60);
+    if (item->item_type != TYPE_DIRECT &&
+        item->item_type != TYPE_INDIRECT &&
+        item->item_type != TYPE_DIRENTRY) {
+        // 3.5 format (_v1)
+        item->item_type = ihead->ih_key.u.k_offset_v1.k_uniqueness;
+        item->item_offset = ihead->ih_key.u.k_offset_v1.k_offset;
+    } else {
+        // 3.6 format (_v2)
+        item->item_offset = ihead->ih_key.u.k_offset_v2.v & (~0ULL >> 4);
+    }
+    item->item_data = buffer + ihead->ih_item_location;
+    item->valid = 1;
+
+    // add information for block release
+    item->block_bno = leaf_bno;
+    item->block_buffer = buffer;
+}
+
+/**
+ * Find an item by key in the reiserfs tree. The path taken from the root down to the
+ * leaf is recorded in the item so that fsw_reiserfs_item_next can continue from there.
  */
 
 static fsw_status_t fsw_reiserfs_item_search(struct fsw_reiserfs_volume *vol,
@@ -637,18 +720,13 @@ static fsw_status_t fsw_reiserfs_item_search(struct fsw_reiserfs_volume *vol,
                                             struct fsw_reiserfs_item *item)
 {
     fsw_status_t    status;
-    int             comp_result;
     fsw_u32         tree_bno, next_tree_bno, tree_level, nr_item, i;
     fsw_u8          *buffer;
     struct block_head *bhead;
-    struct reiserfs_key *key;
     struct item_head *ihead;
 
     FSW_MSG_DEBUG((FSW_MSGSTR("fsw_reiserfs_item_search: searching %d/%d/%lld\n"), dir_id, objectid, offset));
 
-    // BIG TODOS: Use binary search within the item.
-    //  Remember tree path for "get next item" function.
-
     item->valid = 0;
     item->block_bno = 0;
 
@@ -674,41 +752,25 @@ static fsw_status_t fsw_reiserfs_item_search(struct fsw_reiserfs_volume *vol,
         if (tree_level == DISK_LEAF_NODE_LEVEL)
             break;
 
-        // search internal node block, look for the path to follow
-        key = (struct reiserfs_key *)(buffer + BLKH_SIZE);
-        for (i = 0; i < nr_item; i++, key++) {
-            if (fsw_reiserfs_compare_key(key, dir_id, objectid, offset) == FIRST_GREATER)
-                break;
-        }
+        // search internal node block, look for the path to follow: the child to the
+        // left of the first key that is greater than the search key
+        i = fsw_reiserfs_key_upper_bound(buffer + BLKH_SIZE, KEY_SIZE, nr_item, dir_id, objectid, offset);
         item->path_index[tree_level] = i;
         next_tree_bno = ((struct disk_child *)(buffer + BLKH_SIZE + nr_item * KEY_SIZE))[i].dc_block_number;
         fsw_block_release(vol, tree_bno, buffer);
         tree_bno = next_tree_bno;
     }
 
-    // search leaf node block, look for our data
-    ihead = (struct item_head *)(buffer + BLKH_SIZE);
-    for (i = 0; i < nr_item; i++, ihead++) {
-        comp_result = fsw_reiserfs_compare_key(&ihead->ih_key, dir_id, objectid, offset);
-        if (comp_result == KEYS_IDENTICAL)
-            break;
-        if (comp_result == FIRST_GREATER) {
-            // Current key is greater than the search key. Use the last key before this
-            // one as the preliminary result.
-            if (i == 0) {
-                fsw_block_release(vol, tree_bno, buffer);
-                return FSW_NOT_FOUND;
-            }
-            i--, ihead--;
-            break;
-        }
-    }
-    if (i >= nr_item) {
-        // Go back to the last key, it was smaller than the search key.
-        // NOTE: The first key of the next leaf block is guaranteed to be greater than
-        //  our search key.
-        i--, ihead--;
+    // search leaf node block, look for the last key that is not greater than the search key
+    // NOTE: The first key of the next leaf block is guaranteed to be greater than
+    //  our search key.
+    i = fsw_reiserfs_key_upper_bound(buffer + BLKH_SIZE, IH_SIZE, nr_item, dir_id, objectid, offset);
+    if (i == 0) {
+        fsw_block_release(vol, tree_bno, buffer);
+        return FSW_NOT_FOUND;
     }
+    i--;
+    ihead = ((struct item_head *)(buffer + BLKH_SIZE)) + i;
     item->path_index[tree_level] = i;
     // Since we may have a key that is smaller than the search key, verify that
     // it is for the same object.
@@ -718,24 +780,7 @@ static fsw_status_t fsw_reiserfs_item_search(struct fsw_reiserfs_volume *vol,
     }
 
     // return results
-    fsw_memcpy(&item->ih, ihead, sizeof(struct item_head));
-    item->item_type = (fsw_u32)FSW_U64_SHR(ihead->ih_key.u.k_offset_v2.v, 60);
-    if (item->item_type != TYPE_DIRECT &&
-        item->item_type != TYPE_INDIRECT &&
-        item->item_type != TYPE_DIRENTRY) {
-        // 3.5 format (_v1)
-        item->item_type = ihead->ih_key.u.k_offset_v1.k_uniqueness;
-        item->item_offset = ihead->ih_key.u.k_offset_v1.k_offset;
-    } else {
-        // 3.6 format (_v2)
-        item->item_offset = ihead->ih_key.u.k_offset_v2.v & (~0ULL >> 4);
-    }
-    item->item_data = buffer + ihead->ih_item_location;
-    item->valid = 1;
-
-    // add information for block release
-    item->block_bno = tree_bno;
-    item->block_buffer = buffer;
+    fsw_reiserfs_item_fill(item, ihead, tree_bno, buffer);
 
     FSW_MSG_DEBUG((FSW_MSGSTR("fsw_reiserfs_item_search: found %d/%d/%lld (%d)\n"),
                    ihead->ih_key.k_dir_id, ihead->ih_key.k_objectid, item->item_offset, item->item_type));
@@ -743,7 +788,10 @@ static fsw_status_t fsw_reiserfs_item_search(struct fsw_reiserfs_volume *vol,
 }
 
 /**
- * Find the next item in the reiserfs tree for an already-found item.
+ * Find the next item in the reiserfs tree for an already-found item. If the current
+ * leaf has more items, the item cursor simply advances within the leaf block it still
+ * holds. Otherwise the recorded path is used to climb to the nearest ancestor that has
+ * a right sibling pointer and to descend along the leftmost path from there.
  */
 
 static fsw_status_t fsw_reiserfs_item_next(struct fsw_reiserfs_volume *vol,
@@ -758,13 +806,33 @@ static fsw_status_t fsw_reiserfs_item_next(struct fsw_reiserfs_volume *vol,
 
     if (!item->valid)
         return FSW_NOT_FOUND;
-    fsw_reiserfs_item_release(vol, item);   // TODO: maybe delay this and/or use the cached block!
 
     dir_id = item->ih.ih_key.k_dir_id;
     objectid = item->ih.ih_key.k_objectid;
 
     FSW_MSG_DEBUG((FSW_MSGSTR("fsw_reiserfs_item_next: next for %d/%d/%lld\n"), dir_id, objectid, item->item_offset));
 
+    // fast path: the next item is in the leaf block we are still holding
+    if (item->block_bno > 0) {
+        tree_bno = item->block_bno;
+        buffer = item->block_buffer;
+        bhead = (struct block_head *)buffer;
+        if (item->path_index[DISK_LEAF_NODE_LEVEL] + 1 < bhead->blk_nr_item) {
+            item->path_index[DISK_LEAF_NODE_LEVEL]++;
+            ihead = ((struct item_head *)(buffer + BLKH_SIZE)) + item->path_index[DISK_LEAF_NODE_LEVEL];
+            if (ihead->ih_key.k_dir_id != dir_id || ihead->ih_key.k_objectid != objectid) {
+                fsw_reiserfs_item_release(vol, item);
+                return FSW_NOT_FOUND;   // Found no next key for this object
+            }
+            fsw_reiserfs_item_fill(item, ihead, tree_bno, buffer);
+
+            FSW_MSG_DEBUG((FSW_MSGSTR("fsw_reiserfs_item_next: found %d/%d/%lld (%d)\n"),
+                           ihead->ih_key.k_dir_id, ihead->ih_key.k_objectid, item->item_offset, item->item_type));
+            return FSW_SUCCESS;
+        }
+    }
+    fsw_reiserfs_item_release(vol, item);
+
     // find a node that has more items, moving up until we find one
 
     for (tree_level = DISK_LEAF_NODE_LEVEL; tree_level < vol->sb->s_v1.s_tree_height; tree_level++) {
@@ -813,6 +881,10 @@ static fsw_status_t fsw_reiserfs_item_next(struct fsw_reiserfs_volume *vol,
             FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_reiserfs_item_next: visiting block %d level %d items %d\n"), tree_bno, tree_level, nr_item));
             item->path_bno[tree_level] = tree_bno;
         }
+        if (nr_item == 0) {
+            fsw_block_release(vol, tree_bno, buffer);
+            return FSW_VOLUME_CORRUPTED;
+        }
 
         // get the item from the leaf node
         ihead = ((struct item_head *)(buffer + BLKH_SIZE)) + item->path_index[tree_level];
@@ -825,24 +897,7 @@ static fsw_status_t fsw_reiserfs_item_next(struct fsw_reiserfs_volume *vol,
         }
 
         // return results
-        fsw_memcpy(&item->ih, ihead, sizeof(struct item_head));
-        item->item_type = (fsw_u32)FSW_U64_SHR(ihead->ih_key.u.k_offset_v2.v, 60);
-        if (item->item_type != TYPE_DIRECT &&
-            item->item_type != TYPE_INDIRECT &&
-            item->item_type != TYPE_DIRENTRY) {
-            // 3.5 format (_v1)
-            item->item_type = ihead->ih_key.u.k_offset_v1.k_uniqueness;
-            item->item_offset = ihead->ih_key.u.k_offset_v1.k_offset;
-        } else {
-            // 3.6 format (_v2)
-            item->item_offset = ihead->ih_key.u.k_offset_v2.v & (~0ULL >> 4);
-        }
-        item->item_data = buffer + ihead->ih_item_location;
-        item->valid = 1;
-
-        // add information for block release
-        item->block_bno = tree_bno;
-        item->block_buffer = buffer;
+        fsw_reiserfs_item_fill(item, ihead, tree_bno, buffer);
 
         FSW_MSG_DEBUG((FSW_MSGSTR("fsw_reiserfs_item_next: found %d/%d/%lld (%d)\n"),
                        ihead->ih_key.k_dir_id, ihead->ih_key.k_objectid, item->item_offset, item->item_type));
@@ -0,0 +1,159 @@
+/**
+ * \file fsw_shandle_read.h
+ * Body of fsw_shandle_read, instantiated by fsw_core.c once per block geometry.
+ *
+ * Before including this file, define FSW_SHANDLE_READ_NAME to the name of the
+ * function to generate. Define FSW_SHANDLE_READ_LOG_BITS and
+ * FSW_SHANDLE_READ_PHYS_BITS to constant log2 block sizes to get a copy in which
+ * all block/byte conversions are shifts by constants; leave them undefined for
+ * the generic copy that works from vol->log_blocksize and vol->phys_blocksize.
+ * All macros are undefined again at the end of this file.
+ */
+
+/*-
+ * Copyright (c) 2006 Christoph Pfisterer
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *  * Neither the name of Christoph Pfisterer nor the names of the
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef FSW_SHANDLE_READ_LOG_BITS
+#define LOG_BNO(pos)        FSW_U64_SHR(pos, FSW_SHANDLE_READ_LOG_BITS)
+#define LOG_BYTES(count)    ((fsw_u64)(count) << FSW_SHANDLE_READ_LOG_BITS)
+#define PHYS_BNO(pos)       FSW_U64_SHR(pos, FSW_SHANDLE_READ_PHYS_BITS)
+#define PHYS_SIZE           ((fsw_u32)1 << FSW_SHANDLE_READ_PHYS_BITS)
+#else
+#define LOG_BNO(pos)        FSW_U64_DIV(pos, vol->log_blocksize)
+#define LOG_BYTES(count)    ((fsw_u64)(count) * vol->log_blocksize)
+#define PHYS_BNO(pos)       FSW_U64_DIV(pos, vol->phys_blocksize)
+#define PHYS_SIZE           vol->phys_blocksize
+#endif
+
+static fsw_status_t FSW_SHANDLE_READ_NAME(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout, void *buffer_in)
+{
+    fsw_status_t    status;
+    struct fsw_dnode *dno = shand->dnode;
+    struct fsw_volume *vol = dno->vol;
+    fsw_u8          *buffer, *block_buffer;
+    fsw_u64         buflen, copylen, pos;
+    fsw_u64         log_bno, pos_in_extent, phys_bno, pos_in_physblock;
+    fsw_u32         cache_level;
+
+    if (shand->pos >= dno->size) {   // already at EOF
+        *buffer_size_inout = 0;
+        return FSW_SUCCESS;
+    }
+
+    // initialize vars
+    buffer = buffer_in;
+    buflen = *buffer_size_inout;
+    pos = (fsw_u32)shand->pos;
+    cache_level = (dno->type != FSW_DNODE_TYPE_FILE) ? 1 : 0;
+    // restrict read to file size
+    if (buflen > dno->size - pos)
+        buflen = (fsw_u32)(dno->size - pos);
+
+    while (buflen > 0) {
+        // get extent for the current logical block
+        log_bno = LOG_BNO(pos);
+        if (shand->extent.type == FSW_EXTENT_TYPE_INVALID ||
+            log_bno < shand->extent.log_start ||
+            log_bno >= shand->extent.log_start + shand->extent.log_count) {
+
+            if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER &&
+                !(shand->extent.flags & FSW_EXTENT_FLAG_BORROWED))
+                fsw_free(shand->extent.buffer);
+
+            // ask the file system for the proper extent
+            shand->extent.log_start = log_bno;
+            shand->extent.flags = 0;
+            status = vol->fstype_table->get_extent(vol, dno, &shand->extent);
+            if (status) {
+                shand->extent.type = FSW_EXTENT_TYPE_INVALID;
+                return status;
+            }
+        }
+
+        pos_in_extent = pos - LOG_BYTES(shand->extent.log_start);
+
+        // dispatch by extent type
+        if (shand->extent.type == FSW_EXTENT_TYPE_PHYSBLOCK) {
+            // convert to physical block number and offset
+            phys_bno = shand->extent.phys_start + PHYS_BNO(pos_in_extent);
+            pos_in_physblock = pos_in_extent & (PHYS_SIZE - 1);
+            copylen = PHYS_SIZE - pos_in_physblock;
+            if (copylen > buflen)
+                copylen = buflen;
+
+            // get one physical block
+            status = fsw_block_get(vol, phys_bno, cache_level, (void **)&block_buffer);
+            if (status)
+                return status;
+
+            // copy data from it
+            fsw_memcpy(buffer, block_buffer + pos_in_physblock, copylen);
+            fsw_block_release(vol, phys_bno, block_buffer);
+
+        } else if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER) {
+            copylen = LOG_BYTES(shand->extent.log_count) - pos_in_extent;
+            if (copylen > buflen)
+                copylen = buflen;
+            fsw_memcpy(buffer, (fsw_u8 *)shand->extent.buffer + pos_in_extent, copylen);
+
+        } else {   // _SPARSE or _INVALID
+            copylen = LOG_BYTES(shand->extent.log_count) - pos_in_extent;
+            if (copylen > buflen)
+                copylen = buflen;
+            fsw_memzero(buffer, copylen);
+
+        }
+
+        buffer += copylen;
+        buflen -= copylen;
+        pos    += copylen;
+    }
+
+    // a borrowed buffer is only valid until the driver's next get_extent call, which
+    // may come from another shandle on the same volume
+    if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER &&
+        (shand->extent.flags & FSW_EXTENT_FLAG_BORROWED))
+        shand->extent.type = FSW_EXTENT_TYPE_INVALID;
+
+    *buffer_size_inout = (fsw_u32)(pos - shand->pos);
+    shand->pos = pos;
+
+    return FSW_SUCCESS;
+}
+
+#undef LOG_BNO
+#undef LOG_BYTES
+#undef PHYS_BNO
+#undef PHYS_SIZE
+#undef FSW_SHANDLE_READ_NAME
+#undef FSW_SHANDLE_READ_LOG_BITS
+#undef FSW_SHANDLE_READ_PHYS_BITS
@@ -20,6 +20,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifdef HOST_POSIX
+/* The POSIX test host has no other disks: a volume is always on its own.  */
+#define SCAN_KEY_SIZE 32
+static struct fsw_volume *clone_dummy_volume(struct fsw_volume *vol) { return NULL; }
+static int scan_disks(fsw_status_t (*probe)(struct fsw_volume *, void *),
+                      int (*match)(struct fsw_volume *, const void *),
+                      int (*hook)(struct fsw_volume *, struct fsw_volume *),
+                      struct fsw_volume *master) { return 0; }
+static void scan_map_free(void) { }
+#else
+
 #include "fsw_efi.h"
 #ifdef __MAKEWITH_GNUEFI
 #include "edk2/DriverBinding.h"
@@ -88,13 +99,59 @@ static void free_dummy_volume(struct fsw_volume *vol)
     fsw_unmount(vol);
 }
 
-static int scan_disks(int (*hook)(struct fsw_volume *, struct fsw_volume *), struct fsw_volume *master)
+/*
+ * Disks seen by the last scan, with the identity the probe callback read
+ * off each of them.  The map is shared by all master volumes, so every
+ * disk is probed once instead of once per multi-device filesystem; a disk
+ * is only probed again when its handle is new or its MediaId changed.
+ */
+#define SCAN_KEY_SIZE 32
+
+struct scan_disk_entry {
+    EFI_HANDLE   handle;
+    EFI_DISK_IO *diskio;
+    UINT32       media_id;
+    int          probed;                /* probe gave a definite answer */
+    int          valid;                 /* probe recognized the disk, key is set */
+    UINT8        key[SCAN_KEY_SIZE];
+};
+
+static struct scan_disk_entry *scan_map = NULL;
+static UINTN scan_map_count = 0;
+
+static struct scan_disk_entry *scan_map_find(EFI_HANDLE handle, EFI_DISK_IO *diskio, UINT32 media_id)
+{
+    UINTN i;
+
+    for (i = 0; i < scan_map_count; i++)
+        if (scan_map[i].probed && scan_map[i].handle == handle
+                && scan_map[i].diskio == diskio && scan_map[i].media_id == media_id)
+            return &scan_map[i];
+    return NULL;
+}
+
+/*
+ * probe reads the identity of a disk into a SCAN_KEY_SIZE buffer and
+ * returns FSW_SUCCESS if the disk belongs to the filesystem type, or
+ * FSW_UNSUPPORTED if it certainly does not.  Only these two answers are
+ * remembered; after any other error, such as a failed read, the disk is
+ * probed again by the next scan.  match decides from the key alone whether
+ * master wants the disk, and only then hook is called to attach it.
+ */
+static int scan_disks(fsw_status_t (*probe)(struct fsw_volume *, void *),
+                      int (*match)(struct fsw_volume *, const void *),
+                      int (*hook)(struct fsw_volume *, struct fsw_volume *),
+                      struct fsw_volume *master)
 {
     EFI_STATUS  Status;
     EFI_HANDLE *Handles;
     UINTN       HandleCount = 0;
     UINTN       i;
     UINTN       scanned = 0;
+    struct scan_disk_entry *map;
+    struct scan_disk_entry *old;
+    struct fsw_volume *vol;
+    fsw_status_t status;
 
     // Driver hangs if compiled with GNU-EFI unless there's a Print() statement somewhere.
     // I'm still trying to track that down; in the meantime, work around it....
@@ -105,23 +162,70 @@ static int scan_disks(int (*hook)(struct fsw_volume *, struct fsw_volume *), str
     Status = refit_call5_wrapper(BS->LocateHandleBuffer, ByProtocol, &gMyEfiDiskIoProtocolGuid, NULL, &HandleCount, &Handles);
     if (Status == EFI_NOT_FOUND)
         return -1;  // no filesystems. strange, but true...
+    if (Status != EFI_SUCCESS)
+        return 0;
+    if (fsw_alloc_zero(sizeof(struct scan_disk_entry) * HandleCount, (void **)&map)) {
+        FreePool(Handles);
+        return 0;
+    }
+
     for (i = 0; i < HandleCount; i++) {
         EFI_DISK_IO *diskio;
         EFI_BLOCK_IO *blockio;
+        struct scan_disk_entry *e = &map[i];
+
         Status = refit_call3_wrapper(BS->HandleProtocol, Handles[i], &gMyEfiDiskIoProtocolGuid, (VOID **) &diskio);
         if (Status != 0)
             continue;
         Status = refit_call3_wrapper(BS->HandleProtocol, Handles[i], &gMyEfiBlockIoProtocolGuid, (VOID **) &blockio);
         if (Status != 0)
             continue;
-        struct fsw_volume *vol = create_dummy_volume(diskio, blockio->Media->MediaId);
-        if(vol) {
+        e->handle = Handles[i];
+        e->diskio = diskio;
+        e->media_id = blockio->Media->MediaId;
+
+        old = scan_map_find(e->handle, e->diskio, e->media_id);
+        if (old) {
+            e->probed = 1;
+            e->valid = old->valid;
+            fsw_memcpy(e->key, old->key, SCAN_KEY_SIZE);
+        } else {
+            vol = create_dummy_volume(diskio, e->media_id);
+            if (vol == NULL)
+                continue;
+            DPRINT(L"Probing disk %d\n", i);
+            status = probe(vol, e->key);
+            e->probed = status == FSW_SUCCESS || status == FSW_UNSUPPORTED;
+            e->valid = status == FSW_SUCCESS;
+            free_dummy_volume(vol);
+        }
+
+        if (!e->valid || !match(master, e->key))
+            continue;
+        vol = create_dummy_volume(diskio, e->media_id);
+        if (vol) {
             DPRINT(L"Checking disk %d\n", i);
-            if(hook(master, vol) == FSW_SUCCESS)
+            if (hook(master, vol) == FSW_SUCCESS)
                 scanned++;
             free_dummy_volume(vol);
         }
     }
+
+    if (scan_map)
+        fsw_free(scan_map);
+    scan_map = map;
+    scan_map_count = HandleCount;
+    FreePool(Handles);
     return scanned;
 }
 
+/* Forget the remembered disks; called once no volume is left to scan for.  */
+static void scan_map_free(void)
+{
+    if (scan_map)
+        fsw_free(scan_map);
+    scan_map = NULL;
+    scan_map_count = 0;
+}
+
+#endif /* HOST_POSIX */
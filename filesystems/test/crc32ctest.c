@@ -0,0 +1,185 @@
+/**
+ * \file crc32ctest.c
+ * Checks the crc32c engines shared by the ext4 and btrfs drivers against the
+ * RFC 3720 test vectors and a bitwise reference.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../fsw_ext4.c"
+
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/* one bit at a time, without tables or inversion */
+static fsw_u32 crc32c_bitwise(fsw_u32 crc, const fsw_u8 *p, fsw_u32 size)
+{
+    int k;
+
+    while (size--) {
+        crc ^= *p++;
+        for (k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (CRC32C_POLY & -(crc & 1));
+    }
+    return crc;
+}
+
+struct engine {
+    const char *name;
+    crc32c_fn fn;
+};
+
+static struct engine engines[3];
+static int nengines;
+
+static void find_engines(void)
+{
+    init_crc32c_table();
+    engines[nengines].name = "slicing-by-8";
+    engines[nengines++].fn = crc32c_sb8;
+#ifdef crc32c_hw
+    if (crc32c_have_hw()) {
+        engines[nengines].name = "crc32 instructions";
+        engines[nengines++].fn = crc32c_hw;
+    } else {
+        printf("crc32ctest: no crc32c instructions on this CPU, not checked\n");
+    }
+#endif
+    engines[nengines].name = "crc32c_raw";
+    engines[nengines++].fn = crc32c_update;
+}
+
+//
+// RFC 3720 appendix B.4, plus the usual check value
+//
+
+static void test_vectors(void)
+{
+    fsw_u8 buf[32];
+    int i;
+
+    check(grub_getcrc32c(0, "123456789", 9) == 0xE3069283, "check value");
+    check(grub_getcrc32c(0, buf, 0) == 0, "empty buffer");
+
+    memset(buf, 0, 32);
+    check(grub_getcrc32c(0, buf, 32) == 0x8A9136AA, "32 bytes of zeros");
+    memset(buf, 0xff, 32);
+    check(grub_getcrc32c(0, buf, 32) == 0x62A8AB43, "32 bytes of ones");
+    for (i = 0; i < 32; i++)
+        buf[i] = i;
+    check(grub_getcrc32c(0, buf, 32) == 0x46DD794E, "32 incrementing bytes");
+    for (i = 0; i < 32; i++)
+        buf[i] = 31 - i;
+    check(grub_getcrc32c(0, buf, 32) == 0x113FDB5C, "32 decrementing bytes");
+}
+
+/* every engine, at every alignment of a word and every length up to 300,
+ * with a seed, and chained in two pieces the way the ext4 checksums are */
+static void test_engines(void)
+{
+    static fsw_u8 buf[4096 + 16];
+    fsw_u32 off, len, split, want;
+    int e, bad;
+    char what[80];
+
+    for (len = 0; len < sizeof(buf); len++)
+        buf[len] = (fsw_u8)(len * 167 + 13);
+
+    for (e = 0; e < nengines; e++) {
+        bad = 0;
+        for (off = 0; off < 16; off++)
+            for (len = 0; len < 300; len++) {
+                want = crc32c_bitwise(0x12345678 + len, buf + off, len);
+                if (engines[e].fn(0x12345678 + len, buf + off, len) != want)
+                    bad++;
+            }
+        for (split = 0; split <= 4096; split += 61) {
+            want = crc32c_bitwise(~0U, buf + 3, 4096);
+            if (engines[e].fn(engines[e].fn(~0U, buf + 3, split), buf + 3 + split, 4096 - split) != want)
+                bad++;
+        }
+        snprintf(what, sizeof(what), "%s against the bitwise reference", engines[e].name);
+        check(bad == 0, what);
+    }
+}
+
+static void bench_engines(void)
+{
+    static fsw_u8 buf[1 << 20];
+    clock_t start;
+    double secs;
+    fsw_u32 crc = 0;
+    int e, round, rounds;
+
+    for (round = 0; round < (int)sizeof(buf); round++)
+        buf[round] = (fsw_u8)round;
+
+    for (e = 0; e < nengines; e++) {
+        rounds = 0;
+        start = clock();
+        do {
+            for (round = 0; round < 16; round++)
+                crc = engines[e].fn(crc, buf + 1, sizeof(buf) - 1);
+            rounds += 16;
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+        } while (secs < 0.5);
+        printf("crc32c: %.0f MB/s (%s)\n", rounds * (sizeof(buf) - 1) / 1e6 / secs, engines[e].name);
+    }
+
+    start = clock();
+    for (round = 0; round < 16; round++)
+        crc = crc32c_bitwise(crc, buf, sizeof(buf));
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("crc32c: %.0f MB/s (bitwise), last crc %08x\n", 16.0 * sizeof(buf) / 1e6 / (secs > 0 ? secs : 1e-9), crc);
+}
+
+int main(int argc, char **argv)
+{
+    find_engines();
+    test_vectors();
+    test_engines();
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        bench_engines();
+
+    if (failures) {
+        printf("crc32ctest: %d failures\n", failures);
+        return 1;
+    }
+    printf("crc32ctest: ok\n");
+    return 0;
+}
+
+// EOF
@@ -52,7 +52,7 @@ fsw_status_t fsw_posix_open_dno(struct fsw_posix_volume *pvol, const char *path,
 void fsw_posix_change_blocksize(struct fsw_volume *vol,
                               fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                               fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
-fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u64 phys_bno, void *buffer);
 
 /**
  * Dispatch table for our FSW host driver.
@@ -362,7 +362,7 @@ void fsw_posix_change_blocksize(struct fsw_volume *vol,
  * to read a block of data from the device. The buffer is allocated by the core code.
  */
 
-fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer)
+fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u64 phys_bno, void *buffer)
 {
     struct fsw_posix_volume *pvol = (struct fsw_posix_volume *)vol->host_data;
     off_t           block_offset, seek_result;
@@ -383,6 +383,23 @@ fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void
 }
 
 
+/**
+ * Callbacks for the fsw_dnode_stat call. The POSIX host reports neither times
+ * nor attributes, so they are dropped.
+ */
+
+void fsw_store_time_posix(struct fsw_dnode_stat *sb, int which, fsw_u32 posix_time)
+{
+}
+
+void fsw_store_attr_posix(struct fsw_dnode_stat *sb, fsw_u16 posix_mode)
+{
+}
+
+void fsw_store_attr_efi(struct fsw_dnode_stat *sb, fsw_u16 attr)
+{
+}
+
 /**
  * Time mapping callback for the fsw_dnode_stat call. This function converts
  * a Posix style timestamp into an EFI_TIME structure and writes it to the
@@ -87,4 +87,30 @@ typedef uint64_t            fsw_u64;
 #define RShiftU64(val, shift) ((val) >> (shift))
 #define LShiftU64(val, shift) ((val) << (shift))
 
+// EFI types and library functions the drivers use directly
+
+#define EFIAPI
+
+typedef uint8_t             UINT8;
+typedef uint32_t            UINT32;
+typedef uint64_t            UINT64;
+typedef size_t              UINTN;
+typedef uint8_t             BOOLEAN;
+typedef void                VOID;
+
+#define TRUE  (1)
+#define FALSE (0)
+
+#define AllocatePool(size) malloc(size)
+#define FreePool(ptr) free(ptr)
+
+static inline UINT64 DivU64x32Remainder(UINT64 val, UINT32 div, UINT32 *rem)
+{
+    if (rem)
+        *rem = val % div;
+    return val / div;
+}
+
+#define fsw_efi_clear_cache()
+
 #endif
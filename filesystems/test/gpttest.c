@@ -0,0 +1,284 @@
+/**
+ * \file gpttest.c
+ * GPT header and entry array CRC checks of gptsync, run on an in-memory disk.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <wchar.h>
+#include <time.h>
+
+// types the non-EFI branch of gptsync.h expects from the environment
+typedef uint8_t             UINT8;
+typedef uint16_t            UINT16;
+typedef uint32_t            UINT32;
+typedef uint64_t            UINT64;
+typedef size_t              UINTN;
+typedef void                VOID;
+
+// crc32.h only knows the EFI headers; declare the one function here
+#define __CRC32_H_
+UINT32 crc32(UINT32 crc, const VOID *buf, UINTN size);
+
+#include <string.h>
+
+// copy_guid() goes through gBS->CopyMem
+static VOID host_copy_mem(VOID *dest, const VOID *src, UINTN len)
+{
+    memcpy(dest, src, len);
+}
+
+static struct {
+    VOID (*CopyMem)(VOID *dest, const VOID *src, UINTN len);
+} host_bs = { host_copy_mem }, *gBS = &host_bs;
+
+// detect_mbrtype_fs() uses the EFI name even outside CONFIG_EFI
+#define CompareMem(a, b, len) memcmp(a, b, len)
+
+#include "../../gptsync/lib.c"
+#include "../../refind/crc32.c"
+
+//
+// in-memory disk and console for lib.c
+//
+
+#define DISK_SECTORS    (64)
+
+static UINT8 disk[DISK_SECTORS * 512];
+static char  console[8192];
+
+UINTN read_sector(UINT64 lba, UINT8 *buffer)
+{
+    if (lba >= DISK_SECTORS)
+        return 1;
+    memcpy(buffer, disk + lba * 512, 512);
+    return 0;
+}
+
+void Print(wchar_t *format, ...)
+{
+    wchar_t line[512];
+    size_t  used = strlen(console);
+    va_list ap;
+
+    va_start(ap, format);
+    vswprintf(line, 512, format, ap);
+    va_end(ap);
+    snprintf(console + used, sizeof(console) - used, "%ls", line);
+}
+
+//
+// bitwise reference for the slicing-by-8 crc32
+//
+
+static UINT32 crc32_bitwise(UINT32 crc, const UINT8 *p, UINTN size)
+{
+    int k;
+
+    crc = ~crc;
+    while (size--) {
+        crc ^= *p++;
+        for (k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+//
+// GPT image construction
+//
+
+// EFI system partition and basic data type GUIDs, on-disk byte order
+static const UINT8 esp_guid[16] = { 0x28,0x73,0x2A,0xC1,0x1F,0xF8,0xD2,0x11,
+                                    0xBA,0x4B,0x00,0xA0,0xC9,0x3E,0xC9,0x3B };
+static const UINT8 data_guid[16] = { 0xA2,0xA0,0xD0,0xEB,0xE5,0xB9,0x33,0x44,
+                                     0x87,0xC0,0x68,0xB6,0xB7,0x26,0x99,0xC7 };
+
+#define ENTRY_COUNT     (128)
+#define ENTRY_SIZE      (128)
+
+static void build_gpt(void)
+{
+    GPT_HEADER *header = (GPT_HEADER *)(disk + 512);
+    GPT_ENTRY  *entries = (GPT_ENTRY *)(disk + 2 * 512);
+
+    memset(disk, 0, sizeof(disk));
+
+    memcpy(entries[0].type_guid, esp_guid, 16);
+    entries[0].partition_guid[0] = 1;
+    entries[0].start_lba = 34;
+    entries[0].end_lba   = 47;
+    memcpy(entries[2].type_guid, data_guid, 16);
+    entries[2].partition_guid[0] = 3;
+    entries[2].start_lba = 48;
+    entries[2].end_lba   = 62;
+
+    header->signature            = 0x5452415020494645ULL;
+    header->spec_revision        = 0x00010000UL;
+    header->header_size          = 92;
+    header->header_lba           = 1;
+    header->alternate_header_lba = DISK_SECTORS - 1;
+    header->first_usable_lba     = 34;
+    header->last_usable_lba      = DISK_SECTORS - 2;
+    header->entry_lba            = 2;
+    header->entry_count          = ENTRY_COUNT;
+    header->entry_size           = ENTRY_SIZE;
+    header->entry_crc32          = crc32_bitwise(0, (UINT8 *)entries, ENTRY_COUNT * ENTRY_SIZE);
+    header->header_crc32         = 0;
+    header->header_crc32         = crc32_bitwise(0, (UINT8 *)header, header->header_size);
+}
+
+static int run_read_gpt(void)
+{
+    console[0] = 0;
+    gpt_part_count = 0;
+    return (int)read_gpt();
+}
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        printf("---- console ----\n%s-----------------\n", console);
+        failures++;
+    }
+}
+
+static void test_crc32(void)
+{
+    static UINT8 buf[4096 + 8];
+    UINTN i, off, len;
+    UINT32 crc;
+
+    check(crc32(0, "123456789", 9) == 0xCBF43926, "crc32 check value");
+    check(crc32(0, buf, 0) == 0, "crc32 of nothing");
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (UINT8)(i * 131 + 7);
+    for (off = 0; off < 8; off++) {
+        for (len = 0; len < 300; len++) {
+            if (crc32(0, buf + off, len) != crc32_bitwise(0, buf + off, len)) {
+                check(0, "crc32 against the bitwise reference");
+                return;
+            }
+        }
+    }
+
+    // feeding the data in pieces must give the same result
+    crc = crc32(0, buf, 1000);
+    crc = crc32(crc, buf + 1000, 3);
+    crc = crc32(crc, buf + 1003, 4096 - 1003);
+    check(crc == crc32_bitwise(0, buf, 4096), "crc32 in pieces");
+}
+
+static void test_gpt(void)
+{
+    GPT_HEADER *header = (GPT_HEADER *)(disk + 512);
+
+    // intact table: both partitions found and listed
+    build_gpt();
+    check(run_read_gpt() == 0, "valid: read_gpt status");
+    check(gpt_part_count == 2, "valid: two partitions");
+    check(gpt_part_count == 2 && gpt_parts[0].index == 0 && gpt_parts[0].start_lba == 34 &&
+          gpt_parts[1].index == 2 && gpt_parts[1].end_lba == 62, "valid: partition fields");
+    check(strstr(console, "Start LBA") != NULL, "valid: partition list printed");
+    check(strstr(console, "CRC mismatch") == NULL, "valid: no CRC error");
+
+    // header CRC broken: the table is rejected before the entries are read
+    build_gpt();
+    header->header_crc32 ^= 1;
+    check(run_read_gpt() == 0, "bad header crc: read_gpt status");
+    check(gpt_part_count == 0, "bad header crc: no partitions");
+    check(strstr(console, "GPT header CRC mismatch") != NULL, "bad header crc: error reported");
+
+    // a header field changed behind the CRC's back
+    build_gpt();
+    header->entry_count = 64;
+    check(run_read_gpt() == 0, "stale header crc: read_gpt status");
+    check(gpt_part_count == 0, "stale header crc: no partitions");
+    check(strstr(console, "GPT header CRC mismatch") != NULL, "stale header crc: error reported");
+
+    // one entry byte flipped: nothing may be listed or kept
+    build_gpt();
+    disk[2 * 512 + 2 * ENTRY_SIZE + 40] ^= 0x80;
+    check(run_read_gpt() == 0, "bad entry crc: read_gpt status");
+    check(gpt_part_count == 0, "bad entry crc: no partitions");
+    check(strstr(console, "entry array CRC mismatch") != NULL, "bad entry crc: error reported");
+    check(strstr(console, "Start LBA") == NULL, "bad entry crc: partition list not printed");
+
+    // a flipped byte in an unused entry counts just the same
+    build_gpt();
+    disk[2 * 512 + 100 * ENTRY_SIZE] ^= 0x01;
+    check(run_read_gpt() == 0, "bad unused entry: read_gpt status");
+    check(gpt_part_count == 0, "bad unused entry: no partitions");
+    check(strstr(console, "entry array CRC mismatch") != NULL, "bad unused entry: error reported");
+}
+
+static void bench_crc32(void)
+{
+    static UINT8 buf[1 << 20];
+    clock_t start;
+    double secs;
+    UINT32 crc = 0;
+    int round;
+
+    for (round = 0; round < (int)sizeof(buf); round++)
+        buf[round] = (UINT8)round;
+
+    start = clock();
+    for (round = 0; round < 256; round++)
+        crc = crc32(crc, buf, sizeof(buf));
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("crc32: %.0f MB/s (slicing-by-8)\n", 256.0 / (secs > 0 ? secs : 1e-9));
+
+    start = clock();
+    for (round = 0; round < 16; round++)
+        crc = crc32_bitwise(crc, buf, sizeof(buf));
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("crc32: %.0f MB/s (bitwise), last crc %08x\n", 16.0 / (secs > 0 ? secs : 1e-9), crc);
+}
+
+int main(int argc, char **argv)
+{
+    test_crc32();
+    test_gpt();
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        bench_crc32();
+
+    if (failures) {
+        printf("gpttest: %d failures\n", failures);
+        return 1;
+    }
+    printf("gpttest: ok\n");
+    return 0;
+}
+
+// EOF
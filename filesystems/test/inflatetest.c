@@ -0,0 +1,1109 @@
+/**
+ * \file inflatetest.c
+ * Checks the btrfs zlib extent decompression against reference streams:
+ * stored, fixed and dynamic Huffman blocks, one-shot and piecewise reads,
+ * and damaged or truncated input.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../fsw_btrfs.c"
+
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+//
+// reference data: make_data() output, compressed with python's zlib module
+// (zlib 1.2): level 9, level 6 with Z_FIXED, level 6 with a 4 KiB window and
+// a Z_SYNC_FLUSH every 16 KiB, level 0 over the first 1500 bytes, and level 6
+// over the first 100 bytes with the preset dictionary "btrfs extent "
+//
+
+#define DATA_SIZE   (40000)
+#define STORED_SIZE (1500)
+
+static fsw_u32 rnd_state;
+
+static fsw_u32 rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+/* words, then a mix of words, literals, short repeating patterns and copies
+ * from up to 32 KiB back, so matches of every length and distance show up */
+static void make_data(fsw_u8 *p, unsigned n)
+{
+    static const char *words[] = { "inflate ", "window ", "huffman ", "btrfs ", "extent ",
+                                   "zlib ", "deflate ", "\n", "block ", "4096 " };
+    unsigned i = 0, k;
+
+    rnd_state = 11;
+    while (i < n) {
+        fsw_u32 r = rnd();
+        if (i < 2000 || r % 4 == 0) {
+            const char *w = words[r % 10];
+            for (k = 0; w[k] && i < n; k++)
+                p[i++] = w[k];
+        } else if (r % 4 == 1) {
+            unsigned back = 1 + rnd() % (i < 32768 ? i : 32768), len = 3 + rnd() % 258;
+            for (k = 0; k < len && i < n; k++, i++)
+                p[i] = p[i - back];
+        } else if (r % 4 == 2) {
+            unsigned period = 1 + rnd() % 8, len = 1 + rnd() % 300;
+            for (k = 0; k < len && i < n; k++, i++)
+                p[i] = k < period ? (fsw_u8)rnd() : p[i - period];
+        } else {
+            p[i++] = rnd();
+        }
+    }
+}
+
+static const fsw_u8 stream_dynamic[2188] = {
+    0x78, 0xda, 0xed, 0x1d, 0x59, 0x50, 0x14, 0x47, 0x34, 0xca, 0x21, 0x8e,
+    0x22, 0x6a, 0x28, 0x63, 0xb4, 0x50, 0x08, 0x58, 0x62, 0x22, 0x8a, 0x06,
+    0x8c, 0x48, 0x11, 0x44, 0x2d, 0xc4, 0x1b, 0xf1, 0x04, 0x51, 0x01, 0x01,
+    0xe5, 0x10, 0x54, 0x4e, 0x2f, 0x2c, 0x8c, 0x02, 0x86, 0x18, 0xc5, 0x42,
+    0x02, 0x1e, 0x41, 0x29, 0x0c, 0x5a, 0x04, 0x8a, 0x10, 0x8d, 0x78, 0x62,
+    0x08, 0x87, 0x28, 0x85, 0x85, 0x07, 0x1e, 0x80, 0x82, 0x16, 0x48, 0x80,
+    0xc4, 0x10, 0x8d, 0xf9, 0xc0, 0x8a, 0x29, 0x77, 0xba, 0x97, 0xe9, 0x66,
+    0x64, 0x81, 0x65, 0x67, 0x67, 0xba, 0xb7, 0x7b, 0xfa, 0xbd, 0x9d, 0xab,
+    0x8f, 0xf7, 0x5e, 0xbf, 0xe9, 0x79, 0xfd, 0xa6, 0xd7, 0xca, 0xd2, 0x66,
+    0x8a, 0x71, 0x84, 0x5f, 0x90, 0x77, 0x70, 0x84, 0xb1, 0xb7, 0x8f, 0x6f,
+    0xa0, 0x67, 0xa8, 0x8f, 0x31, 0x63, 0xf5, 0xee, 0xe0, 0xb6, 0x40, 0x3f,
+    0x2f, 0x63, 0xaf, 0xd0, 0x2d, 0xbe, 0x21, 0xc6, 0x0c, 0xe3, 0x13, 0x19,
+    0xea, 0x13, 0x14, 0x0a, 0x76, 0x65, 0xa7, 0x19, 0x78, 0x35, 0xc4, 0x5e,
+    0x81, 0xc1, 0xeb, 0x02, 0xd8, 0x73, 0x7e, 0x41, 0xec, 0x21, 0x90, 0x2f,
+    0x7b, 0xd7, 0x86, 0x30, 0x5f, 0xdf, 0x8d, 0x9e, 0x41, 0x72, 0x0c, 0xef,
+    0x6b, 0x2f, 0x0c, 0x29, 0x04, 0xec, 0xc0, 0xab, 0xc1, 0x2e, 0x83, 0xed,
+    0x03, 0x64, 0xc5, 0x69, 0x05, 0x2c, 0x1c, 0x62, 0xf9, 0x2d, 0xb2, 0x8b,
+    0x60, 0x83, 0x90, 0xd2, 0x19, 0xb6, 0xee, 0x2c, 0x94, 0x55, 0x05, 0xaf,
+    0x24, 0x7b, 0x0a, 0x66, 0x09, 0x8f, 0xc2, 0x7d, 0x59, 0x26, 0xa0, 0x2a,
+    0xc8, 0xed, 0x10, 0x33, 0xa0, 0x04, 0xa4, 0x2a, 0x70, 0x47, 0x11, 0xe1,
+    0xc0, 0x0e, 0xb7, 0x10, 0xd9, 0x6f, 0x79, 0xdd, 0xda, 0x99, 0x82, 0xdc,
+    0x07, 0x33, 0xe3, 0x9c, 0xef, 0xd0, 0x4e, 0x2e, 0xdd, 0xb9, 0x39, 0x30,
+    0x48, 0xd1, 0x38, 0x35, 0xe0, 0x3e, 0x2b, 0x22, 0xb2, 0xdc, 0xb8, 0x79,
+    0x70, 0x8a, 0x92, 0x8b, 0x14, 0xe4, 0xad, 0xec, 0x28, 0x6f, 0x35, 0xc1,
+    0x41, 0x8c, 0xef, 0xd8, 0x59, 0x39, 0x33, 0xe5, 0x0c, 0x84, 0x82, 0xc1,
+    0xb4, 0x17, 0x0d, 0x4f, 0xc9, 0xaa, 0x87, 0x52, 0x01, 0xa9, 0x06, 0xd8,
+    0xc1, 0x05, 0x06, 0xb9, 0x92, 0x41, 0x8f, 0xca, 0x85, 0x8a, 0x01, 0x14,
+    0x62, 0x64, 0x85, 0xb4, 0xcb, 0x30, 0xbc, 0x80, 0x43, 0x1a, 0x0e, 0xfd,
+    0x91, 0xb3, 0xa0, 0x49, 0x5c, 0xf6, 0xf2, 0x17, 0x86, 0x0a, 0x0a, 0x57,
+    0xce, 0x18, 0x0e, 0x2b, 0x3b, 0x15, 0x4e, 0x36, 0x43, 0x84, 0xa9, 0x90,
+    0x09, 0x88, 0x64, 0xc3, 0xa2, 0x30, 0xc6, 0xa3, 0xcc, 0x04, 0x27, 0xb9,
+    0xb2, 0xc3, 0xdf, 0x5f, 0x10, 0x31, 0x87, 0x04, 0x6b, 0xa7, 0x15, 0x83,
+    0x34, 0x48, 0x2e, 0x79, 0x7c, 0xbc, 0x41, 0x7a, 0x55, 0x07, 0xba, 0xf0,
+    0x29, 0x0c, 0x2e, 0xed, 0xb1, 0xcc, 0x18, 0xb4, 0x44, 0xbc, 0xee, 0xd8,
+    0xd5, 0xd8, 0x2e, 0xa6, 0x80, 0xb0, 0x3c, 0xf8, 0x68, 0xcb, 0xb6, 0x95,
+    0xdb, 0x7d, 0xb1, 0xab, 0x59, 0x19, 0xc2, 0xa8, 0xdb, 0x41, 0x7d, 0xc9,
+    0x65, 0xa3, 0x3d, 0x53, 0x4c, 0x6f, 0x73, 0x8f, 0xb5, 0x53, 0x9d, 0xd3,
+    0xe5, 0xb1, 0xce, 0x84, 0x95, 0xc8, 0xa0, 0x5c, 0xe6, 0x94, 0xc3, 0x11,
+    0x21, 0x2c, 0x7b, 0x5e, 0x16, 0x20, 0xcd, 0xc2, 0x55, 0x5a, 0x47, 0x65,
+    0xc7, 0xe0, 0x1d, 0x90, 0x53, 0x1c, 0xd2, 0x9f, 0x11, 0xb5, 0x83, 0x71,
+    0x8b, 0xd5, 0xe3, 0x88, 0x62, 0x01, 0xf2, 0xc6, 0x2b, 0x17, 0xd8, 0xdd,
+    0x68, 0xc5, 0x39, 0xfa, 0x8b, 0xe1, 0x66, 0x8f, 0xb1, 0x9e, 0xf3, 0x80,
+    0x04, 0x47, 0xf0, 0xae, 0x87, 0x3f, 0x22, 0xb9, 0x1d, 0x87, 0x5b, 0x16,
+    0x26, 0x0f, 0x7c, 0xdd, 0x82, 0xdb, 0xd9, 0x18, 0x9c, 0xfa, 0x3c, 0x0a,
+    0x77, 0x9c, 0x83, 0x74, 0x22, 0x9d, 0x6d, 0xde, 0xaf, 0x0b, 0x9a, 0xd6,
+    0xb2, 0x74, 0x43, 0x4d, 0x71, 0x40, 0x1c, 0x05, 0x48, 0xe2, 0x4f, 0x5b,
+    0xca, 0x25, 0x34, 0x42, 0x2d, 0xe1, 0xa6, 0xa3, 0x57, 0x9a, 0x2c, 0x41,
+    0x1a, 0x8a, 0xed, 0x25, 0x80, 0xe8, 0x11, 0xb5, 0xe8, 0x07, 0xb7, 0xea,
+    0x1e, 0xdb, 0xc4, 0xed, 0x35, 0xb9, 0x63, 0x41, 0x2c, 0x08, 0x28, 0x08,
+    0x8b, 0x49, 0xae, 0xd2, 0x80, 0x64, 0xf4, 0xf5, 0x7d, 0x4c, 0x74, 0xf0,
+    0x08, 0xd7, 0x3b, 0xc7, 0x9c, 0x37, 0x69, 0x90, 0x0c, 0x11, 0xa5, 0x54,
+    0xe0, 0xd1, 0x3a, 0x54, 0x65, 0x48, 0x7e, 0xac, 0x31, 0x9f, 0xe8, 0xa0,
+    0xb3, 0xc0, 0x29, 0x73, 0x99, 0x06, 0x70, 0x00, 0x94, 0xb1, 0x65, 0x37,
+    0x6a, 0x4b, 0xcf, 0xae, 0x21, 0x0c, 0xae, 0xfd, 0x15, 0x36, 0x2f, 0xa4,
+    0x70, 0xaf, 0x69, 0xf6, 0xae, 0x73, 0x73, 0x86, 0xc7, 0xab, 0x1a, 0xb3,
+    0xdd, 0xeb, 0xd8, 0x9a, 0xe5, 0x81, 0x2a, 0x8f, 0x4a, 0x5a, 0x3e, 0xc8,
+    0xb7, 0x8d, 0x6b, 0xe9, 0xd9, 0xdf, 0xac, 0x26, 0x29, 0x6d, 0x9b, 0x31,
+    0xd2, 0x60, 0x79, 0x1b, 0xe9, 0x90, 0x7d, 0x12, 0x89, 0x95, 0x68, 0xf2,
+    0x67, 0xf4, 0x67, 0x6e, 0xb6, 0x8f, 0x35, 0xc9, 0x76, 0xae, 0xdb, 0xc5,
+    0x05, 0x3a, 0x29, 0xf5, 0x3d, 0x42, 0x6c, 0xc7, 0x8d, 0x35, 0x74, 0xc8,
+    0x54, 0x3e, 0x4d, 0xfd, 0xf8, 0xd1, 0x4a, 0xd2, 0x37, 0xa0, 0x03, 0x6d,
+    0x32, 0xa3, 0x3d, 0x6d, 0xa7, 0x07, 0x25, 0x77, 0x19, 0xc7, 0xf7, 0xd8,
+    0xc0, 0x83, 0xcd, 0x6f, 0x60, 0x36, 0x95, 0xf0, 0x5b, 0x33, 0xaf, 0x69,
+    0xd1, 0x02, 0x86, 0x54, 0x5e, 0xaf, 0x9a, 0xfd, 0x80, 0x6e, 0x28, 0x1e,
+    0x3a, 0xb5, 0xea, 0x37, 0xbf, 0xdb, 0x7c, 0x80, 0x24, 0xe6, 0x75, 0xd7,
+    0x7c, 0x3a, 0xa8, 0x90, 0xcc, 0x18, 0xcd, 0xea, 0x08, 0xc9, 0x0b, 0x0d,
+    0xe4, 0xe6, 0xb0, 0x92, 0xa9, 0x59, 0x43, 0x7b, 0x11, 0x78, 0xc0, 0x99,
+    0xda, 0x74, 0xf0, 0xa3, 0xdf, 0x1b, 0xf7, 0xd1, 0x02, 0xa4, 0xf3, 0xf7,
+    0x57, 0xf4, 0x6c, 0x03, 0xd5, 0x3c, 0x4d, 0x81, 0x3a, 0x11, 0x9d, 0x5d,
+    0x17, 0x66, 0x2b, 0xc0, 0x74, 0x16, 0xac, 0xdc, 0x5b, 0x8b, 0xb1, 0x1e,
+    0xdc, 0x94, 0x14, 0x1d, 0x33, 0xcd, 0xa5, 0x2d, 0xf4, 0x85, 0x22, 0xbc,
+    0x36, 0x81, 0x6d, 0xd6, 0xce, 0xc7, 0xe1, 0x6a, 0xd8, 0x4a, 0xe5, 0xe3,
+    0x84, 0x6e, 0xbe, 0x0f, 0x82, 0x89, 0x89, 0x9e, 0x07, 0x7c, 0xf6, 0x1c,
+    0x10, 0x35, 0xc5, 0xd7, 0x72, 0x55, 0xc9, 0x9c, 0xa7, 0xe4, 0x20, 0xe3,
+    0x96, 0x6a, 0xf7, 0x62, 0x65, 0xb6, 0xc9, 0x09, 0x85, 0x92, 0xdb, 0x4c,
+    0x0d, 0xeb, 0x4e, 0x2a, 0x99, 0x9c, 0xe5, 0xca, 0xa3, 0xab, 0x4e, 0x3c,
+    0x3b, 0x53, 0x06, 0x52, 0xb7, 0xb5, 0x08, 0x61, 0x6f, 0x74, 0x64, 0x3b,
+    0xfb, 0x37, 0xc5, 0xd6, 0xf6, 0x07, 0xda, 0x4a, 0x94, 0x40, 0xc1, 0x83,
+    0x91, 0x28, 0x22, 0xdb, 0x05, 0xf6, 0xba, 0x24, 0xee, 0x51, 0x69, 0x92,
+    0x61, 0x4a, 0x87, 0xad, 0x81, 0x1a, 0x6f, 0x86, 0x59, 0xb3, 0x33, 0x2c,
+    0xa3, 0x0d, 0x96, 0x37, 0x5d, 0x56, 0x2f, 0x56, 0xd6, 0x5a, 0x69, 0xf1,
+    0x40, 0xdf, 0x91, 0xbe, 0x34, 0x05, 0x0a, 0x1c, 0x41, 0xd6, 0x88, 0xe4,
+    0x85, 0x94, 0x46, 0xc9, 0x39, 0xa2, 0xee, 0x7a, 0xd1, 0x4f, 0x5c, 0xdb,
+    0xfb, 0xde, 0x40, 0x40, 0x0b, 0x5f, 0x49, 0x35, 0xe4, 0x62, 0x03, 0x34,
+    0xb3, 0xb6, 0xf2, 0x43, 0x95, 0xf4, 0x80, 0x47, 0xa3, 0x85, 0x0b, 0x77,
+    0x69, 0x0f, 0x35, 0xc2, 0x05, 0xa8, 0x86, 0x7a, 0xac, 0x92, 0x30, 0x4f,
+    0x72, 0x88, 0x8b, 0xea, 0x02, 0xe8, 0xdb, 0xc2, 0x3e, 0xb8, 0x98, 0x5a,
+    0x74, 0x2a, 0x2d, 0xde, 0x5e, 0x31, 0x76, 0xdd, 0xfd, 0xb5, 0x6f, 0xb9,
+    0x84, 0x80, 0xa4, 0x7d, 0x6d, 0x80, 0x8c, 0x9e, 0xbf, 0x7a, 0x4f, 0x94,
+    0x71, 0x54, 0x6c, 0xc8, 0xbe, 0xf9, 0xdf, 0xfe, 0x90, 0x27, 0x00, 0x26,
+    0xbd, 0xf5, 0x7a, 0x50, 0x43, 0x49, 0x62, 0x8e, 0x4c, 0x1a, 0x5e, 0x21,
+    0xf0, 0xb1, 0x60, 0x46, 0xb9, 0xc7, 0x30, 0xef, 0x14, 0x91, 0xb3, 0x72,
+    0x0e, 0x95, 0xf5, 0x40, 0x35, 0xb9, 0xe4, 0xec, 0x5f, 0xff, 0xca, 0xa5,
+    0xb9, 0x5b, 0xc8, 0xe4, 0xcb, 0xfe, 0xd2, 0xdd, 0x20, 0x35, 0xfc, 0x89,
+    0x09, 0x80, 0x93, 0xee, 0xa2, 0x9e, 0x10, 0x28, 0x92, 0xa2, 0xb3, 0x89,
+    0xaa, 0xa6, 0xac, 0x8e, 0xc2, 0xbb, 0x66, 0x7d, 0x9f, 0x7b, 0x68, 0x19,
+    0x1f, 0xa0, 0xd6, 0xaf, 0xf5, 0x13, 0x37, 0x55, 0xc4, 0x0c, 0xb5, 0x85,
+    0x19, 0xa5, 0x68, 0x3c, 0x0e, 0x59, 0xef, 0x36, 0xe8, 0x37, 0xe3, 0xca,
+    0xd6, 0x12, 0x4b, 0x52, 0x10, 0x15, 0x8b, 0x1b, 0xa8, 0x7c, 0xc6, 0x39,
+    0x72, 0xfc, 0xf6, 0x74, 0x95, 0x25, 0xca, 0xac, 0x66, 0x85, 0x34, 0x84,
+    0x0f, 0x5d, 0x5e, 0x9a, 0x3d, 0xfc, 0x34, 0xf2, 0xfc, 0xfd, 0x03, 0x59,
+    0x1a, 0xcc, 0x8f, 0x09, 0x78, 0x77, 0x6f, 0x10, 0xe5, 0x50, 0x46, 0xfc,
+    0x83, 0x0f, 0xa7, 0xa7, 0x07, 0xcf, 0x5c, 0x78, 0x66, 0x56, 0xd7, 0x5b,
+    0x18, 0x36, 0x6a, 0x48, 0x54, 0xc5, 0xdc, 0x61, 0x24, 0x01, 0x75, 0x7a,
+    0x36, 0xc1, 0xcc, 0x33, 0x93, 0x27, 0xf8, 0x87, 0xae, 0x5e, 0xe8, 0x66,
+    0x47, 0x05, 0x82, 0x14, 0x8b, 0x45, 0xbf, 0xe9, 0x99, 0x9b, 0x06, 0xc9,
+    0xd1, 0x53, 0x9b, 0x63, 0xef, 0x7f, 0x72, 0x24, 0x5d, 0xbb, 0x09, 0xde,
+    0x5e, 0x96, 0x1a, 0x0e, 0xf8, 0xc7, 0x62, 0x51, 0x80, 0x04, 0x4a, 0x3a,
+    0xbe, 0x48, 0xcf, 0x1b, 0x83, 0xf2, 0xb9, 0x31, 0xc0, 0xf6, 0x2e, 0x76,
+    0x8d, 0x11, 0xda, 0x0d, 0x26, 0xf9, 0x51, 0xa6, 0x39, 0x74, 0x61, 0x92,
+    0xec, 0x39, 0xc2, 0x0c, 0x97, 0xe0, 0xcb, 0xa5, 0x52, 0xe1, 0x17, 0x18,
+    0x0a, 0xa2, 0x54, 0x10, 0x8d, 0x26, 0x26, 0x46, 0x0f, 0x48, 0x24, 0x0c,
+    0x8e, 0x9d, 0x34, 0x73, 0xd5, 0xb5, 0x7b, 0x15, 0x4b, 0xc4, 0x8a, 0xf5,
+    0x96, 0x0a, 0xcc, 0x9e, 0x22, 0xcc, 0x13, 0xb3, 0x5d, 0xc5, 0xa9, 0xd2,
+    0x86, 0xa2, 0xf6, 0x37, 0xb9, 0xfe, 0x5d, 0x0a, 0x19, 0x5b, 0xca, 0x8d,
+    0x4e, 0x10, 0x91, 0x88, 0xf2, 0x40, 0x34, 0x7a, 0x98, 0x7f, 0xc2, 0x56,
+    0x67, 0xa5, 0x6e, 0x7e, 0xcc, 0x5b, 0xfd, 0x21, 0x3c, 0x8e, 0xcf, 0x50,
+    0x20, 0xeb, 0x77, 0x14, 0xa4, 0x8c, 0xba, 0x94, 0xf3, 0x67, 0x57, 0x30,
+    0x7c, 0x1b, 0x9c, 0x06, 0x6a, 0xe8, 0x5b, 0xee, 0xe5, 0x2e, 0x89, 0xd4,
+    0x8d, 0xe9, 0xd2, 0xc6, 0x24, 0xfb, 0xd0, 0x77, 0x89, 0xe6, 0xbe, 0x26,
+    0xe4, 0xc2, 0xab, 0x39, 0x45, 0x53, 0x6f, 0x6f, 0xaa, 0xfe, 0x42, 0x54,
+    0x68, 0xe6, 0xa8, 0xed, 0xf8, 0xc4, 0x5f, 0xaa, 0x48, 0xbe, 0xad, 0xa8,
+    0x03, 0x14, 0x4c, 0x1c, 0x60, 0x54, 0xf3, 0xea, 0x91, 0x06, 0x2a, 0x80,
+    0x57, 0x26, 0x65, 0xd0, 0x1a, 0x81, 0xa0, 0x88, 0x91, 0x2f, 0x93, 0x1d,
+    0xc7, 0xe4, 0xa6, 0xf4, 0x75, 0xcd, 0x13, 0x1d, 0x06, 0x34, 0xab, 0xb1,
+    0x73, 0x56, 0x6a, 0xc3, 0x14, 0xa5, 0xb4, 0x97, 0xf8, 0x36, 0xa8, 0xc5,
+    0xad, 0x3c, 0xd2, 0x58, 0xd7, 0x44, 0xa1, 0xa9, 0x29, 0xdf, 0xea, 0x9f,
+    0x75, 0xe1, 0x6d, 0xf4, 0xc0, 0xc8, 0xfb, 0x36, 0xd6, 0x90, 0x95, 0x97,
+    0x2c, 0x34, 0x11, 0x44, 0xd1, 0xba, 0x35, 0x51, 0x63, 0xc8, 0x81, 0xf7,
+    0x25, 0x99, 0xf7, 0xf9, 0x4e, 0x1d, 0x1b, 0xa8, 0xde, 0x13, 0xbb, 0x1b,
+    0xf5, 0xd7, 0xbf, 0x5a, 0x34, 0x4e, 0x1d, 0xc0, 0x1f, 0xea, 0xd6, 0x38,
+    0x44, 0x1d, 0x9b, 0xb7, 0xed, 0xcb, 0x0b, 0x73, 0x5a, 0xf1, 0x92, 0x78,
+    0x8c, 0xcf, 0xab, 0x68, 0x2d, 0x11, 0x20, 0x9a, 0xc3, 0xd2, 0x36, 0x4e,
+    0x1b, 0x1e, 0x47, 0x44, 0x3a, 0xc9, 0x98, 0xfb, 0xe4, 0x8f, 0x2c, 0x94,
+    0x14, 0x12, 0xf3, 0x8a, 0x17, 0x8b, 0x0a, 0x68, 0x8b, 0x2c, 0x15, 0x78,
+    0x3c, 0x25, 0x44, 0xb7, 0x68, 0xa3, 0x7c, 0x71, 0xf6, 0x31, 0x7b, 0x53,
+    0xf2, 0x8d, 0xcf, 0xd6, 0x4b, 0x1a, 0x3b, 0x25, 0xb4, 0x5c, 0x3e, 0x18,
+    0x70, 0xf4, 0xab, 0x4e, 0xb0, 0x87, 0x26, 0x68, 0x82, 0x87, 0x87, 0x6a,
+    0xbf, 0x4f, 0xdc, 0xbd, 0xda, 0xfa, 0xae, 0x14, 0xd3, 0xfb, 0x86, 0x9b,
+    0xe4, 0x39, 0xb1, 0x73, 0xd5, 0xac, 0xd0, 0x56, 0x4d, 0x97, 0xbf, 0xe3,
+    0x3d, 0x07, 0x2b, 0x93, 0x5e, 0x8f, 0x6c, 0x4d, 0x9b, 0x18, 0x4f, 0x24,
+    0x24, 0xe1, 0x33, 0xea, 0xf4, 0x9e, 0xfc, 0x67, 0x1b, 0x19, 0x4b, 0x52,
+    0x1c, 0xee, 0xb5, 0xd9, 0x3c, 0x61, 0x7c, 0xb1, 0x07, 0xec, 0x36, 0x19,
+    0xe8, 0x30, 0xbe, 0xf1, 0x77, 0x89, 0x23, 0x15, 0xbb, 0xed, 0x96, 0xd5,
+    0x5c, 0x89, 0x7f, 0xde, 0x76, 0x4e, 0x75, 0x50, 0x3e, 0xe3, 0xdf, 0xd9,
+    0xc4, 0xbf, 0x58, 0x7c, 0xfa, 0x68, 0xf9, 0x90, 0xf4, 0x96, 0x5f, 0x75,
+    0x54, 0x4e, 0x43, 0xa2, 0xb5, 0x06, 0x2b, 0xc6, 0x50, 0x80, 0xff, 0xda,
+    0x9f, 0xf9, 0x2c, 0xec, 0xe7, 0xe1, 0x3b, 0x84, 0xc3, 0xaa, 0x38, 0x57,
+    0x19, 0x51, 0xbb, 0x8b, 0x96, 0x34, 0x2f, 0xb6, 0xf6, 0xf3, 0x59, 0xa2,
+    0x05, 0xa9, 0xdb, 0x3c, 0x7e, 0x2c, 0x5e, 0x2c, 0x35, 0xd0, 0x74, 0x81,
+    0x86, 0x38, 0x7f, 0xf3, 0xb1, 0xc9, 0xae, 0x1f, 0x69, 0x20, 0x17, 0xfe,
+    0x01, 0x15, 0xa1, 0xfe, 0x9e, 0xfa, 0xf1, 0xea, 0x4f, 0xff, 0x8a, 0x30,
+    0x84, 0xb7, 0x1e, 0x1e, 0x2c, 0xb6, 0x44, 0xd6, 0xff, 0x53, 0x97, 0x6c,
+    0x10, 0x2a, 0x1a, 0xea, 0xd1, 0xed, 0x04, 0xc0, 0xb5, 0xa2, 0x44, 0x79,
+    0xf7, 0xdd, 0x73, 0xb0, 0xc2, 0x5e, 0x97, 0x4c, 0x0c, 0xf9, 0x25, 0x4d,
+    0xcf, 0x46, 0x68, 0x3e, 0x08, 0x0d, 0xd2, 0xba, 0x61, 0x76, 0x64, 0x71,
+    0x56, 0x77, 0x30, 0x32, 0x99, 0x0e, 0xc5, 0x37, 0xa1, 0x69, 0x75, 0xa9,
+    0x5d, 0xa7, 0xa0, 0x66, 0xc4, 0xd3, 0x9e, 0xd8, 0xcc, 0x34, 0x9f, 0x16,
+    0x6f, 0xad, 0x47, 0xd7, 0x47, 0x12, 0x64, 0x09, 0x55, 0xc8, 0x15, 0xea,
+    0x97, 0xdc, 0x13, 0xdd, 0x37, 0x61, 0xb0, 0x51, 0xa7, 0xf6, 0x9c, 0x79,
+    0x53, 0x72, 0xb2, 0x8f, 0x08, 0x80, 0xa2, 0x87, 0x05, 0xac, 0x71, 0x0c,
+    0x81, 0x41, 0xbf, 0x41, 0x71, 0xc4, 0x47, 0x3c, 0x40, 0x4a, 0x9f, 0xbf,
+    0x6e, 0x8a, 0x9f, 0xa1, 0x3c, 0xd0, 0x4e, 0xcd, 0x6c, 0x8c, 0x72, 0x8c,
+    0xa3, 0x19, 0xb1, 0xe3, 0x8d, 0x71, 0x67, 0x9f, 0xfc, 0x54, 0x16, 0x10,
+    0xb2, 0x8a, 0x54, 0x6c, 0xb0, 0x20, 0xd2, 0xa6, 0x5a, 0x20, 0x60, 0xdb,
+    0xd5, 0x47, 0xc5, 0x91, 0xab, 0x06, 0x2c, 0xf5, 0x45, 0xf8, 0x77, 0xe5,
+    0xbd, 0xb2, 0x0a, 0xc0, 0xdb, 0x1a, 0x91, 0xcf, 0x3f, 0x9d, 0x2e, 0x6b,
+    0x6c, 0x96, 0x54, 0xd2, 0xc6, 0xd6, 0x33, 0x0a, 0xf0, 0x97, 0x62, 0xb4,
+    0xda, 0x11, 0xcc, 0xb7, 0x55, 0x56, 0xe5, 0x96, 0x4e, 0x30, 0xe5, 0xa6,
+    0x0a, 0x4d, 0xe0, 0x0f, 0x13, 0xc5, 0x13, 0x80, 0x44, 0x1a, 0x76, 0xdd,
+    0x48, 0xdc, 0xab, 0x8b, 0x3e, 0x65, 0x4b, 0x24, 0x78, 0xc0, 0x2e, 0xab,
+    0x60, 0xf6, 0x03, 0x2e, 0xf8, 0x48, 0x88, 0x8b, 0x46, 0x37, 0x97, 0x48,
+    0x13, 0xcb, 0x4c, 0x04, 0x4b, 0x28, 0xda, 0xff, 0x48, 0x6f, 0xfa, 0x83,
+    0xa1, 0x4b, 0x77, 0xae, 0x2f, 0xd3, 0xd5, 0x60, 0x85, 0xb8, 0xd7, 0xbd,
+    0xb8, 0xf4, 0xe0, 0x3f, 0x2c, 0x1d, 0xdf, 0xd8, 0x7c, 0xfd, 0x92, 0x06,
+    0xe6, 0x1d, 0xf7, 0x06, 0x14, 0xb9, 0x2d, 0xf0, 0x94, 0x34, 0x1c, 0xf8,
+    0x6a, 0x5f, 0xa8, 0x42, 0xad, 0xf0, 0xd2, 0x30, 0x07, 0x9e, 0xa1, 0x79,
+    0x01, 0x42, 0xf9, 0x22, 0x50, 0xd2, 0x5d, 0x2d, 0x05, 0x59, 0x8a, 0x43,
+    0x6d, 0xf3, 0x5a, 0x39, 0x44, 0x06, 0x64, 0x8a, 0x89, 0xba, 0x25, 0x25,
+    0xd8, 0xd6, 0x67, 0xcf, 0xd1, 0xf1, 0xdd, 0xac, 0x4a, 0x70, 0x08, 0x90,
+    0xf1, 0xde, 0xe6, 0xec, 0xb4, 0xf2, 0x6b, 0xe9, 0xf3, 0xde, 0x8b, 0x7b,
+    0x77, 0xed, 0x93, 0xff, 0xb6, 0x0e, 0xcc, 0x3a, 0x25, 0x14, 0xf8, 0x1f,
+    0x6d, 0x8b, 0x56, 0x83
+};
+
+static const fsw_u8 stream_fixed[2243] = {
+    0x78, 0x01, 0x33, 0x31, 0xb0, 0x34, 0x53, 0x28, 0xcf, 0xcc, 0x4b, 0xc9,
+    0x2f, 0x57, 0x48, 0x49, 0x4d, 0xcb, 0x49, 0x2c, 0x49, 0x55, 0xe0, 0x32,
+    0x01, 0x09, 0x56, 0xe5, 0x64, 0x26, 0x29, 0x24, 0x95, 0x14, 0xa5, 0x15,
+    0x2b, 0x70, 0x71, 0xa5, 0x56, 0x94, 0xa4, 0xe6, 0x95, 0x40, 0xb9, 0x60,
+    0x69, 0x2e, 0x98, 0x6a, 0x18, 0x9d, 0x94, 0x93, 0x9f, 0x9c, 0x0d, 0x91,
+    0xcb, 0xcc, 0x83, 0x08, 0x41, 0xcd, 0x85, 0xe8, 0xca, 0x28, 0x4d, 0x4b,
+    0xcb, 0x4d, 0xcc, 0x83, 0xd3, 0x30, 0x7d, 0x08, 0xcb, 0x50, 0x2c, 0x81,
+    0x72, 0x60, 0xaa, 0xa1, 0x5c, 0x2e, 0x34, 0x3e, 0x94, 0x32, 0x41, 0xf2,
+    0x05, 0xcc, 0x72, 0x18, 0x0d, 0xd7, 0x02, 0x56, 0x04, 0xf3, 0x10, 0x8a,
+    0xed, 0x5c, 0x10, 0xb7, 0x43, 0x48, 0xb0, 0x53, 0xd0, 0x1d, 0x09, 0x91,
+    0x82, 0x19, 0x09, 0x13, 0x85, 0xf1, 0xc1, 0x86, 0x40, 0x9d, 0x82, 0xa2,
+    0x1d, 0x46, 0x73, 0x41, 0x6d, 0x40, 0x71, 0x0a, 0x8c, 0x43, 0x28, 0xe0,
+    0xa0, 0x1c, 0x64, 0x4b, 0xc0, 0x6c, 0xb8, 0xdb, 0x10, 0x91, 0x82, 0xa2,
+    0x0f, 0x66, 0x18, 0x92, 0x3c, 0x86, 0x3f, 0x91, 0xc3, 0x1d, 0xd9, 0x04,
+    0x2e, 0x14, 0xab, 0xd1, 0x43, 0x03, 0xc6, 0x87, 0x24, 0x11, 0xb0, 0x69,
+    0xc8, 0x66, 0x20, 0x59, 0x05, 0x4f, 0x52, 0xb0, 0xb8, 0x05, 0x8b, 0x62,
+    0x75, 0x26, 0x54, 0x10, 0x2d, 0xde, 0xd1, 0x64, 0xe1, 0x91, 0x09, 0x8f,
+    0x40, 0x58, 0xc2, 0xe0, 0x42, 0x58, 0x0d, 0x93, 0x02, 0x3b, 0x0f, 0x35,
+    0x14, 0x50, 0x9c, 0x01, 0xe5, 0xa0, 0x27, 0x18, 0x14, 0x95, 0x5c, 0xa8,
+    0xa2, 0xf0, 0x44, 0xc5, 0x05, 0x0d, 0x21, 0x2e, 0xb0, 0x25, 0x88, 0x34,
+    0x0c, 0x53, 0x80, 0x14, 0x34, 0x48, 0xe1, 0x8f, 0x22, 0x0b, 0xf5, 0x12,
+    0x72, 0xf4, 0x62, 0xb7, 0x0c, 0x35, 0xa1, 0x20, 0xa7, 0x33, 0x2e, 0xa4,
+    0xa8, 0xc4, 0x9b, 0x38, 0x21, 0x06, 0xa2, 0x44, 0x2a, 0x2c, 0x12, 0x50,
+    0x52, 0x36, 0xcc, 0x2a, 0xb4, 0x88, 0x47, 0x8d, 0x4c, 0xa8, 0x24, 0x72,
+    0xda, 0xc1, 0x9e, 0x5f, 0x50, 0x92, 0x39, 0x2c, 0xc0, 0x10, 0x61, 0xc5,
+    0x85, 0xe2, 0x21, 0x78, 0xca, 0xc3, 0x16, 0x37, 0x28, 0xb9, 0x0a, 0x23,
+    0x5c, 0xb0, 0x15, 0x18, 0xc8, 0x61, 0x8f, 0x66, 0x18, 0x17, 0xaa, 0x8d,
+    0xe8, 0x6e, 0x47, 0x53, 0x8d, 0xc6, 0x45, 0x2b, 0x80, 0xd0, 0xcc, 0xc0,
+    0x16, 0xb6, 0x10, 0xbf, 0x22, 0x67, 0x5f, 0x34, 0xd5, 0x90, 0x34, 0x84,
+    0x16, 0xba, 0x18, 0xc5, 0x17, 0x3c, 0x6d, 0x20, 0x0c, 0x45, 0x2b, 0xb7,
+    0x91, 0xc5, 0x10, 0xa1, 0x8e, 0x94, 0xe5, 0xd1, 0x32, 0x13, 0x9a, 0x8d,
+    0x5c, 0xa8, 0xb1, 0x8c, 0x64, 0x0f, 0x52, 0x12, 0x42, 0x33, 0x1e, 0x6b,
+    0x14, 0xa0, 0x78, 0x0b, 0xbd, 0x48, 0xc3, 0x2c, 0xec, 0xb8, 0xd0, 0x33,
+    0x20, 0x92, 0x75, 0x28, 0xf9, 0x19, 0xa5, 0xd8, 0x41, 0x8b, 0x2d, 0x48,
+    0x39, 0x8e, 0x52, 0xb0, 0x40, 0xd3, 0x1b, 0xd6, 0x74, 0x81, 0xa6, 0x1b,
+    0xd5, 0xe1, 0x48, 0xe5, 0x17, 0x17, 0xb2, 0xf1, 0x68, 0x51, 0x8f, 0x54,
+    0x41, 0x42, 0x45, 0xd0, 0xb3, 0x1e, 0x7a, 0x15, 0x89, 0x9c, 0x71, 0x90,
+    0xed, 0x42, 0x4b, 0x0f, 0xd8, 0xb2, 0x05, 0x72, 0x66, 0xe3, 0x42, 0x0f,
+    0x7d, 0x2c, 0x05, 0xae, 0xa6, 0xe3, 0xd0, 0x81, 0x23, 0xd3, 0xcf, 0xbd,
+    0x6c, 0x50, 0xaf, 0xbd, 0x09, 0xc9, 0xb8, 0x7b, 0x2c, 0xbb, 0x63, 0x04,
+    0x50, 0x43, 0xbc, 0xb6, 0x1d, 0xe1, 0x29, 0xb4, 0x7c, 0x40, 0xc0, 0x69,
+    0xb7, 0xa4, 0x45, 0x60, 0x0c, 0x0b, 0xc3, 0xc1, 0xd6, 0x09, 0x18, 0xd6,
+    0x2d, 0xea, 0x41, 0xdf, 0xb8, 0x1d, 0xe8, 0xb6, 0x4d, 0x47, 0xab, 0xe2,
+    0x65, 0xdd, 0x61, 0x4b, 0x64, 0x1f, 0x2a, 0x6d, 0x9b, 0x71, 0x7b, 0x94,
+    0x98, 0x81, 0xda, 0x7d, 0x57, 0x6d, 0xcc, 0x97, 0x8a, 0xbc, 0x3c, 0x27,
+    0xa0, 0x60, 0x94, 0x02, 0x53, 0xc3, 0xaa, 0x50, 0x81, 0x89, 0x3e, 0x44,
+    0x2d, 0x32, 0x86, 0x7c, 0x5b, 0xc3, 0x67, 0x58, 0x03, 0x56, 0x5f, 0x8f,
+    0xd5, 0xa1, 0xa3, 0x04, 0x12, 0x01, 0x4b, 0x63, 0xa1, 0xa7, 0x1e, 0x9c,
+    0xdc, 0x12, 0x37, 0xcc, 0xc8, 0xf8, 0x83, 0x30, 0xef, 0x15, 0x1f, 0x69,
+    0x55, 0x5e, 0x57, 0xbf, 0xd5, 0x53, 0xa2, 0x9b, 0xd6, 0x34, 0x24, 0x7b,
+    0xcd, 0x89, 0x0b, 0xcb, 0xa1, 0x39, 0xa4, 0x70, 0xe4, 0x63, 0x30, 0x34,
+    0x8b, 0x69, 0x3b, 0x36, 0xce, 0xcc, 0x61, 0x7f, 0xfa, 0xce, 0x70, 0xc2,
+    0x55, 0x4e, 0xd2, 0xfc, 0x61, 0xbf, 0x87, 0x3b, 0x09, 0xa9, 0x89, 0x06,
+    0x6b, 0xa0, 0xc1, 0xeb, 0x68, 0xed, 0x28, 0xeb, 0x7b, 0xa3, 0xd8, 0xda,
+    0x2b, 0x6a, 0x97, 0x2f, 0xeb, 0xcc, 0xa7, 0x64, 0x51, 0x90, 0x8c, 0xdb,
+    0x2e, 0xe2, 0xb8, 0x9a, 0x72, 0x6c, 0x21, 0x79, 0x2b, 0x62, 0xb8, 0x23,
+    0x68, 0x19, 0x68, 0xb9, 0xba, 0x31, 0xd1, 0xda, 0x21, 0x6f, 0x06, 0xd1,
+    0x74, 0x37, 0xd9, 0x03, 0x3c, 0x68, 0xf3, 0x1b, 0x68, 0x63, 0x2a, 0x65,
+    0xe7, 0x9d, 0x0f, 0x30, 0x8f, 0x14, 0x42, 0xf0, 0xda, 0x89, 0xdb, 0xee,
+    0x37, 0x46, 0x36, 0x39, 0x78, 0xc2, 0xe9, 0x23, 0xef, 0x6b, 0x10, 0x4a,
+    0x85, 0xa6, 0xc4, 0x1d, 0xa4, 0x0e, 0x9f, 0xf2, 0x1d, 0x19, 0x9e, 0xb0,
+    0x11, 0x52, 0x46, 0x0c, 0x74, 0x42, 0xa1, 0x38, 0xd1, 0xc0, 0x62, 0x53,
+    0xec, 0xb8, 0xc5, 0x5a, 0x21, 0x2a, 0x12, 0x09, 0xb0, 0x99, 0xda, 0x25,
+    0x50, 0x06, 0xfb, 0x9f, 0x18, 0x79, 0x3a, 0xe0, 0xed, 0xd7, 0xc3, 0xc9,
+    0x43, 0x50, 0x67, 0xae, 0x18, 0xe8, 0x58, 0xa4, 0x43, 0xca, 0x18, 0x74,
+    0xe3, 0xba, 0x30, 0x63, 0xe9, 0x30, 0x9d, 0x05, 0x73, 0xdc, 0x7f, 0x5d,
+    0xf5, 0x04, 0x64, 0x3c, 0xad, 0xb1, 0xcd, 0x2a, 0xe8, 0x77, 0xc9, 0x7b,
+    0x42, 0x74, 0xfc, 0x44, 0x88, 0xb7, 0x6a, 0xef, 0x95, 0x0d, 0x00, 0x3a,
+    0x09, 0x6f, 0x27, 0x90, 0xd8, 0x1f, 0x84, 0x4e, 0x4c, 0x90, 0x0f, 0xd0,
+    0x67, 0xcf, 0xa1, 0x81, 0x3a, 0x33, 0xcd, 0x20, 0xfa, 0xb8, 0xe7, 0xa3,
+    0xe1, 0x43, 0x29, 0xbc, 0xb9, 0x13, 0x73, 0x8c, 0x12, 0x64, 0x34, 0xf1,
+    0xc8, 0x90, 0x43, 0xca, 0x22, 0x0f, 0x17, 0x52, 0x88, 0x03, 0xe0, 0x85,
+    0x07, 0xb1, 0x8b, 0x78, 0x6a, 0x67, 0xf2, 0x8c, 0x38, 0xf4, 0x86, 0x1e,
+    0xe3, 0x8d, 0x6e, 0x90, 0xcc, 0xde, 0x73, 0xcc, 0xd4, 0xbe, 0xff, 0xf7,
+    0x71, 0x0a, 0xa8, 0x7c, 0x01, 0x14, 0x38, 0xd0, 0xe3, 0x15, 0x58, 0x06,
+    0x07, 0x86, 0x44, 0xab, 0x74, 0x9a, 0xc8, 0x4c, 0x0c, 0xf4, 0x6c, 0xc4,
+    0xac, 0x66, 0x70, 0x71, 0x5f, 0x6e, 0xd0, 0xc8, 0x1f, 0xf6, 0x6a, 0xcf,
+    0xc0, 0xd2, 0x94, 0x8e, 0x56, 0xea, 0xde, 0xe0, 0x75, 0x1b, 0x79, 0xd8,
+    0x0c, 0x96, 0xe0, 0x86, 0xd1, 0x68, 0xc4, 0x0c, 0xbf, 0x11, 0x0a, 0x87,
+    0xdc, 0x42, 0xd4, 0xfa, 0xf7, 0xec, 0x83, 0x0b, 0xe1, 0xea, 0x81, 0x40,
+    0x7d, 0xf8, 0x65, 0xa8, 0x82, 0x4d, 0x68, 0x0d, 0x34, 0x95, 0xdf, 0xe7,
+    0x26, 0x5d, 0x1b, 0x39, 0xc4, 0x2d, 0x79, 0xfa, 0x81, 0x2b, 0x23, 0x1d,
+    0xdc, 0xa5, 0x1f, 0x80, 0x15, 0x43, 0x64, 0x17, 0x49, 0x68, 0x2b, 0xc9,
+    0x61, 0xf4, 0xd1, 0x87, 0xd9, 0x23, 0x0f, 0x95, 0x32, 0xec, 0x9a, 0x7f,
+    0x74, 0xe9, 0xa2, 0x6e, 0x7b, 0xc2, 0x74, 0x64, 0x53, 0x57, 0xda, 0xb9,
+    0x21, 0x44, 0x0c, 0xf4, 0x72, 0x19, 0x8a, 0x00, 0x34, 0x8d, 0x6e, 0xdf,
+    0x77, 0x75, 0x50, 0x42, 0xb9, 0xf6, 0xe2, 0x4e, 0x9f, 0xbe, 0x65, 0x3b,
+    0xe8, 0x40, 0x0f, 0xb8, 0x5f, 0x69, 0xec, 0x7b, 0x0e, 0x58, 0x09, 0x35,
+    0x24, 0xe6, 0xc8, 0x86, 0xc6, 0xaa, 0x10, 0x58, 0xb5, 0xa0, 0x32, 0xd0,
+    0x8b, 0x7b, 0x07, 0x78, 0xc5, 0x30, 0xd6, 0x29, 0xa2, 0x00, 0xca, 0x16,
+    0x54, 0x3e, 0x85, 0x16, 0x4d, 0x41, 0x1b, 0x7a, 0xd3, 0xbf, 0x04, 0xbd,
+    0x26, 0x89, 0x52, 0xb4, 0xe3, 0x1c, 0xba, 0x08, 0x16, 0x1a, 0x59, 0xc3,
+    0x06, 0x40, 0x63, 0x32, 0x66, 0x50, 0x4f, 0x08, 0x1c, 0x1d, 0xe8, 0x65,
+    0x23, 0xe4, 0x20, 0x5a, 0x4d, 0x59, 0xcd, 0x86, 0xe9, 0x72, 0x99, 0xb7,
+    0x69, 0x52, 0x28, 0x36, 0x62, 0xc4, 0xae, 0x6b, 0x55, 0x8a, 0xa2, 0x05,
+    0x5c, 0x3e, 0x60, 0xc0, 0xe9, 0x24, 0x2a, 0x9c, 0x0b, 0x8b, 0xfa, 0x28,
+    0xbe, 0xc3, 0x0a, 0xd7, 0x3e, 0x1e, 0x37, 0x18, 0x2e, 0xd4, 0x20, 0xda,
+    0x8a, 0x45, 0xbb, 0xc3, 0x0d, 0x68, 0x3e, 0xe3, 0x5c, 0xa1, 0x53, 0xbd,
+    0x84, 0x66, 0x78, 0x84, 0x8d, 0x9a, 0x1d, 0x19, 0x09, 0x40, 0x38, 0xe8,
+    0xb3, 0xca, 0x4d, 0xad, 0x8a, 0xed, 0xd7, 0xfb, 0xd7, 0x8e, 0xd2, 0xd8,
+    0xe9, 0x61, 0xd0, 0x77, 0x7f, 0x36, 0x28, 0x9b, 0x32, 0x83, 0xbf, 0xf1,
+    0xe1, 0xf1, 0x68, 0xc2, 0xca, 0x9d, 0x8f, 0x55, 0x1e, 0x52, 0x8b, 0x86,
+    0x79, 0x4a, 0xb0, 0xee, 0xa2, 0x97, 0xd8, 0x70, 0x22, 0x06, 0x72, 0x65,
+    0x13, 0xcc, 0xf0, 0xd5, 0x33, 0xf4, 0xb2, 0x4a, 0x62, 0xfd, 0xa2, 0x6c,
+    0x47, 0x04, 0x05, 0x0b, 0xb1, 0x76, 0xd4, 0x3d, 0x3d, 0x5e, 0x8b, 0x60,
+    0xc1, 0x41, 0xee, 0x98, 0x23, 0xf5, 0xb7, 0x1c, 0x0d, 0x86, 0xd1, 0x12,
+    0xf2, 0xc6, 0x4d, 0xd0, 0xfd, 0x0b, 0x09, 0x0d, 0x47, 0xf4, 0xcd, 0x62,
+    0x75, 0xd0, 0x20, 0xa0, 0x70, 0xe1, 0xcb, 0xd0, 0x5b, 0x8d, 0x31, 0xc2,
+    0xe7, 0xc6, 0xa0, 0xd1, 0x4e, 0x64, 0xd6, 0x90, 0x62, 0x79, 0xa6, 0xb8,
+    0xbf, 0x4e, 0x79, 0xc3, 0xc8, 0xa2, 0x87, 0xd3, 0x78, 0x0e, 0x7d, 0x9a,
+    0x4b, 0xb0, 0xce, 0x25, 0x45, 0x60, 0x1b, 0x0c, 0x1c, 0xaa, 0xa3, 0x01,
+    0x94, 0xd5, 0x9f, 0xd2, 0xc8, 0x3d, 0x65, 0x98, 0x91, 0xea, 0x86, 0xce,
+    0xd1, 0x07, 0xae, 0x5e, 0x0c, 0x1e, 0xac, 0x34, 0x47, 0x08, 0x9d, 0xa3,
+    0xe7, 0x28, 0xda, 0x4a, 0x4c, 0x44, 0x11, 0x47, 0xcb, 0x31, 0x94, 0x01,
+    0xef, 0xc9, 0x71, 0x12, 0x05, 0x96, 0x17, 0x9d, 0x93, 0x5d, 0x30, 0x2c,
+    0xf0, 0xb0, 0x5a, 0x81, 0x28, 0x7b, 0x73, 0xff, 0x02, 0x6b, 0xd6, 0x08,
+    0xb6, 0xfd, 0x6d, 0xff, 0x79, 0x05, 0xb1, 0x2c, 0x7c, 0x86, 0x25, 0xc8,
+    0xa7, 0x35, 0x87, 0x66, 0xca, 0xed, 0xde, 0xf0, 0x8e, 0x18, 0x1a, 0xd6,
+    0x1b, 0xb4, 0x82, 0xba, 0x30, 0xed, 0x5c, 0x52, 0xcc, 0x90, 0xc0, 0x24,
+    0x4c, 0x97, 0xbe, 0x98, 0x66, 0x5f, 0x02, 0xc2, 0x23, 0x39, 0xaf, 0xd1,
+    0xf3, 0xe0, 0xd5, 0x0d, 0x47, 0x2d, 0x2e, 0x15, 0xdc, 0x31, 0x1f, 0x54,
+    0x94, 0xb3, 0x5c, 0x35, 0xfa, 0xc4, 0xdf, 0xfc, 0x01, 0xdf, 0x55, 0x01,
+    0x41, 0x0f, 0xa1, 0x21, 0x38, 0x85, 0x5b, 0xf6, 0xee, 0x97, 0x5b, 0xa3,
+    0x24, 0x01, 0x72, 0xaf, 0xe1, 0xf2, 0x91, 0x0a, 0xa1, 0x09, 0x65, 0x30,
+    0xc4, 0x02, 0x3a, 0x69, 0xe4, 0xa6, 0xba, 0x69, 0x26, 0x53, 0xe4, 0x8e,
+    0x41, 0x47, 0x43, 0xc3, 0xec, 0xae, 0x6d, 0x00, 0x45, 0x08, 0xad, 0xa0,
+    0xc4, 0x39, 0x0b, 0x36, 0x48, 0x0f, 0x1d, 0x45, 0xdd, 0x2d, 0xcb, 0xff,
+    0x00, 0x7d, 0x94, 0x67, 0x68, 0x9c, 0x6b, 0x42, 0x70, 0xa8, 0x69, 0xbf,
+    0xc9, 0xd7, 0xe4, 0xb2, 0xdf, 0x23, 0x87, 0xac, 0xb8, 0x6e, 0x69, 0x0a,
+    0x8b, 0xca, 0xdd, 0xba, 0xa3, 0x10, 0x0a, 0x07, 0xed, 0xb2, 0xa6, 0x81,
+    0x1f, 0xbc, 0xa1, 0xd3, 0x40, 0x0e, 0x4c, 0xdf, 0x34, 0x0d, 0xc6, 0xe9,
+    0x03, 0x81, 0xa0, 0xce, 0xbb, 0x6f, 0x7b, 0xea, 0xe9, 0x89, 0x66, 0x7f,
+    0xcd, 0x81, 0x20, 0xb2, 0x60, 0x65, 0x6b, 0x07, 0x4a, 0x71, 0xac, 0xf1,
+    0xbb, 0x73, 0x47, 0xa9, 0x47, 0xf8, 0xe7, 0x61, 0x4f, 0xa3, 0xcf, 0xab,
+    0x30, 0x07, 0xd3, 0x01, 0x6a, 0xc0, 0x6c, 0xcb, 0xb5, 0x92, 0xe8, 0x18,
+    0x16, 0x78, 0x21, 0x97, 0x46, 0xea, 0x7e, 0xe9, 0x23, 0x43, 0x8a, 0x1a,
+    0xcc, 0x27, 0x5e, 0xf8, 0x1f, 0x1a, 0x69, 0x10, 0x12, 0x0a, 0x58, 0x56,
+    0x4a, 0x0c, 0xba, 0x43, 0x1b, 0xe1, 0x87, 0xb3, 0xab, 0xb6, 0xce, 0xdc,
+    0xaf, 0xb0, 0xe5, 0xe9, 0x90, 0xa6, 0x3d, 0x26, 0xbe, 0xd9, 0x33, 0x21,
+    0x7b, 0x76, 0x33, 0x1e, 0x3a, 0x61, 0x14, 0x8c, 0x82, 0x84, 0x04, 0xea,
+    0x4c, 0xd8, 0xe2, 0xda, 0x4c, 0xd8, 0x14, 0x6b, 0x7a, 0x65, 0x28, 0x62,
+    0x5c, 0xcd, 0xcd, 0xc1, 0xd2, 0x02, 0xa6, 0xde, 0x22, 0x76, 0xe4, 0x62,
+    0x96, 0xde, 0xa3, 0x9a, 0x41, 0x9f, 0xba, 0x13, 0x05, 0x28, 0xc1, 0xdf,
+    0xa4, 0x3f, 0x2e, 0xd2, 0xef, 0x1e, 0x96, 0xe4, 0x70, 0xd8, 0x46, 0xbd,
+    0x84, 0x9c, 0x3b, 0xdb, 0x86, 0xc7, 0x91, 0x14, 0x53, 0xa9, 0x36, 0x9b,
+    0x47, 0x9f, 0xb5, 0xd8, 0xdc, 0x4d, 0x8a, 0x3c, 0x8e, 0x3a, 0x2f, 0x5e,
+    0x0e, 0x71, 0x8a, 0xc6, 0xcb, 0x76, 0xcf, 0xdc, 0xdd, 0xdb, 0xfd, 0xfc,
+    0xf7, 0x56, 0xda, 0x91, 0xf0, 0x19, 0x7f, 0x7c, 0x13, 0xff, 0x83, 0x65,
+    0x4d, 0xdf, 0x48, 0xd9, 0x48, 0x7a, 0x3e, 0xf3, 0x4e, 0xdd, 0x86, 0x67,
+    0x53, 0x4c, 0x47, 0x69, 0xc2, 0x34, 0x2c, 0x01, 0x7f, 0xe8, 0x5d, 0xfd,
+    0xb8, 0x74, 0xb3, 0x44, 0x0d, 0xfd, 0x68, 0x5a, 0xc8, 0x5d, 0x2b, 0x7f,
+    0x50, 0x3f, 0x52, 0xb0, 0x77, 0xfb, 0x03, 0x63, 0x97, 0x41, 0x4b, 0xcc,
+    0xaf, 0x4a, 0x58, 0x73, 0x2c, 0x70, 0xa8, 0x11, 0xaf, 0x76, 0x8e, 0x04,
+    0xe8, 0x53, 0x38, 0xc7, 0x28, 0x52, 0x7c, 0x94, 0x44, 0x26, 0xdf, 0xc2,
+    0x0a, 0x42, 0xde, 0x96, 0xa7, 0x3a, 0x03, 0x8f, 0xbf, 0x0f, 0x42, 0x50,
+    0xf6, 0x71, 0xaa, 0xc0, 0x60, 0xc3, 0xc3, 0xeb, 0x7e, 0xea, 0xe3, 0x19,
+    0xf4, 0x82, 0x22, 0x1c, 0x23, 0x7b, 0x11, 0x00, 0xf2, 0x28, 0x4a, 0x5d,
+    0x0a, 0x53, 0xcb, 0x84, 0x8b, 0xf6, 0x6c, 0xc3, 0x93, 0x86, 0xc5, 0xd7,
+    0xd0, 0x5c, 0xd9, 0x08, 0x1b, 0x3e, 0x28, 0xc9, 0x63, 0x3e, 0xa5, 0x32,
+    0x2b, 0x70, 0x2d, 0x29, 0x34, 0xca, 0x64, 0x3a, 0x2c, 0xf9, 0x4e, 0x7c,
+    0x15, 0x7b, 0xd2, 0x16, 0x2f, 0x71, 0x57, 0xea, 0x11, 0x39, 0x63, 0x66,
+    0xa3, 0x5b, 0x8b, 0x2b, 0x9f, 0xa2, 0x9e, 0x8f, 0x44, 0x97, 0x23, 0x54,
+    0x61, 0xb1, 0x32, 0xe2, 0x8f, 0xdc, 0xa3, 0xf7, 0x58, 0x21, 0x41, 0x00,
+    0xf3, 0xd4, 0xd2, 0x96, 0x95, 0x7f, 0x8e, 0x2f, 0x64, 0x1c, 0x04, 0x04,
+    0xa1, 0xca, 0x02, 0xe6, 0xe2, 0xb6, 0x61, 0x08, 0x78, 0x9f, 0x11, 0x86,
+    0xe8, 0x2d, 0x1e, 0x68, 0x2a, 0x7d, 0xfe, 0xed, 0x55, 0xb7, 0x13, 0xe5,
+    0x04, 0xcb, 0xfc, 0xd5, 0x2f, 0xea, 0xdc, 0x3a, 0x46, 0x32, 0x05, 0x69,
+    0x6f, 0x68, 0x6e, 0xb9, 0xbf, 0xf1, 0x4c, 0x76, 0x71, 0xf4, 0x70, 0xa5,
+    0xf9, 0x7d, 0x2b, 0x2c, 0xef, 0xd0, 0x89, 0xb0, 0x26, 0xb6, 0xaa, 0x98,
+    0xb5, 0x8f, 0x1f, 0x12, 0xfa, 0x83, 0xf0, 0xba, 0x72, 0xaa, 0x9c, 0x02,
+    0xf0, 0xff, 0xee, 0x20, 0x9f, 0x7f, 0x5a, 0x71, 0xe6, 0xc5, 0xeb, 0x21,
+    0x85, 0x59, 0xd0, 0xce, 0x33, 0xca, 0xce, 0x1a, 0x8a, 0xd0, 0xa4, 0x26,
+    0x1f, 0x1b, 0xba, 0x76, 0x7b, 0xd3, 0x49, 0x3d, 0x65, 0x64, 0x7c, 0x71,
+    0x14, 0x60, 0x07, 0xfa, 0x83, 0x07, 0x40, 0x53, 0xa4, 0x08, 0xf1, 0x83,
+    0xc4, 0x14, 0x4f, 0x34, 0x22, 0x83, 0x75, 0x43, 0x04, 0x24, 0xc0, 0xb2,
+    0x2c, 0x81, 0xd9, 0x0f, 0xd8, 0x81, 0x8f, 0xc3, 0x64, 0x89, 0x06, 0x89,
+    0x47, 0xa4, 0x0d, 0x96, 0x99, 0x08, 0x48, 0x40, 0x8d, 0xf4, 0x8b, 0xf4,
+    0x1c, 0x6e, 0x08, 0x85, 0xd4, 0xa6, 0x9f, 0x61, 0x1b, 0xa5, 0x09, 0xd2,
+    0x54, 0x5f, 0xc5, 0xc5, 0x01, 0xbb, 0x61, 0x69, 0x6e, 0xee, 0xeb, 0x13,
+    0xbb, 0x47, 0xc9, 0x1d, 0x73, 0x53, 0xa0, 0x21, 0x72, 0x89, 0xce, 0x53,
+    0xd2, 0xb0, 0x86, 0x2f, 0xcb, 0xce, 0xdb, 0xa8, 0xa3, 0xf0, 0x43, 0x63,
+    0x38, 0x70, 0xe5, 0x48, 0x3e, 0x80, 0x10, 0x7e, 0x08, 0xd4, 0xd0, 0x3d,
+    0x2d, 0x05, 0xe5, 0x28, 0x8e, 0x01, 0x9b, 0xd7, 0xda, 0x30, 0x2c, 0x01,
+    0xca, 0x14, 0xd3, 0x88, 0x3b, 0x52, 0x02, 0xe2, 0xfb, 0x75, 0x9e, 0xac,
+    0x69, 0x85, 0xb4, 0x24, 0x26, 0x41, 0x83, 0xf1, 0x6a, 0xe1, 0xba, 0x45,
+    0xe7, 0x0e, 0x2c, 0xf1, 0xc6, 0x49, 0x53, 0xf7, 0xec, 0x93, 0x7f, 0x95,
+    0x3c, 0x6b, 0x97, 0xd2, 0x8b, 0x00, 0x00, 0x6d, 0x8b, 0x56, 0x83
+};
+
+static const fsw_u8 stream_window4k[3465] = {
+    0x48, 0x89, 0xec, 0x17, 0x6b, 0x68, 0x9c, 0x45, 0x50, 0x08, 0xb1, 0x71,
+    0xb1, 0xc6, 0x4a, 0x10, 0x6b, 0xc1, 0x5e, 0x68, 0x45, 0x44, 0x02, 0x41,
+    0x62, 0x69, 0x0d, 0x18, 0x5b, 0x25, 0x69, 0x24, 0x91, 0x10, 0x9a, 0xd8,
+    0x47, 0x68, 0x9b, 0xd8, 0x3b, 0x13, 0x2f, 0xde, 0x89, 0xb9, 0xe4, 0x24,
+    0x50, 0xca, 0x09, 0x49, 0xa3, 0xb1, 0x4a, 0xfd, 0x51, 0xee, 0xa0, 0x20,
+    0x16, 0x5f, 0x10, 0x14, 0x29, 0x4a, 0x4b, 0x11, 0xd1, 0x92, 0x47, 0x6b,
+    0xa0, 0xfd, 0x11, 0x8d, 0x21, 0x8f, 0x62, 0x0a, 0xf5, 0x87, 0x0d, 0x14,
+    0xa1, 0xff, 0x4e, 0xd0, 0x64, 0x77, 0xe6, 0xfb, 0x76, 0xe6, 0xbe, 0x98,
+    0xe4, 0xce, 0xbb, 0xfb, 0x1e, 0xd9, 0xc7, 0xcc, 0xb7, 0x8f, 0x6f, 0x76,
+    0x77, 0x66, 0x76, 0x76, 0xa6, 0xa2, 0x7c, 0xd7, 0x0e, 0x5f, 0xb4, 0x23,
+    0x74, 0x2c, 0x1c, 0xf5, 0x1d, 0xf3, 0x07, 0x3a, 0x5b, 0x23, 0x7e, 0x9f,
+    0xa8, 0x58, 0xea, 0xec, 0xed, 0xec, 0x68, 0xf3, 0xb5, 0x45, 0xde, 0x0a,
+    0x74, 0xf9, 0x84, 0xf0, 0xbf, 0x1d, 0xf1, 0x87, 0x22, 0xd0, 0x94, 0xc3,
+    0x02, 0x67, 0x23, 0x6e, 0xeb, 0x0c, 0xbf, 0x1a, 0x54, 0x63, 0x1d, 0x21,
+    0xd5, 0x05, 0x74, 0xd5, 0x5f, 0xed, 0xdd, 0x81, 0xc0, 0x1b, 0xad, 0x21,
+    0x03, 0xe3, 0x7f, 0xe6, 0x62, 0x64, 0x11, 0x68, 0xe0, 0x6c, 0x68, 0x0a,
+    0xd6, 0x06, 0x54, 0xa1, 0x9d, 0x02, 0x17, 0x47, 0x6c, 0xfc, 0x22, 0x27,
+    0xe1, 0x81, 0xc8, 0xea, 0x42, 0xed, 0x5d, 0x41, 0xb9, 0x15, 0xbe, 0x49,
+    0x35, 0x84, 0x24, 0xb1, 0x17, 0xdb, 0x92, 0x08, 0x6c, 0x85, 0xfc, 0x8e,
+    0x58, 0xc0, 0x0a, 0x64, 0x2b, 0xd8, 0x58, 0x89, 0x71, 0xd0, 0xd0, 0x17,
+    0x91, 0xdf, 0xc6, 0xde, 0x4c, 0xa1, 0x90, 0xff, 0x90, 0x98, 0x36, 0x9e,
+    0x72, 0x4e, 0x9d, 0xef, 0x3a, 0x05, 0x41, 0x96, 0xe6, 0xdc, 0xc0, 0xb6,
+    0x52, 0x11, 0x49, 0x4d, 0xa7, 0xa1, 0x2d, 0x65, 0xa8, 0x14, 0xca, 0x56,
+    0xf6, 0x5a, 0x6e, 0x13, 0x3a, 0x99, 0xdc, 0xd9, 0xa8, 0x21, 0x4c, 0x43,
+    0x80, 0xa8, 0x18, 0xc2, 0x5c, 0x1a, 0x87, 0xe4, 0xf6, 0x28, 0x17, 0xc8,
+    0x36, 0xa0, 0xc1, 0x15, 0x86, 0xcc, 0x14, 0xb4, 0xd7, 0x50, 0x2a, 0x01,
+    0x1c, 0x12, 0x72, 0x11, 0x53, 0x87, 0x71, 0x82, 0xc6, 0x1a, 0x8d, 0xff,
+    0x64, 0x14, 0x8e, 0xa4, 0x8b, 0xd7, 0x7a, 0x31, 0xaa, 0x28, 0xba, 0x9e,
+    0x09, 0x4d, 0x94, 0xff, 0xa9, 0x9c, 0x8a, 0x20, 0x11, 0x2a, 0x0a, 0x81,
+    0x68, 0x36, 0x2e, 0xc5, 0x04, 0x4f, 0x85, 0x09, 0x83, 0xba, 0xee, 0x58,
+    0xdf, 0x17, 0xa2, 0xe6, 0xc8, 0x30, 0x93, 0x57, 0x82, 0x1c, 0xc8, 0xd0,
+    0x3c, 0x2b, 0xd9, 0x90, 0x5b, 0x95, 0xc2, 0x17, 0x2b, 0x83, 0xa1, 0xf3,
+    0x9e, 0x11, 0x13, 0x74, 0x45, 0xbe, 0x77, 0x36, 0x9b, 0x35, 0x99, 0x01,
+    0x62, 0x34, 0xac, 0x78, 0xab, 0xce, 0xaa, 0x5f, 0x5f, 0x36, 0x5b, 0xe9,
+    0x10, 0xe3, 0x6e, 0x8a, 0xf9, 0x32, 0x74, 0xc3, 0x24, 0xca, 0xec, 0xb6,
+    0xde, 0x67, 0x72, 0x5d, 0xbb, 0xf2, 0xec, 0x32, 0xb1, 0x15, 0x05, 0x95,
+    0xb2, 0xb6, 0x8e, 0xa6, 0x42, 0x8c, 0xbc, 0xa5, 0x08, 0xc8, 0xb1, 0xb8,
+    0x49, 0x4b, 0x35, 0x76, 0x82, 0x5f, 0x40, 0x6d, 0x39, 0x72, 0x9f, 0x89,
+    0xd9, 0x61, 0xd2, 0x52, 0x76, 0x9c, 0x18, 0x16, 0xd0, 0x37, 0x4b, 0xbd,
+    0x60, 0x7f, 0xd3, 0x8d, 0x6b, 0xf6, 0x4b, 0xe8, 0xe4, 0x99, 0xe8, 0xb5,
+    0x07, 0x12, 0x7a, 0xf8, 0xd5, 0xe3, 0x4f, 0xa4, 0x7e, 0x71, 0xf4, 0xb5,
+    0x98, 0x3e, 0x58, 0x5d, 0x0b, 0xfd, 0xb2, 0x09, 0xce, 0x7d, 0x0b, 0x83,
+    0xfb, 0xe4, 0x6e, 0xe7, 0x64, 0x6f, 0x9e, 0xf9, 0xd4, 0xbd, 0x70, 0xb4,
+    0x85, 0x7d, 0xed, 0x73, 0xa3, 0xc1, 0x01, 0x0f, 0x20, 0x87, 0xbf, 0xb6,
+    0x1e, 0xd7, 0xd0, 0x68, 0x5e, 0xd2, 0x78, 0x75, 0xdb, 0x39, 0x59, 0x91,
+    0x87, 0x76, 0x0b, 0x02, 0x5c, 0xed, 0x51, 0xdb, 0xde, 0xb9, 0xcd, 0xb7,
+    0x6f, 0x33, 0xd0, 0x57, 0x3a, 0x51, 0xe6, 0x5a, 0x10, 0xbc, 0xdc, 0xdd,
+    0x1f, 0x9f, 0x59, 0x07, 0x71, 0xa5, 0x30, 0xa8, 0x11, 0x8f, 0xc7, 0xc2,
+    0x8f, 0x1e, 0x98, 0x38, 0xdb, 0xf0, 0xe6, 0x3a, 0x92, 0xc8, 0x55, 0x46,
+    0x05, 0x7b, 0xe7, 0xa9, 0xc9, 0x70, 0xbc, 0xaf, 0x51, 0xe7, 0xea, 0x54,
+    0x58, 0xbf, 0x77, 0xa8, 0x69, 0x1d, 0x68, 0x00, 0x75, 0xac, 0xe9, 0xe7,
+    0xdf, 0xaf, 0x7e, 0x7b, 0xd8, 0x65, 0xf0, 0xc8, 0x4f, 0x78, 0xbc, 0xae,
+    0xe1, 0xbe, 0x6d, 0x5f, 0x9f, 0xf8, 0xae, 0xf6, 0x91, 0xc1, 0x6c, 0x63,
+    0x75, 0xbd, 0xce, 0x1e, 0x6e, 0xee, 0xcc, 0x7a, 0x46, 0xab, 0x62, 0xe9,
+    0x1e, 0x32, 0x93, 0xaa, 0x9c, 0x57, 0xe2, 0x00, 0xda, 0xc1, 0x2d, 0x36,
+    0x3c, 0xb4, 0x25, 0x22, 0xba, 0x65, 0xe3, 0xa6, 0x4b, 0x08, 0xfa, 0xb8,
+    0xca, 0x1f, 0xa8, 0x61, 0x24, 0x16, 0x54, 0x1e, 0xa5, 0xa0, 0xa8, 0x6a,
+    0x7c, 0xd6, 0x4d, 0xb5, 0x77, 0xcf, 0x96, 0xe2, 0xe6, 0xa4, 0xdb, 0xa1,
+    0x7a, 0x89, 0xec, 0xca, 0x34, 0xe3, 0x8d, 0x7e, 0xea, 0x60, 0xe5, 0x8d,
+    0xf5, 0x5a, 0xf9, 0xd2, 0xc1, 0x4b, 0xf5, 0x85, 0x89, 0x5b, 0x69, 0x21,
+    0x75, 0x71, 0x4f, 0x96, 0xec, 0x1e, 0xca, 0xbc, 0xee, 0xdc, 0x3c, 0xbd,
+    0xdf, 0xed, 0x05, 0x6c, 0xe0, 0xae, 0xa1, 0x58, 0x6b, 0xe5, 0xf3, 0xa1,
+    0xf8, 0xaa, 0xf1, 0x20, 0x77, 0xf3, 0x56, 0x9d, 0x51, 0xdb, 0xc1, 0x36,
+    0xa3, 0xc5, 0x85, 0x66, 0xcf, 0xf5, 0x17, 0x7e, 0x2c, 0xf0, 0x0a, 0xd8,
+    0x34, 0x79, 0x65, 0xa6, 0x66, 0xca, 0xdb, 0xd0, 0x3e, 0x7c, 0xfa, 0x6b,
+    0xe3, 0xed, 0xa5, 0xe2, 0x07, 0x4d, 0xbc, 0xb8, 0x7c, 0x48, 0x63, 0x9d,
+    0x1f, 0x18, 0x76, 0x67, 0x8e, 0x29, 0x1b, 0x91, 0x6f, 0x45, 0xc9, 0x58,
+    0x69, 0x50, 0x9a, 0x0f, 0x8f, 0xed, 0xfc, 0xea, 0xa1, 0xff, 0x11, 0x1c,
+    0x05, 0x85, 0xe9, 0xf8, 0x14, 0x3e, 0x36, 0xfc, 0xdd, 0xb2, 0x35, 0x07,
+    0xf5, 0xc2, 0x6f, 0xaf, 0xa4, 0x57, 0x60, 0x9b, 0x5f, 0xe6, 0x5b, 0x8a,
+    0x39, 0xd0, 0x0c, 0x3d, 0x00, 0x10, 0x5a, 0x2c, 0xb1, 0x6c, 0xd4, 0x60,
+    0x84, 0x1c, 0xc4, 0xed, 0x8f, 0x1a, 0x13, 0xa1, 0x09, 0xb4, 0x68, 0x28,
+    0x22, 0x29, 0x6b, 0x11, 0x0d, 0xcc, 0x25, 0x81, 0x07, 0x92, 0x1d, 0x58,
+    0xd8, 0xd7, 0x3e, 0x37, 0x1a, 0x4c, 0x0b, 0x49, 0x65, 0x63, 0x11, 0x95,
+    0x5a, 0x11, 0x8e, 0x2b, 0x64, 0x2f, 0x6e, 0xee, 0x9f, 0xb2, 0x27, 0x8e,
+    0xea, 0xf5, 0x4c, 0xac, 0xff, 0xd9, 0xc6, 0x64, 0xe4, 0xce, 0x4a, 0xf8,
+    0xc8, 0x69, 0x75, 0xac, 0xe3, 0x37, 0x7a, 0xf2, 0x50, 0xae, 0x1a, 0x7e,
+    0xc2, 0x1a, 0xe3, 0x41, 0x85, 0xa2, 0xe9, 0x27, 0xa4, 0xc7, 0xe2, 0xdd,
+    0x44, 0xa0, 0xfc, 0xd0, 0x58, 0xed, 0x4d, 0xf7, 0x20, 0xdf, 0xc2, 0x6c,
+    0xcb, 0x68, 0x26, 0xe5, 0xe9, 0xd3, 0xc3, 0x8e, 0x2b, 0xdb, 0x4a, 0xe6,
+    0x3f, 0xc9, 0xb0, 0x36, 0x18, 0xc6, 0x43, 0xbb, 0xdc, 0x4c, 0x59, 0xa8,
+    0x93, 0x7b, 0x3c, 0x71, 0xbf, 0xe7, 0xca, 0x42, 0x61, 0xfd, 0xde, 0xa1,
+    0xa6, 0x2c, 0x83, 0x6a, 0x75, 0xd9, 0xdf, 0x1f, 0x7d, 0xa6, 0xea, 0xc3,
+    0xe4, 0x58, 0x06, 0x28, 0xfc, 0x20, 0xc9, 0xbd, 0x7b, 0xb6, 0x14, 0x37,
+    0x27, 0x6d, 0x01, 0x59, 0xb8, 0x64, 0x6f, 0xaf, 0xf4, 0x4c, 0x49, 0x22,
+    0xa5, 0xfc, 0xb1, 0x28, 0x20, 0xfd, 0x19, 0x0e, 0x9b, 0x6d, 0x78, 0x20,
+    0x65, 0x37, 0x3e, 0x5d, 0xe4, 0xb5, 0x5c, 0xc4, 0xea, 0x3d, 0x25, 0xaf,
+    0x6d, 0xda, 0xa1, 0x67, 0x96, 0xf3, 0x8b, 0x35, 0x5f, 0x94, 0xc7, 0x8a,
+    0x9b, 0xff, 0xfc, 0x3e, 0xbf, 0xd8, 0xf4, 0x53, 0x0a, 0x8a, 0xaa, 0xc6,
+    0x67, 0xd7, 0x5c, 0xcb, 0xa6, 0x36, 0x56, 0x7b, 0xaf, 0xee, 0x40, 0x85,
+    0x93, 0x00, 0xb4, 0x71, 0xa5, 0x18, 0xc3, 0xe6, 0x20, 0xfe, 0xb2, 0x47,
+    0xb3, 0xf6, 0x30, 0x13, 0xbf, 0x31, 0x4b, 0x4e, 0xfd, 0x22, 0x26, 0xfe,
+    0x37, 0xd2, 0x23, 0xa1, 0x06, 0x74, 0x2a, 0xaa, 0x92, 0x20, 0x8e, 0x2c,
+    0xba, 0xeb, 0x27, 0xee, 0x6c, 0xb0, 0x57, 0x59, 0x2e, 0x02, 0x81, 0x13,
+    0xde, 0x75, 0x6a, 0x3a, 0xcf, 0x1c, 0xb4, 0xed, 0xc9, 0x6b, 0x1f, 0x4d,
+    0x7a, 0x07, 0x4c, 0x6f, 0xcd, 0x5d, 0xfa, 0xc5, 0xeb, 0x69, 0x2e, 0x77,
+    0x09, 0xcd, 0x50, 0xda, 0x26, 0x09, 0xa6, 0xa1, 0xed, 0x43, 0x3c, 0x32,
+    0x1f, 0xf4, 0x5e, 0xe9, 0xbe, 0xe7, 0xd2, 0xc7, 0x23, 0x9f, 0x9d, 0x1b,
+    0xac, 0x5a, 0x19, 0x1f, 0x78, 0xe7, 0xbd, 0xc0, 0x35, 0x07, 0x81, 0x3a,
+    0x27, 0x27, 0xd0, 0xd1, 0x0b, 0x3f, 0xfc, 0x6a, 0xcb, 0xfc, 0xd8, 0xc9,
+    0xae, 0x77, 0xeb, 0x3e, 0xf8, 0xfc, 0x62, 0x0e, 0x70, 0xde, 0xcf, 0x9a,
+    0xe5, 0xd3, 0x17, 0xa1, 0x85, 0xea, 0xb9, 0xbe, 0x69, 0xf2, 0xca, 0x4c,
+    0xcd, 0x94, 0xad, 0x61, 0x9a, 0x71, 0x56, 0x8e, 0x2b, 0x3e, 0x0b, 0xdb,
+    0xcb, 0x06, 0xfa, 0x4a, 0x27, 0xdc, 0x06, 0x82, 0x97, 0xbb, 0xfb, 0xe3,
+    0x33, 0xab, 0x01, 0x5a, 0x8c, 0x64, 0x4a, 0xb1, 0x61, 0xe9, 0xa9, 0x24,
+    0x4e, 0xb9, 0x7c, 0x28, 0xe1, 0x81, 0x04, 0x44, 0xc6, 0xd5, 0xeb, 0x0a,
+    0xad, 0x5b, 0x60, 0x9a, 0x1a, 0xbf, 0x39, 0xf5, 0xda, 0xdd, 0xc6, 0xdb,
+    0x6b, 0x42, 0xa5, 0xcf, 0xdd, 0xe7, 0xdc, 0x82, 0xdc, 0x78, 0xdd, 0x35,
+    0x09, 0x24, 0xd9, 0x12, 0x35, 0x13, 0x77, 0x8a, 0x60, 0x4a, 0x22, 0x50,
+    0x7e, 0x68, 0xac, 0xf6, 0x66, 0x3e, 0xd0, 0xc8, 0xe6, 0xe9, 0xfd, 0x8e,
+    0x2b, 0xa8, 0x2b, 0x12, 0xff, 0x0b, 0x00, 0x00, 0xff, 0xff, 0x82, 0xe7,
+    0x20, 0x68, 0x60, 0x72, 0x81, 0x45, 0x61, 0x21, 0xfc, 0x5f, 0x57, 0x3d,
+    0x01, 0x19, 0x4f, 0x6b, 0x6c, 0xb3, 0x0a, 0xfa, 0x5d, 0xf2, 0x1e, 0x2b,
+    0x3d, 0x1b, 0xa6, 0xcb, 0x65, 0xde, 0xa6, 0x49, 0xa1, 0xd8, 0x08, 0x56,
+    0x5f, 0x8f, 0xd5, 0x14, 0x13, 0x30, 0x67, 0x87, 0x9e, 0x7a, 0x70, 0x72,
+    0x4b, 0xdc, 0xd0, 0x20, 0x95, 0xa2, 0x68, 0x01, 0x97, 0x0f, 0x18, 0x70,
+    0x3a, 0x89, 0x0a, 0xe7, 0xc2, 0xa2, 0x3e, 0x8a, 0xef, 0xb0, 0xc2, 0xb5,
+    0x8f, 0xc7, 0x0d, 0x86, 0x0b, 0x05, 0xea, 0x92, 0x65, 0xc3, 0xf2, 0x06,
+    0xb8, 0xde, 0x01, 0x13, 0x10, 0x61, 0x98, 0xa7, 0xb9, 0xa0, 0xf2, 0x10,
+    0x51, 0x58, 0x67, 0x0e, 0xb9, 0x5e, 0x82, 0x09, 0x42, 0x15, 0xc2, 0x9a,
+    0x00, 0x68, 0xb2, 0x5c, 0x30, 0x71, 0x2e, 0xb4, 0x12, 0x8e, 0x8b, 0x0b,
+    0x61, 0x35, 0x4c, 0x0a, 0xa5, 0x03, 0x89, 0x92, 0x85, 0x51, 0xdc, 0x4c,
+    0x44, 0x66, 0xc7, 0xcc, 0xce, 0xf1, 0x13, 0x21, 0x66, 0xd4, 0xde, 0x2b,
+    0xa3, 0x0a, 0xaa, 0xd0, 0xa9, 0x5e, 0x42, 0x33, 0xcc, 0x5e, 0xff, 0x1e,
+    0x03, 0x85, 0x64, 0xdc, 0x3d, 0x96, 0xdd, 0xf1, 0x06, 0x83, 0x82, 0xfa,
+    0xfb, 0xcb, 0x50, 0x05, 0x9b, 0x52, 0x2b, 0x8e, 0x8c, 0x04, 0x20, 0x1c,
+    0xf4, 0x59, 0xe5, 0xa6, 0x56, 0xc5, 0xf6, 0xeb, 0xfd, 0x6b, 0x47, 0x69,
+    0xec, 0xb4, 0x0f, 0x79, 0x00, 0x9a, 0x03, 0xb6, 0x0f, 0x78, 0x3f, 0x15,
+    0x08, 0x9f, 0x0d, 0xca, 0xa6, 0xcc, 0xe0, 0x6f, 0x7c, 0x78, 0x3c, 0x9a,
+    0xb0, 0x72, 0xe7, 0x63, 0x95, 0x87, 0xd4, 0xa2, 0x61, 0x9e, 0x12, 0xac,
+    0xbb, 0xe8, 0x25, 0x36, 0x9c, 0x08, 0xfc, 0xf5, 0xd2, 0x49, 0x98, 0xbf,
+    0x53, 0x21, 0x35, 0x2b, 0x17, 0xa4, 0xd2, 0x83, 0x90, 0xe0, 0xea, 0x15,
+    0x56, 0x1f, 0xc3, 0xd2, 0x10, 0x44, 0x2a, 0x13, 0x5a, 0xcf, 0xe3, 0x07,
+    0x30, 0xc3, 0x57, 0xcf, 0xd0, 0xcb, 0x2a, 0x89, 0xf5, 0x8b, 0xb2, 0x1d,
+    0x11, 0x14, 0x2c, 0xc4, 0xda, 0x21, 0x61, 0x04, 0xe3, 0x7a, 0x2d, 0x82,
+    0x05, 0x07, 0x99, 0xc5, 0x96, 0x0f, 0xd6, 0x88, 0xc8, 0x43, 0xed, 0x0f,
+    0xc2, 0xf8, 0xe0, 0xd8, 0x84, 0x16, 0x02, 0x28, 0xf1, 0x08, 0x6f, 0x5f,
+    0x81, 0xa2, 0xba, 0xa3, 0x55, 0xf1, 0xb2, 0xee, 0xa0, 0x21, 0xb2, 0x0f,
+    0x95, 0xb6, 0xcd, 0xb8, 0x4d, 0x0c, 0x71, 0xde, 0x19, 0xdd, 0xbf, 0x90,
+    0xd0, 0x70, 0x84, 0x09, 0xc3, 0x7c, 0x59, 0x07, 0x0d, 0x82, 0xb0, 0xdf,
+    0x55, 0x4e, 0xd2, 0xfc, 0x64, 0x93, 0x9a, 0x8e, 0x94, 0x41, 0x17, 0xf7,
+    0xe5, 0x06, 0x8d, 0xfc, 0x61, 0xaf, 0xf6, 0xd0, 0x8d, 0x96, 0x27, 0x1e,
+    0x5c, 0x19, 0x86, 0x00, 0x1a, 0xed, 0x44, 0x66, 0x0d, 0x29, 0x96, 0x67,
+    0x8a, 0xfb, 0xeb, 0x94, 0x37, 0x8c, 0x2c, 0xda, 0x20, 0xfa, 0xb8, 0xe7,
+    0xa3, 0x99, 0x69, 0xe8, 0xd4, 0x51, 0x0a, 0xdb, 0x23, 0x83, 0x1c, 0x51,
+    0xd2, 0x5c, 0x82, 0x75, 0x2e, 0x29, 0x02, 0xdb, 0x60, 0xe0, 0x50, 0x1d,
+    0x0d, 0xa0, 0xac, 0xfe, 0x94, 0x46, 0xee, 0x29, 0xc3, 0x8c, 0x54, 0x37,
+    0x74, 0x8e, 0x3e, 0x70, 0xf5, 0x62, 0xf0, 0x60, 0xa5, 0x39, 0x42, 0xe8,
+    0x1c, 0x3d, 0x47, 0xe1, 0xcd, 0x36, 0x48, 0x8a, 0x44, 0x14, 0x71, 0x29,
+    0xf9, 0xe5, 0x0a, 0x5c, 0xf0, 0x3a, 0x1e, 0x26, 0x0e, 0x4b, 0xde, 0x5c,
+    0xe0, 0xb2, 0x0f, 0x4c, 0xc0, 0xa4, 0xc0, 0x25, 0x20, 0xd6, 0xcc, 0x00,
+    0xa9, 0x52, 0xa1, 0x1c, 0x90, 0x8a, 0x01, 0xef, 0xc9, 0x71, 0x12, 0x05,
+    0x96, 0x17, 0x9d, 0x93, 0x5d, 0x30, 0x2c, 0xb0, 0xee, 0x0d, 0x5e, 0xb7,
+    0x81, 0xc1, 0x66, 0xb0, 0x24, 0x04, 0x26, 0xa0, 0x69, 0xa0, 0xec, 0xbc,
+    0xf3, 0x01, 0x66, 0xb2, 0x09, 0xd9, 0x9b, 0xfb, 0x17, 0x58, 0xb3, 0x46,
+    0xb0, 0xed, 0x6f, 0xfb, 0xcf, 0x2b, 0x68, 0xdf, 0xff, 0xfb, 0x78, 0xcf,
+    0x31, 0x53, 0x64, 0x0a, 0x96, 0x20, 0x9f, 0xd6, 0x1c, 0x9a, 0x29, 0xb7,
+    0x7b, 0xc3, 0x3b, 0x62, 0x68, 0x58, 0x6f, 0xd0, 0x0a, 0xea, 0xc2, 0xb4,
+    0x73, 0x49, 0x31, 0x43, 0x02, 0x9f, 0xbe, 0xc3, 0x61, 0x4f, 0x24, 0x7e,
+    0x31, 0xcd, 0xbe, 0x04, 0x84, 0x47, 0x72, 0x5e, 0x03, 0x96, 0x43, 0xb0,
+    0xe4, 0x51, 0x0e, 0x29, 0xe3, 0xc0, 0xc5, 0x16, 0x34, 0xd6, 0xb1, 0x77,
+    0x51, 0xc1, 0xa5, 0x1c, 0xbc, 0x24, 0x84, 0x94, 0x6c, 0x90, 0xf2, 0x0f,
+    0xac, 0x97, 0x0b, 0xa5, 0x78, 0x83, 0x9a, 0x0a, 0x12, 0xdc, 0x70, 0xd4,
+    0xe2, 0x52, 0xc1, 0x1d, 0xf3, 0x41, 0x45, 0x39, 0xcb, 0x55, 0xc3, 0x3c,
+    0x07, 0xa3, 0xe7, 0xcf, 0xe4, 0xa9, 0x1d, 0x0c, 0xe8, 0x21, 0x34, 0x04,
+    0xa7, 0x70, 0xcb, 0xde, 0xfd, 0x72, 0x6b, 0x94, 0x24, 0x40, 0xee, 0x35,
+    0x5c, 0x3e, 0x52, 0x21, 0x34, 0xa1, 0x0c, 0x86, 0x58, 0x40, 0x27, 0x8d,
+    0xdc, 0x54, 0x37, 0xcd, 0x64, 0x8a, 0xdc, 0x31, 0xe8, 0x68, 0x68, 0x98,
+    0xdd, 0xb5, 0x0d, 0xa0, 0x08, 0xa1, 0x15, 0x94, 0xb8, 0x3a, 0x3e, 0x70,
+    0x51, 0x18, 0x8f, 0x8b, 0x0b, 0x56, 0x70, 0x82, 0xcb, 0x4c, 0x44, 0xe9,
+    0x09, 0x53, 0x00, 0xe6, 0x40, 0x4a, 0x52, 0x88, 0x42, 0xb0, 0x12, 0x14,
+    0x59, 0x68, 0xd1, 0x0a, 0xa5, 0x50, 0xe4, 0x51, 0x2d, 0x83, 0xb9, 0x0e,
+    0xa5, 0x60, 0x46, 0x2e, 0xab, 0xa1, 0x36, 0xf3, 0x3f, 0x80, 0x95, 0x81,
+    0x30, 0x1d, 0xd2, 0xfc, 0x61, 0xbf, 0xab, 0x9c, 0xf0, 0x92, 0x70, 0x2b,
+    0xb5, 0xa3, 0xac, 0xef, 0x0d, 0x0c, 0x26, 0xe4, 0x44, 0xa7, 0xfd, 0x26,
+    0x5f, 0x93, 0xcb, 0x7e, 0x8f, 0x1c, 0xb2, 0xe2, 0xba, 0xa5, 0x29, 0x2c,
+    0x2a, 0x77, 0xeb, 0x8e, 0x42, 0x28, 0x54, 0xb4, 0xe3, 0x44, 0x46, 0xb0,
+    0x94, 0x9b, 0x35, 0xe0, 0x20, 0x42, 0xf2, 0xd6, 0x20, 0x42, 0xb0, 0x70,
+    0xc1, 0xda, 0x77, 0x85, 0x94, 0x67, 0xb0, 0xc4, 0xf5, 0x5f, 0x57, 0x3d,
+    0x01, 0x19, 0x4f, 0x83, 0xf5, 0x70, 0x71, 0x00, 0x98, 0xbe, 0x69, 0x1a,
+    0x8c, 0xd3, 0x07, 0x02, 0x41, 0x9d, 0x77, 0xdf, 0xf6, 0xd4, 0xd3, 0x13,
+    0xcd, 0xfe, 0x9a, 0x03, 0x41, 0x64, 0xc1, 0xca, 0xd6, 0x0e, 0x94, 0xe2,
+    0x58, 0xe3, 0x77, 0xe7, 0x8e, 0x52, 0x8f, 0xf0, 0xcf, 0xc3, 0x9e, 0x86,
+    0xa5, 0x2a, 0x58, 0x52, 0x60, 0x0e, 0xa6, 0x03, 0xd4, 0x80, 0xd9, 0x96,
+    0x6b, 0x25, 0xd1, 0x31, 0x2c, 0xf0, 0x42, 0x2e, 0x8d, 0xd4, 0xfd, 0xd2,
+    0x47, 0x86, 0x14, 0xf5, 0x26, 0x24, 0xe3, 0xee, 0xb1, 0xec, 0x0e, 0x5c,
+    0x14, 0x28, 0x1b, 0x50, 0x52, 0xf6, 0x34, 0xb6, 0x59, 0x05, 0xfd, 0x2e,
+    0x79, 0x4f, 0x88, 0x8e, 0x9f, 0x08, 0xc9, 0x78, 0xb5, 0xf7, 0xca, 0x90,
+    0x90, 0xff, 0xa1, 0x91, 0x06, 0x21, 0xa1, 0x70, 0x75, 0xdf, 0xd5, 0x67,
+    0x68, 0x35, 0x00, 0xa4, 0x78, 0x02, 0xb7, 0x27, 0xa1, 0x6d, 0x54, 0x2e,
+    0x58, 0x98, 0x83, 0x05, 0xa1, 0x8d, 0x46, 0xa4, 0xa6, 0x23, 0xac, 0x48,
+    0x83, 0x29, 0x83, 0x48, 0xa1, 0xe7, 0x74, 0x18, 0x1f, 0x6c, 0x08, 0x72,
+    0x2b, 0x14, 0xa6, 0x1d, 0x46, 0x73, 0x41, 0x6d, 0x40, 0x37, 0xb6, 0x44,
+    0xb5, 0x75, 0xe6, 0x7e, 0x85, 0x2d, 0x4f, 0x87, 0x34, 0xed, 0x31, 0xf1,
+    0xcd, 0x9e, 0x09, 0xd9, 0xb3, 0x9b, 0xf1, 0xd0, 0x09, 0xa3, 0x60, 0x14,
+    0x24, 0x24, 0x5c, 0xa1, 0x0a, 0xb8, 0x8b, 0x03, 0x34, 0xc5, 0x9a, 0x5e,
+    0x19, 0x8a, 0x18, 0x57, 0x73, 0x73, 0xb0, 0xb4, 0x80, 0xf1, 0xd5, 0x3e,
+    0xb3, 0x61, 0xba, 0x5c, 0xe6, 0x6d, 0x9a, 0x14, 0x8a, 0x8d, 0x60, 0xf5,
+    0xf5, 0x58, 0x0d, 0x23, 0x90, 0x8b, 0xd9, 0x82, 0x3b, 0xe6, 0x1b, 0x8e,
+    0x5a, 0x5c, 0x22, 0x92, 0x72, 0x96, 0xab, 0x86, 0xd9, 0x04, 0xa3, 0xe7,
+    0xcf, 0xe4, 0xa9, 0x25, 0x01, 0x05, 0x7d, 0xea, 0x4e, 0x14, 0xa0, 0x04,
+    0x7f, 0x93, 0xfe, 0xb8, 0x48, 0xbf, 0x7b, 0x58, 0x92, 0xf2, 0x34, 0x00,
+    0xd4, 0xc9, 0xeb, 0xc4, 0x83, 0x25, 0x90, 0x24, 0x0d, 0x21, 0xcb, 0x33,
+    0xf3, 0x52, 0xf2, 0xcb, 0x61, 0x14, 0x6a, 0xe5, 0x0d, 0xab, 0x83, 0x41,
+    0x92, 0x65, 0xe7, 0x9d, 0x0f, 0x30, 0x13, 0x43, 0xcc, 0xf0, 0x1b, 0xc4,
+    0x70, 0xaa, 0x9b, 0xee, 0x0d, 0x5e, 0xaa, 0xe0, 0x2f, 0xb4, 0x03, 0x9b,
+    0x52, 0x2b, 0x8e, 0x40, 0x01, 0x77, 0x93, 0x22, 0x8f, 0xa3, 0xce, 0x8b,
+    0x97, 0x43, 0x9c, 0x02, 0x36, 0x34, 0x89, 0x81, 0xe8, 0x8d, 0x51, 0x62,
+    0xd1, 0x99, 0xbb, 0x7b, 0xbb, 0x9f, 0xff, 0xde, 0x4a, 0x3b, 0x12, 0x56,
+    0x90, 0xc2, 0x28, 0x68, 0x65, 0xc0, 0x05, 0x6e, 0xcd, 0x82, 0x09, 0xa0,
+    0x8a, 0x8e, 0x56, 0xc5, 0xcb, 0xba, 0xf4, 0x21, 0xb2, 0x0f, 0x95, 0xb6,
+    0xcd, 0xb8, 0x8d, 0x83, 0x38, 0x7d, 0x87, 0xc3, 0x9e, 0x32, 0x0c, 0xcb,
+    0xf7, 0x2a, 0x74, 0xf2, 0x0e, 0x79, 0xc4, 0xf9, 0xcc, 0x3b, 0x75, 0x1b,
+    0x9e, 0x4d, 0x31, 0x1d, 0xa5, 0x09, 0xd3, 0xb0, 0x04, 0xfc, 0xa1, 0x77,
+    0xf5, 0xe3, 0xd2, 0xcd, 0x12, 0x35, 0xf4, 0xa3, 0x69, 0x21, 0x77, 0xad,
+    0xfc, 0x41, 0xfd, 0x48, 0xc1, 0xde, 0xed, 0x0f, 0x8c, 0x5d, 0x06, 0x2d,
+    0x31, 0xbf, 0x2a, 0x61, 0xcd, 0xb1, 0xc0, 0xa1, 0x46, 0xbc, 0xda, 0x39,
+    0x12, 0xa0, 0x4f, 0xe1, 0x1c, 0xa3, 0x48, 0xf1, 0x51, 0x12, 0x99, 0x7c,
+    0x0b, 0x2b, 0x08, 0x79, 0x5b, 0x9e, 0xea, 0x0c, 0x3c, 0xfe, 0x3e, 0x08,
+    0x41, 0xd9, 0xc7, 0xa9, 0x02, 0x83, 0x0d, 0x43, 0xba, 0x25, 0xd0, 0x66,
+    0x57, 0x55, 0x4e, 0x66, 0x92, 0x02, 0x17, 0x44, 0x08, 0xcc, 0x86, 0x75,
+    0x57, 0x60, 0x71, 0x0b, 0xe3, 0x83, 0x1b, 0x66, 0xe4, 0xf4, 0x75, 0x80,
+    0x92, 0x30, 0x2e, 0x44, 0x11, 0xcc, 0x64, 0xa8, 0x24, 0xd8, 0x56, 0xa8,
+    0x6b, 0x60, 0x0a, 0x61, 0x4a, 0x20, 0x1a, 0xc0, 0x56, 0xc3, 0xa4, 0xb8,
+    0x20, 0xb6, 0x43, 0x5a, 0x8b, 0x40, 0xbd, 0xc7, 0x33, 0xe8, 0x05, 0x45,
+    0x38, 0x50, 0x3d, 0x47, 0x28, 0x1c, 0xf9, 0x1f, 0xc0, 0xbc, 0x01, 0xd3,
+    0x21, 0xcd, 0x1f, 0xf6, 0xbb, 0xca, 0x09, 0x2f, 0x09, 0x0b, 0xc1, 0x24,
+    0xed, 0x28, 0xeb, 0x7b, 0x08, 0x0c, 0x00, 0x00, 0x00, 0xff, 0xff, 0xa2,
+    0x27, 0xc6, 0xe5, 0x38, 0x88, 0xe7, 0x20, 0x64, 0x5d, 0x0a, 0x53, 0xcb,
+    0x84, 0x8b, 0xf6, 0x6c, 0xc3, 0x93, 0x86, 0xc5, 0xd7, 0x1d, 0x8e, 0x17,
+    0xd3, 0xec, 0x4b, 0x40, 0x78, 0xad, 0xca, 0x4d, 0xad, 0x8a, 0xed, 0xd7,
+    0xfb, 0x29, 0xa6, 0x7d, 0x88, 0x02, 0x9c, 0x44, 0x81, 0xe5, 0x45, 0xe7,
+    0x64, 0x17, 0x60, 0xe2, 0xb2, 0xf3, 0xce, 0x07, 0x98, 0x81, 0x44, 0x49,
+    0x1e, 0xf3, 0x29, 0x95, 0x59, 0x81, 0x6b, 0x49, 0xa1, 0xb3, 0x90, 0x01,
+    0x2c, 0xf9, 0x4e, 0x7c, 0x15, 0x7b, 0xd2, 0x16, 0x2f, 0x71, 0x57, 0xea,
+    0xd1, 0x1d, 0xf3, 0x0d, 0x47, 0x2d, 0x2e, 0x15, 0x00, 0x29, 0x67, 0xb9,
+    0x6a, 0x98, 0x4e, 0x18, 0x3d, 0x7f, 0x26, 0x4f, 0x2d, 0x16, 0x74, 0x04,
+    0x37, 0x10, 0x0e, 0xfa, 0x4c, 0xad, 0x20, 0x1f, 0xcc, 0x74, 0xe5, 0xd3,
+    0x6b, 0x27, 0x6e, 0xbb, 0xdf, 0x10, 0x84, 0x91, 0x0a, 0xb0, 0xc8, 0xa3,
+    0x25, 0x01, 0x8b, 0x95, 0x2b, 0x57, 0xee, 0xd2, 0x0f, 0xc0, 0xf2, 0x14,
+    0x08, 0xc3, 0x4b, 0x50, 0x70, 0x51, 0x0e, 0x2d, 0x41, 0xa1, 0xd5, 0x01,
+    0x17, 0x4a, 0x2d, 0x84, 0x54, 0xbb, 0x40, 0x95, 0xa1, 0x27, 0xad, 0xa3,
+    0x0f, 0xb3, 0xc9, 0x46, 0x57, 0x06, 0x1b, 0x80, 0x79, 0x6a, 0x69, 0xcb,
+    0xca, 0x3f, 0xc7, 0x17, 0x32, 0x0e, 0x02, 0x82, 0x50, 0x65, 0x01, 0x73,
+    0x71, 0xdb, 0x30, 0x04, 0xbc, 0xcf, 0x08, 0x43, 0xf4, 0x16, 0x0f, 0x34,
+    0x95, 0x3e, 0xff, 0xf6, 0xaa, 0xdb, 0x89, 0x72, 0x82, 0x65, 0xfe, 0xea,
+    0x17, 0x75, 0x6e, 0x1d, 0x23, 0x99, 0x82, 0xb4, 0x37, 0x34, 0xb7, 0xdc,
+    0xdf, 0x78, 0x26, 0xbb, 0x38, 0x7a, 0xb8, 0xd2, 0xfc, 0xbe, 0x15, 0x96,
+    0x77, 0xe8, 0x44, 0x58, 0x13, 0x5b, 0x55, 0xcc, 0xda, 0xc7, 0x0f, 0x09,
+    0x7d, 0x70, 0x31, 0x8d, 0x56, 0x24, 0xa3, 0xb5, 0xd8, 0xd1, 0x64, 0xb9,
+    0xe0, 0xcd, 0x75, 0x58, 0x01, 0x01, 0x55, 0xcf, 0x05, 0x6a, 0xb8, 0x83,
+    0x4a, 0x78, 0x58, 0xfb, 0x1d, 0x51, 0xd6, 0x83, 0x39, 0xd0, 0x46, 0x26,
+    0xd8, 0x46, 0xb0, 0x12, 0x14, 0x59, 0x44, 0x9f, 0x83, 0x0b, 0xb9, 0x35,
+    0x0a, 0x96, 0xc3, 0xde, 0x77, 0xc8, 0x84, 0x50, 0xe5, 0x58, 0xc1, 0xff,
+    0xbb, 0xf2, 0x54, 0x07, 0x54, 0xad, 0x0f, 0x56, 0x9c, 0x79, 0xf1, 0x7a,
+    0x48, 0x61, 0x16, 0x68, 0x34, 0xc3, 0x62, 0x2d, 0x3b, 0x6b, 0x28, 0x42,
+    0x93, 0x9a, 0x7c, 0x6c, 0xe8, 0xda, 0xed, 0x4d, 0x27, 0xf5, 0x94, 0x91,
+    0xf1, 0xc5, 0x51, 0x80, 0x1d, 0xe8, 0x0f, 0x1e, 0x00, 0x4d, 0x91, 0x22,
+    0xf5, 0xd7, 0xca, 0x1f, 0x10, 0x85, 0xbd, 0xbf, 0x90, 0x05, 0x36, 0xa5,
+    0x56, 0x60, 0xeb, 0xc8, 0xac, 0x1b, 0x22, 0x20, 0x01, 0x96, 0x65, 0x37,
+    0x3c, 0x9b, 0x62, 0x7a, 0x3e, 0xf3, 0x4e, 0x1d, 0x0e, 0x1a, 0x1a, 0x9c,
+    0x31, 0xff, 0x75, 0xd5, 0x13, 0xa6, 0x35, 0xb6, 0x59, 0x05, 0xfd, 0x2e,
+    0x79, 0x8f, 0x95, 0x9e, 0x0d, 0x2b, 0x88, 0x5d, 0xe6, 0x6d, 0x9a, 0x14,
+    0x8a, 0x8d, 0x60, 0xf5, 0xf5, 0x58, 0x0d, 0x23, 0x90, 0x8b, 0xf3, 0x02,
+    0x44, 0x5f, 0x92, 0x08, 0x8a, 0xf8, 0xee, 0x26, 0x36, 0x74, 0xaf, 0x8c,
+    0x24, 0x44, 0x74, 0x22, 0x22, 0x98, 0xc8, 0xda, 0x1f, 0x18, 0xbb, 0x90,
+    0x4f, 0x40, 0x02, 0x0a, 0x5a, 0xd6, 0x2e, 0x81, 0xc6, 0x09, 0xfb, 0x9f,
+    0x18, 0x79, 0x3a, 0xe0, 0xed, 0xd7, 0xc3, 0xc9, 0x43, 0x50, 0x67, 0xae,
+    0x10, 0x44, 0xed, 0xf3, 0x92, 0x4f, 0x3a, 0xdc, 0x10, 0x0a, 0xa9, 0x4d,
+    0x3f, 0xc3, 0x36, 0x4a, 0x13, 0xa4, 0x23, 0x24, 0x6f, 0x91, 0x8f, 0x60,
+    0x45, 0x03, 0x8c, 0x06, 0x35, 0xcf, 0x38, 0xa0, 0xb1, 0xb9, 0x63, 0x6e,
+    0xee, 0xeb, 0x13, 0xbb, 0x47, 0xc9, 0x1d, 0x73, 0x53, 0xa0, 0x21, 0x72,
+    0x09, 0x77, 0xe1, 0x49, 0x13, 0x1a, 0xd6, 0xf0, 0x65, 0xd9, 0x79, 0x1b,
+    0xda, 0xe6, 0x85, 0x46, 0x53, 0xd1, 0x39, 0xd9, 0x05, 0x45, 0xe7, 0x60,
+    0x2d, 0xfa, 0x92, 0x3c, 0xe6, 0x53, 0x2a, 0xb3, 0x02, 0xd7, 0x92, 0x42,
+    0x67, 0x21, 0x03, 0x58, 0xe9, 0x3a, 0xf1, 0x55, 0xec, 0x49, 0x5b, 0xbc,
+    0xc4, 0x5d, 0xa9, 0x47, 0xc4, 0x97, 0xcf, 0x2b, 0xb1, 0xd5, 0x9a, 0x44,
+    0x02, 0xe1, 0xa0, 0xcf, 0x2a, 0x37, 0xb5, 0x2a, 0xb6, 0x5f, 0xef, 0x5f,
+    0x3b, 0x34, 0x69, 0x58, 0xdc, 0xd5, 0x1d, 0xc2, 0x05, 0x65, 0xf5, 0xa7,
+    0x34, 0x72, 0x4f, 0x19, 0xc4, 0x24, 0x34, 0xd5, 0x43, 0x92, 0x5e, 0xd9,
+    0xc7, 0xa9, 0x02, 0x03, 0x82, 0x37, 0x0c, 0x4b, 0x00, 0x09, 0x54, 0x68,
+    0x08, 0xcf, 0x94, 0xdb, 0xbd, 0xe1, 0xdd, 0xd3, 0x9a, 0x43, 0x33, 0x4f,
+    0x6e, 0x89, 0x0b, 0x3d, 0xf5, 0xe0, 0xe4, 0x16, 0x2b, 0xa8, 0x44, 0xda,
+    0xb9, 0xa4, 0x98, 0x21, 0x81, 0x4f, 0xdf, 0xe1, 0xb0, 0x27, 0x12, 0xbf,
+    0x98, 0x66, 0x5f, 0x02, 0xf1, 0xfd, 0x3a, 0x4f, 0xd6, 0xb4, 0x42, 0x5a,
+    0x12, 0x93, 0xa0, 0xc1, 0x78, 0xb5, 0x70, 0xdd, 0xa2, 0x73, 0x07, 0x96,
+    0x78, 0xe3, 0xa4, 0xc1, 0xc5, 0x29, 0x12, 0xd6, 0xbd, 0xc1, 0xeb, 0x46,
+    0x3e, 0xfe, 0x57, 0xc9, 0xb3, 0x76, 0x29, 0xbd, 0x08, 0x00, 0x00, 0x00,
+    0x00, 0xff, 0xff, 0x03, 0x00, 0x6d, 0x8b, 0x56, 0x83
+};
+
+static const fsw_u8 stream_stored[1511] = {
+    0x78, 0x01, 0x01, 0xdc, 0x05, 0x23, 0xfa, 0x34, 0x30, 0x39, 0x36, 0x20,
+    0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x0a, 0x34, 0x30, 0x39, 0x36, 0x20, 0x7a, 0x6c, 0x69,
+    0x62, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x0a, 0x0a, 0x65, 0x78,
+    0x74, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x34,
+    0x30, 0x39, 0x36, 0x20, 0x0a, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65,
+    0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x62, 0x6c, 0x6f,
+    0x63, 0x6b, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x69, 0x6e, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x62,
+    0x74, 0x72, 0x66, 0x73, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e,
+    0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x64, 0x65, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x7a, 0x6c,
+    0x69, 0x62, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x74,
+    0x72, 0x66, 0x73, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x68,
+    0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e,
+    0x74, 0x20, 0x0a, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x65,
+    0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74,
+    0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77,
+    0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x69, 0x6e, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x0a, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61,
+    0x6e, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73,
+    0x20, 0x0a, 0x0a, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x34,
+    0x30, 0x39, 0x36, 0x20, 0x0a, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x62,
+    0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x68, 0x75,
+    0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x69, 0x6e, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20,
+    0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x34, 0x30, 0x39, 0x36,
+    0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x7a, 0x6c, 0x69, 0x62,
+    0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x68, 0x75, 0x66,
+    0x66, 0x6d, 0x61, 0x6e, 0x20, 0x0a, 0x0a, 0x62, 0x6c, 0x6f, 0x63, 0x6b,
+    0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x34, 0x30, 0x39,
+    0x36, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x62, 0x6c,
+    0x6f, 0x63, 0x6b, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x69, 0x6e, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77,
+    0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74,
+    0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x34, 0x30, 0x39, 0x36,
+    0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x62, 0x74, 0x72, 0x66,
+    0x73, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x62, 0x74,
+    0x72, 0x66, 0x73, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x62, 0x6c, 0x6f,
+    0x63, 0x6b, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x7a, 0x6c, 0x69,
+    0x62, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e,
+    0x74, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f,
+    0x77, 0x20, 0x0a, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x77, 0x69, 0x6e,
+    0x64, 0x6f, 0x77, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20,
+    0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x68, 0x75, 0x66, 0x66,
+    0x6d, 0x61, 0x6e, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x62, 0x6c, 0x6f,
+    0x63, 0x6b, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x34, 0x30,
+    0x39, 0x36, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x62, 0x6c, 0x6f, 0x63,
+    0x6b, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x0a, 0x65,
+    0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20,
+    0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73,
+    0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x77, 0x69, 0x6e,
+    0x64, 0x6f, 0x77, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x68,
+    0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x0a, 0x68,
+    0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x0a, 0x64, 0x65, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x0a,
+    0x0a, 0x34, 0x30, 0x39, 0x36, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x64,
+    0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20,
+    0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x62, 0x74, 0x72, 0x66,
+    0x73, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x6c, 0x6f,
+    0x63, 0x6b, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e,
+    0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x65, 0x78, 0x74, 0x65,
+    0x6e, 0x74, 0x20, 0x0a, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20,
+    0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x0a, 0x0a, 0x0a, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x0a,
+    0x7a, 0x6c, 0x69, 0x62, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x7a, 0x6c,
+    0x69, 0x62, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x7a,
+    0x6c, 0x69, 0x62, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x62, 0x74,
+    0x72, 0x66, 0x73, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x69, 0x6e, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x77, 0x69,
+    0x6e, 0x64, 0x6f, 0x77, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x34, 0x30, 0x39, 0x36, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65,
+    0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x62,
+    0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20,
+    0x7a, 0x6c, 0x69, 0x62, 0x20, 0x0a, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20,
+    0x7a, 0x6c, 0x69, 0x62, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65,
+    0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x69, 0x6e, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x34, 0x30, 0x39, 0x36, 0x20, 0x62, 0x74,
+    0x72, 0x66, 0x73, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x77, 0x69,
+    0x6e, 0x64, 0x6f, 0x77, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x77, 0x69,
+    0x6e, 0x64, 0x6f, 0x77, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e,
+    0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x7a, 0x6c,
+    0x69, 0x62, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x68, 0x75,
+    0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x34, 0x30, 0x39, 0x36,
+    0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x0a, 0x62, 0x74,
+    0x72, 0x66, 0x73, 0x20, 0x0a, 0x34, 0x30, 0x39, 0x36, 0x20, 0x7a, 0x6c,
+    0x69, 0x62, 0x20, 0x0a, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x65, 0x78,
+    0x74, 0x65, 0x6e, 0x74, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x0a, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e,
+    0x74, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x7a, 0x6c,
+    0x69, 0x62, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x69,
+    0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d,
+    0x61, 0x6e, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20, 0x65, 0x78, 0x74,
+    0x65, 0x6e, 0x74, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20,
+    0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x62, 0x74, 0x72, 0x66, 0x73, 0x20,
+    0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x0a, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x77,
+    0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61,
+    0x6e, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x65, 0x78,
+    0x74, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65,
+    0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x69, 0x6e, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20,
+    0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f,
+    0x77, 0x20, 0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x77, 0x69,
+    0x6e, 0x64, 0x6f, 0x77, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x0a,
+    0x34, 0x30, 0x39, 0x36, 0x20, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x74, 0x20,
+    0x68, 0x75, 0x66, 0x66, 0x6d, 0x61, 0x6e, 0x20, 0x77, 0x69, 0x6e, 0x64,
+    0x6f, 0x77, 0x20, 0x0a, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x64, 0x65, 0x66,
+    0x6c, 0x61, 0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x0a, 0x68, 0x75, 0x66,
+    0x66, 0x6d, 0x61, 0x6e, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65,
+    0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20,
+    0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61,
+    0x74, 0x65, 0x20, 0x7a, 0x6c, 0x69, 0x62, 0x20, 0x77, 0x69, 0x6e, 0x64,
+    0x6f, 0x77, 0x20, 0x68, 0x75, 0x66, 0x66, 0xca, 0x53, 0x11, 0x64
+};
+
+static const fsw_u8 stream_dict[68] = {
+    0x78, 0xbb, 0x24, 0x21, 0x04, 0xfa, 0x33, 0x31, 0xb0, 0x34, 0x53, 0x28,
+    0xcf, 0xcc, 0x4b, 0xc9, 0x2f, 0x57, 0x48, 0x49, 0x4d, 0xcb, 0x49, 0x2c,
+    0x49, 0x55, 0xe0, 0x02, 0x0b, 0x56, 0xe5, 0x64, 0x26, 0x29, 0x24, 0x81,
+    0xd5, 0x72, 0x71, 0x41, 0x55, 0x43, 0xb8, 0x60, 0x69, 0x2e, 0x98, 0x6a,
+    0x18, 0x9d, 0x94, 0x93, 0x9f, 0x9c, 0x0d, 0x91, 0xcb, 0xcc, 0x83, 0x08,
+    0x41, 0xcd, 0x05, 0x00, 0x41, 0xd0, 0x20, 0x7d
+};
+
+static fsw_u8 data[DATA_SIZE];
+
+struct vector {
+    const char *name;
+    const fsw_u8 *stream;
+    unsigned stream_size;
+    unsigned data_size;
+};
+
+static struct vector vectors[] = {
+    { "dynamic", stream_dynamic, sizeof(stream_dynamic), DATA_SIZE },
+    { "fixed", stream_fixed, sizeof(stream_fixed), DATA_SIZE },
+    { "4 KiB window", stream_window4k, sizeof(stream_window4k), DATA_SIZE },
+    { "stored", stream_stored, sizeof(stream_stored), STORED_SIZE },
+};
+
+#define NVECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+/* the inline extent path: osize bytes from offset off in one call */
+static int check_oneshot(struct vector *v, unsigned off, unsigned osize)
+{
+    static char ibuf[4096], obuf[DATA_SIZE + 64];
+    fsw_ssize_t ret;
+    unsigned want = off >= v->data_size ? 0 : v->data_size - off;
+
+    if (want > osize)
+        want = osize;
+    memcpy(ibuf, v->stream, v->stream_size);
+    memset(obuf, 0xAA, sizeof(obuf));
+    ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, v->stream_size, off, obuf, osize, NULL);
+    if (off >= v->data_size)
+        return ret <= 0;
+    return ret == (fsw_ssize_t)want && memcmp(obuf, data + off, want) == 0
+        && (fsw_u8)obuf[osize] == 0xAA;
+}
+
+/* the regular extent path: one stream, read in pieces of the given size */
+static int check_pieces(struct vector *v, unsigned piece)
+{
+    static char ibuf[4096], obuf[DATA_SIZE + 65536 + 1];
+    struct btrfs_decomp_stream ds;
+    unsigned pos = 0;
+    fsw_ssize_t ret;
+    int ok = 1;
+
+    memcpy(ibuf, v->stream, v->stream_size);
+    memset(obuf, 0xAA, sizeof(obuf));
+    if (btrfs_stream_open(&ds, GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, v->stream_size, NULL) != FSW_SUCCESS)
+        return 0;
+    do {
+        ret = btrfs_stream_read(&ds, obuf + pos, piece);
+        if (ret < 0 || ret > (fsw_ssize_t)piece)
+            ok = 0;
+        else
+            pos += ret;
+    } while (ok && ret == (fsw_ssize_t)piece && pos <= DATA_SIZE);
+    btrfs_stream_close(&ds);
+
+    return ok && pos == v->data_size && ds.pos == pos && memcmp(obuf, data, pos) == 0
+        && (fsw_u8)obuf[pos] == 0xAA;
+}
+
+static void test_vectors(void)
+{
+    static const unsigned offsets[] = { 0, 1, 1499, 1500, 4096, 32768, 39999, 40000 };
+    static const unsigned sizes[] = { 1, 7, 100, 4096, 40000 };
+    static const unsigned pieces[] = { 1, 3, 8, 1000, 4096, 40000, 65536 };  // obuf: DATA_SIZE + largest piece
+    unsigned i, k, n;
+    char what[80];
+    int ok;
+
+    make_data(data, DATA_SIZE);
+
+    for (i = 0; i < NVECTORS; i++) {
+        for (ok = 1, k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++)
+            for (n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+                if (!check_oneshot(&vectors[i], offsets[k] % (vectors[i].data_size + 1), sizes[n]))
+                    ok = 0;
+        snprintf(what, sizeof(what), "%s: one-shot reads at an offset", vectors[i].name);
+        check(ok, what);
+        for (ok = 1, k = 0; k < sizeof(pieces) / sizeof(pieces[0]); k++)
+            if (!check_pieces(&vectors[i], pieces[k]))
+                ok = 0;
+        snprintf(what, sizeof(what), "%s: stream read in pieces", vectors[i].name);
+        check(ok, what);
+    }
+
+    // random piece sizes, so reads end at every point of a match or a block
+    for (ok = 1, i = 0; i < NVECTORS; i++) {
+        static char ibuf[4096], obuf[DATA_SIZE + 512];
+        struct btrfs_decomp_stream ds;
+        unsigned pos = 0, piece;
+        fsw_ssize_t ret;
+
+        rnd_state = 5 + i;
+        memcpy(ibuf, vectors[i].stream, vectors[i].stream_size);
+        if (btrfs_stream_open(&ds, GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, vectors[i].stream_size, NULL) != FSW_SUCCESS) {
+            ok = 0;
+            continue;
+        }
+        do {
+            piece = 1 + rnd() % 500;
+            ret = btrfs_stream_read(&ds, obuf + pos, piece);
+            if (ret > 0)
+                pos += ret;
+        } while (ret == (fsw_ssize_t)piece && pos <= DATA_SIZE);
+        btrfs_stream_close(&ds);
+        if (ret < 0 || pos != vectors[i].data_size || memcmp(obuf, data, pos) != 0)
+            ok = 0;
+    }
+    check(ok, "stream read in random pieces");
+
+    // a preset dictionary is not something btrfs writes: refused
+    {
+        static char ibuf[sizeof(stream_dict)], obuf[100];
+        memcpy(ibuf, stream_dict, sizeof(stream_dict));
+        check(btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, sizeof(ibuf), 0, obuf, 100, NULL) < 0,
+              "preset dictionary refused");
+    }
+}
+
+static void test_damaged(void)
+{
+    static char ibuf[4096], obuf[DATA_SIZE + 64];
+    unsigned i, size, bad = 0, overrun = 0;
+    fsw_ssize_t ret;
+
+    // a truncated stream gives a prefix of the data, never anything else
+    for (size = 0; size < sizeof(stream_dynamic); size++) {
+        memcpy(ibuf, stream_dynamic, size);
+        ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, size, 0, obuf, DATA_SIZE, NULL);
+        if (ret > 0 && memcmp(obuf, data, ret) != 0)
+            bad++;
+    }
+    check(bad == 0, "truncated stream");
+
+    // zlib streams carry no checksum btrfs looks at, so a changed byte may
+    // go unnoticed; the inflater must still stay within its buffers
+    for (i = 0; i < sizeof(stream_dynamic) + sizeof(stream_fixed); i++) {
+        const fsw_u8 *s = i < sizeof(stream_dynamic) ? stream_dynamic : stream_fixed;
+        unsigned n = i < sizeof(stream_dynamic) ? i : i - sizeof(stream_dynamic);
+
+        size = i < sizeof(stream_dynamic) ? sizeof(stream_dynamic) : sizeof(stream_fixed);
+        memcpy(ibuf, s, size);
+        ibuf[n] ^= 1 << (i % 8);
+        memset(obuf, 0xAA, sizeof(obuf));
+        ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, size, 0, obuf, 30000, NULL);
+        if (ret > 30000 || (fsw_u8)obuf[30000] != 0xAA)
+            overrun++;
+    }
+    check(overrun == 0, "damaged streams stay within the output buffer");
+}
+
+//
+// benchmark: one-shot extent reads and 4 KiB stream reads
+//
+
+static void bench_inflate(void)
+{
+    static char ibuf[4096], obuf[DATA_SIZE];
+    struct btrfs_decomp_stream ds;
+    clock_t start;
+    double secs;
+    int round, rounds = 0;
+    unsigned pos;
+
+    memcpy(ibuf, stream_dynamic, sizeof(stream_dynamic));
+    start = clock();
+    do {
+        for (round = 0; round < 256; round++)
+            btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, sizeof(stream_dynamic), 0, obuf, DATA_SIZE, NULL);
+        rounds += 256;
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (secs < 1.0);
+    printf("inflate: %.0f MB/s (one-shot)\n", (double)rounds * DATA_SIZE / 1e6 / secs);
+
+    rounds = 0;
+    start = clock();
+    do {
+        for (round = 0; round < 256; round++) {
+            btrfs_stream_open(&ds, GRUB_BTRFS_COMPRESSION_ZLIB, ibuf, sizeof(stream_dynamic), NULL);
+            for (pos = 0; pos < DATA_SIZE; pos += 4096)
+                btrfs_stream_read(&ds, obuf + pos, DATA_SIZE - pos < 4096 ? DATA_SIZE - pos : 4096);
+            btrfs_stream_close(&ds);
+        }
+        rounds += 256;
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (secs < 1.0);
+    printf("inflate: %.0f MB/s (4 KiB reads)\n", (double)rounds * DATA_SIZE / 1e6 / secs);
+}
+
+int main(int argc, char **argv)
+{
+    test_vectors();
+    test_damaged();
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        bench_inflate();
+
+    if (failures) {
+        printf("inflatetest: %d failures\n", failures);
+        return 1;
+    }
+    printf("inflatetest: ok\n");
+    return 0;
+}
+
+// EOF
@@ -0,0 +1,515 @@
+/**
+ * \file ntfstest.c
+ * Checks the NTFS LZNT1 decoder and the per-dnode cache of decompressed
+ * compression units against a compressed file on an in-memory disk.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../fsw_ntfs.c"
+
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static fsw_u32 rnd_state = 0x12345678;
+
+static fsw_u32 rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+//
+// reference decoder: the byte-at-a-time loop the driver used before
+//
+
+static int ref_decomp_1page(fsw_u8 *src, int slen, fsw_u8 *dst)
+{
+    int soff = 0;
+    int doff = 0;
+
+    while (soff < slen) {
+        int j;
+        int tag = src[soff++];
+        for (j = 0; j < 8 && soff < slen; j++) {
+            if (tag & (1 << j)) {
+                int len, back, bits;
+
+                if (!doff || soff + 2 > slen)
+                    return -1;
+                len = GETU16(src, soff); soff += 2;
+                bits = __builtin_clz(((doff - 1) >> 3) | 1) - 19;
+                back = (len >> bits) + 1;
+                len = (len & ((1 << bits) - 1)) + 3;
+                if (doff < back || doff + len > 0x1000)
+                    return -1;
+                while (len-- > 0) {
+                    dst[doff] = dst[doff - back];
+                    doff++;
+                }
+            } else {
+                if (doff >= 0x1000)
+                    return -1;
+                dst[doff++] = src[soff++];
+            }
+        }
+    }
+    return doff;
+}
+
+//
+// greedy LZNT1 compressor for building test data
+//
+
+#define HASH_SIZE   (1 << 12)
+
+static int lznt1_hash(const fsw_u8 *p)
+{
+    return ((p[0] << 8) ^ (p[1] << 4) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+/* compress one page of up to 4096 bytes into a chunk with its header */
+static int lznt1_compress_chunk(const fsw_u8 *src, int n, fsw_u8 *dst)
+{
+    static int head[HASH_SIZE];
+    static int prev[0x1000];
+    int soff = 0, doff = 2, tagpos, j, i;
+
+    for (i = 0; i < HASH_SIZE; i++)
+        head[i] = -1;
+
+    while (soff < n) {
+        fsw_u8 tag = 0;
+
+        tagpos = doff++;
+        for (j = 0; j < 8 && soff < n; j++) {
+            int bestlen = 0, bestback = 0;
+
+            if (soff > 0 && soff + 3 <= n) {
+                int bits = __builtin_clz(((soff - 1) >> 3) | 1) - 19;
+                int maxback = 1 << (16 - bits);
+                int maxlen = (1 << bits) + 2;
+                int cand, chain = 32;
+
+                // distances below three are not hashed; try them directly
+                for (cand = soff - 1; cand >= soff - 2 && cand >= 0; cand--) {
+                    int len = 0;
+                    while (soff + len < n && len < maxlen && src[cand + len] == src[soff + len])
+                        len++;
+                    if (len > bestlen) {
+                        bestlen = len;
+                        bestback = soff - cand;
+                    }
+                }
+                for (cand = head[lznt1_hash(src + soff)]; cand >= 0 && chain > 0; cand = prev[cand], chain--) {
+                    int len = 0;
+                    if (soff - cand > maxback)
+                        break;
+                    while (soff + len < n && len < maxlen && src[cand + len] == src[soff + len])
+                        len++;
+                    if (len > bestlen) {
+                        bestlen = len;
+                        bestback = soff - cand;
+                    }
+                }
+                if (bestlen >= 3) {
+                    fsw_u16 word = ((bestback - 1) << bits) | (bestlen - 3);
+                    tag |= 1 << j;
+                    dst[doff++] = word & 0xff;
+                    dst[doff++] = word >> 8;
+                }
+            }
+            if (bestlen < 3) {
+                bestlen = 1;
+                dst[doff++] = src[soff];
+            }
+            for (i = 0; i < bestlen; i++, soff++) {
+                if (soff + 3 <= n) {
+                    int h = lznt1_hash(src + soff);
+                    prev[soff] = head[h];
+                    head[h] = soff;
+                }
+            }
+            if (doff > 0x1000 + 2)
+                break;
+        }
+        dst[tagpos] = tag;
+        if (doff > 0x1000 + 2)
+            break;
+    }
+
+    if (doff - 2 >= n || doff > 0x1000 + 2) {
+        // store the page as it is
+        dst[0] = (n - 1) & 0xff;
+        dst[1] = 0x30 | ((n - 1) >> 8);
+        memcpy(dst + 2, src, n);
+        return n + 2;
+    }
+    dst[0] = (doff - 3) & 0xff;
+    dst[1] = 0xb0 | ((doff - 3) >> 8);
+    return doff;
+}
+
+//
+// test data
+//
+
+/* fill a page with something between text and noise, selected by kind */
+static void make_page(fsw_u8 *p, int kind)
+{
+    static const char *words[] = { "boot", "loader", "rEFInd ", "\\EFI\\", "volume ",
+                                   "cluster", "0000", "ntfs ", "\r\n", "compressed " };
+    int i = 0, k;
+
+    switch (kind) {
+    case 0:     // words from a small vocabulary: long distance matches
+        while (i < 0x1000) {
+            const char *w = words[rnd() % 10];
+            for (k = 0; w[k] && i < 0x1000; k++)
+                p[i++] = w[k];
+        }
+        break;
+    case 1:     // runs and short periods: overlapping matches
+        while (i < 0x1000) {
+            int period = 1 + rnd() % 7, len = 3 + rnd() % 200;
+            fsw_u8 pat[8];
+            for (k = 0; k < period; k++)
+                pat[k] = rnd();
+            for (k = 0; k < len && i < 0x1000; k++)
+                p[i++] = pat[k % period];
+        }
+        break;
+    case 2:     // noise with a few repeats
+        for (i = 0; i < 0x1000; i++)
+            p[i] = (rnd() % 5 == 0 && i > 64) ? p[i - 1 - rnd() % 64] : rnd();
+        break;
+    default:    // plain noise
+        for (i = 0; i < 0x1000; i++)
+            p[i] = rnd();
+        break;
+    }
+}
+
+static void test_decoder(void)
+{
+    static fsw_u8 page[0x1000], chunk[0x1100], out1[0x1000], out2[0x1000];
+    int round, kind, n, r1, r2, slen;
+
+    for (round = 0; round < 2000; round++) {
+        kind = round % 4;
+        make_page(page, kind);
+        n = lznt1_compress_chunk(page, 0x1000, chunk);
+        if (!(chunk[1] & 0x80))
+            continue;
+        slen = n - 2;
+        memset(out1, 0xAA, sizeof(out1));
+        r1 = ntfs_decomp_1page(chunk + 2, slen, out1);
+        if (r1 != 0x1000 || memcmp(out1, page, 0x1000)) {
+            check(0, "decoder: page roundtrip");
+            return;
+        }
+
+        // damaged input must be handled exactly like the reference does
+        chunk[2 + rnd() % slen] ^= 1 << (rnd() % 8);
+        slen -= rnd() % 4;
+        memset(out1, 0, sizeof(out1));
+        memset(out2, 0, sizeof(out2));
+        r1 = ntfs_decomp_1page(chunk + 2, slen, out1);
+        r2 = ref_decomp_1page(chunk + 2, slen, out2);
+        if (r1 != r2 || (r1 > 0 && memcmp(out1, out2, r1))) {
+            check(0, "decoder: damaged page against the reference");
+            return;
+        }
+    }
+}
+
+//
+// in-memory disk holding a compressed file
+//
+
+#define CLBITS      (12)
+#define NUNITS      (10)
+#define FILE_SIZE   (((NUNITS - 1) * 16 + 5) * 4096 + 100)
+#define DISK_SIZE   (NUNITS * 16 * 4096)
+
+static fsw_u8 file_data[NUNITS * 16 * 4096];
+static fsw_u8 disk[DISK_SIZE];
+static fsw_u32 disk_reads;
+
+static void EFIAPI mem_change_blocksize(struct fsw_volume *vol,
+                                        fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
+                                        fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize)
+{
+}
+
+static fsw_status_t EFIAPI mem_read_block(struct fsw_volume *vol, fsw_u64 phys_bno, void *buffer)
+{
+    if ((phys_bno + 1) * vol->phys_blocksize > DISK_SIZE)
+        return FSW_IO_ERROR;
+    memcpy(buffer, disk + phys_bno * vol->phys_blocksize, vol->phys_blocksize);
+    disk_reads++;
+    return FSW_SUCCESS;
+}
+
+static struct fsw_host_table mem_host_table = {
+    FSW_STRING_TYPE_ISO88591,
+    mem_change_blocksize,
+    mem_read_block
+};
+
+static struct fsw_ntfs_volume *vol;
+static struct fsw_ntfs_dnode *dno;
+
+/*
+ * Lay out the file unit by unit: compressible units as LZNT1 clusters followed
+ * by a sparse tail, incompressible ones as 16 plain clusters, and zero units as
+ * one sparse run. The last unit is cut short by the file size.
+ */
+static void build_file(void)
+{
+    static fsw_u8 unit[17 * 4096];
+    struct extent_slot *e;
+    fsw_u64 lcn = 1;
+    int u, p, n, used, clusters, npage;
+
+    vol = calloc(1, sizeof(*vol));
+    dno = calloc(1, sizeof(*dno));
+    vol->g.host_table = &mem_host_table;
+    vol->clbits = CLBITS;
+    fsw_set_blocksize(&vol->g, 1 << CLBITS, 1 << CLBITS);
+
+    e = calloc(2 * NUNITS, sizeof(*e));
+    dno->runlist.extent = e;
+    dno->runlist.total = 2 * NUNITS;
+    dno->has_runlist = 1;
+    dno->compressed = 1;
+    dno->fsize = dno->finited = FILE_SIZE;
+
+    for (u = 0; u < NUNITS; u++) {
+        fsw_u8 *data = file_data + u * 16 * 4096;
+        int kind = u == NUNITS - 1 ? 0 : u % 4 == 3 ? 3 : u % 5 == 4 ? 4 : u % 3;
+
+        npage = 16;
+        if (u == NUNITS - 1)
+            npage = (FILE_SIZE - u * 16 * 4096 + 4095) >> 12;
+        for (p = 0; p < npage; p++) {
+            if (kind == 4)
+                memset(data + p * 4096, 0, 4096);
+            else
+                make_page(data + p * 4096, kind);
+        }
+        if (u == NUNITS - 1)
+            memset(file_data + FILE_SIZE, 0, sizeof(file_data) - FILE_SIZE);
+
+        if (kind == 4) {
+            // nothing stored at all
+            e[dno->runlist.used++] = (struct extent_slot){ u * 16, 0, 16 };
+            continue;
+        }
+
+        used = 0;
+        for (p = 0; p < npage; p++) {
+            n = lznt1_compress_chunk(data + p * 4096, 4096, unit + used);
+            used += n;
+        }
+        clusters = (used + 4095) >> 12;
+        if (clusters >= 16) {
+            memcpy(disk + lcn * 4096, data, 16 * 4096);
+            e[dno->runlist.used++] = (struct extent_slot){ u * 16, lcn, 16 };
+            lcn += 16;
+        } else {
+            memset(unit + used, 0, clusters * 4096 - used);
+            memcpy(disk + lcn * 4096, unit, clusters * 4096);
+            e[dno->runlist.used++] = (struct extent_slot){ u * 16, lcn, clusters };
+            e[dno->runlist.used++] = (struct extent_slot){ u * 16 + clusters, 0, 16 - clusters };
+            lcn += clusters;
+        }
+    }
+}
+
+/* read one cluster through the driver and compare it with the file data */
+static int read_cluster(fsw_u64 vcn)
+{
+    struct fsw_extent extent;
+    fsw_u8 *block;
+    fsw_status_t status;
+    int ok = 1, i;
+
+    memset(&extent, 0, sizeof(extent));
+    extent.log_start = vcn;
+    status = fsw_ntfs_get_extent_compressed(vol, dno, &extent);
+    if (status != FSW_SUCCESS)
+        return 0;
+    if (extent.log_count < 1 || extent.log_start != vcn)
+        return 0;
+
+    switch (extent.type) {
+    case FSW_EXTENT_TYPE_PHYSBLOCK:
+        for (i = 0; i < (int)extent.log_count && ok; i++) {
+            if (fsw_block_get(&vol->g, extent.phys_start + i, 0, (void **)&block) != FSW_SUCCESS)
+                return 0;
+            ok = memcmp(block, file_data + (vcn + i) * 4096, 4096) == 0;
+            fsw_block_release(&vol->g, extent.phys_start + i, block);
+        }
+        break;
+    case FSW_EXTENT_TYPE_SPARSE:
+        for (i = 0; i < (int)extent.log_count * 4096 && ok; i++)
+            ok = file_data[vcn * 4096 + i] == 0;
+        break;
+    case FSW_EXTENT_TYPE_BUFFER:
+        ok = memcmp(extent.buffer, file_data + vcn * 4096, 4096) == 0;
+        if (!(extent.flags & FSW_EXTENT_FLAG_BORROWED))
+            fsw_free(extent.buffer);
+        break;
+    default:
+        ok = 0;
+    }
+    return ok;
+}
+
+static int unit_cached(int u)
+{
+    int i;
+
+    for (i = 0; i < CUNIT_CACHE_SIZE; i++)
+        if (dno->cunits[i].vcn == (fsw_u64)u * 16)
+            return 1;
+    return 0;
+}
+
+static void test_units(void)
+{
+    fsw_u64 vcn, nclusters = (FILE_SIZE + 4095) >> 12;
+    fsw_u32 reads;
+    int u, ok;
+
+    build_file();
+
+    // every cluster, front to back and back to front
+    for (ok = 1, vcn = 0; vcn < nclusters && ok; vcn++)
+        ok = read_cluster(vcn);
+    check(ok, "units: sequential read");
+    for (ok = 1, vcn = nclusters; vcn-- > 0 && ok; )
+        ok = read_cluster(vcn);
+    check(ok, "units: backward read");
+
+    // random clusters, several times over the cache size
+    for (ok = 1, u = 0; u < 4000 && ok; u++)
+        ok = read_cluster(rnd() % nclusters);
+    check(ok, "units: random read");
+
+    // the four most recently used units stay, the fifth pushes out the oldest
+    read_cluster(0 * 16);
+    read_cluster(1 * 16);
+    read_cluster(2 * 16);
+    read_cluster(5 * 16);
+    check(unit_cached(0) && unit_cached(1) && unit_cached(2) && unit_cached(5), "units: four units kept");
+    read_cluster(0 * 16 + 3);
+    read_cluster(6 * 16);
+    check(unit_cached(0) && !unit_cached(1) && unit_cached(6), "units: least recently used unit evicted");
+
+    // a hit is served from the cache without touching the disk
+    reads = disk_reads;
+    for (ok = 1, vcn = 0; vcn < 16 && ok; vcn++)
+        ok = read_cluster(0 * 16 + vcn) && read_cluster(6 * 16 + vcn);
+    check(ok && disk_reads == reads, "units: cached units read no clusters");
+
+    // a damaged unit reports corruption every time, also from the cache
+    memset(disk + dno->runlist.extent[0].lcn * 4096, 0xff, 8);
+    for (u = 0; u < CUNIT_CACHE_SIZE; u++)
+        dno->cunits[u].vcn = BADVCN;
+    fsw_set_blocksize(&vol->g, 1 << CLBITS, 1 << CLBITS);
+    {
+        struct fsw_extent extent;
+
+        memset(&extent, 0, sizeof(extent));
+        extent.log_start = 1;
+        check(fsw_ntfs_get_extent_compressed(vol, dno, &extent) == FSW_VOLUME_CORRUPTED &&
+              fsw_ntfs_get_extent_compressed(vol, dno, &extent) == FSW_VOLUME_CORRUPTED,
+              "units: damaged unit reported as corrupted");
+    }
+
+    fsw_ntfs_dnode_free(&vol->g, &dno->g);
+    fsw_set_blocksize(&vol->g, 1 << CLBITS, 1 << CLBITS);
+    free(dno);
+    free(vol);
+}
+
+static void bench_decoder(void)
+{
+    static fsw_u8 pages[64][0x1000], chunks[64][0x1100], out[0x1000];
+    int lens[64], i, round;
+    clock_t start;
+    double secs;
+
+    for (i = 0; i < 64; i++) {
+        make_page(pages[i], i % 3);
+        lens[i] = lznt1_compress_chunk(pages[i], 0x1000, chunks[i]) - 2;
+    }
+
+    start = clock();
+    for (round = 0; round < 400; round++)
+        for (i = 0; i < 64; i++)
+            ntfs_decomp_1page(chunks[i] + 2, lens[i], out);
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("lznt1: %.0f MB/s\n", 400 * 64 * 4096 / 1e6 / (secs > 0 ? secs : 1e-9));
+
+    start = clock();
+    for (round = 0; round < 400; round++)
+        for (i = 0; i < 64; i++)
+            ref_decomp_1page(chunks[i] + 2, lens[i], out);
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("lznt1: %.0f MB/s (byte-wise reference)\n", 400 * 64 * 4096 / 1e6 / (secs > 0 ? secs : 1e-9));
+}
+
+int main(int argc, char **argv)
+{
+    test_decoder();
+    test_units();
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        bench_decoder();
+
+    if (failures) {
+        printf("ntfstest: %d failures\n", failures);
+        return 1;
+    }
+    printf("ntfstest: ok\n");
+    return 0;
+}
+
+// EOF
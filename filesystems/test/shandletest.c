@@ -0,0 +1,367 @@
+/**
+ * \file shandletest.c
+ * Checks the block geometry copies of fsw_shandle_read against the generic one,
+ * on a file of every extent type served by an in-memory file system.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fsw_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static fsw_u32 rnd_state = 1;
+
+static fsw_u32 rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+//
+// in-memory disk and file system: one file, laid out in extents of every type
+//
+
+#define FILE_BLOCKS     (40)
+#define DISK_BLOCKS     (FILE_BLOCKS + 16)      // in logical blocks, room for gaps
+#define MAX_BLOCKSIZE   (4096)
+
+struct mem_extent {
+    fsw_u32 type;
+    fsw_u32 log_start;
+    fsw_u32 log_count;
+    fsw_u32 flags;
+    fsw_u32 disk_start;     // logical block on the disk, for FSW_EXTENT_TYPE_PHYSBLOCK
+};
+
+static struct mem_extent extents[] = {
+    { FSW_EXTENT_TYPE_PHYSBLOCK, 0, 3, 0, 50 },
+    { FSW_EXTENT_TYPE_SPARSE, 3, 1, 0, 0 },
+    { FSW_EXTENT_TYPE_PHYSBLOCK, 4, 5, 0, 43 },
+    { FSW_EXTENT_TYPE_BUFFER, 9, 2, 0, 0 },
+    { FSW_EXTENT_TYPE_BUFFER, 11, 1, FSW_EXTENT_FLAG_BORROWED, 0 },
+    { FSW_EXTENT_TYPE_PHYSBLOCK, 12, 8, 0, 33 },
+    { FSW_EXTENT_TYPE_SPARSE, 20, 1, 0, 0 },
+    { FSW_EXTENT_TYPE_PHYSBLOCK, 21, 19, 0, 2 },
+};
+
+#define NEXTENTS (sizeof(extents) / sizeof(extents[0]))
+
+static fsw_u8 disk[DISK_BLOCKS * MAX_BLOCKSIZE];
+static fsw_u8 expected[FILE_BLOCKS * MAX_BLOCKSIZE];
+static fsw_u8 borrowed[FILE_BLOCKS * MAX_BLOCKSIZE];    // the "driver cache" borrowed extents point into
+static fsw_u64 file_size;
+static fsw_u32 disk_reads, extent_calls;
+
+static void EFIAPI mem_change_blocksize(struct fsw_volume *vol,
+                                        fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
+                                        fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize)
+{
+}
+
+static fsw_status_t EFIAPI mem_read_block(struct fsw_volume *vol, fsw_u64 phys_bno, void *buffer)
+{
+    if ((phys_bno + 1) * vol->phys_blocksize > sizeof(disk))
+        return FSW_IO_ERROR;
+    memcpy(buffer, disk + phys_bno * vol->phys_blocksize, vol->phys_blocksize);
+    disk_reads++;
+    return FSW_SUCCESS;
+}
+
+static struct fsw_host_table mem_host_table = {
+    FSW_STRING_TYPE_ISO88591,
+    mem_change_blocksize,
+    mem_read_block
+};
+
+static fsw_status_t mem_dnode_fill(struct fsw_volume *vol, struct fsw_dnode *dno)
+{
+    return FSW_SUCCESS;
+}
+
+static fsw_status_t mem_get_extent(struct fsw_volume *vol, struct fsw_dnode *dno,
+                                   struct fsw_extent *extent)
+{
+    struct mem_extent *e;
+    fsw_u32 i, blocksize = vol->log_blocksize;
+    fsw_status_t status;
+
+    extent_calls++;
+    for (i = 0; i < NEXTENTS; i++) {
+        e = &extents[i];
+        if (extent->log_start < e->log_start || extent->log_start >= e->log_start + e->log_count)
+            continue;
+
+        extent->type = e->type;
+        extent->log_start = e->log_start;
+        extent->log_count = e->log_count;
+        extent->flags = e->flags;
+        if (e->type == FSW_EXTENT_TYPE_PHYSBLOCK) {
+            extent->phys_start = (fsw_u64)e->disk_start * blocksize / vol->phys_blocksize;
+        } else if (e->type == FSW_EXTENT_TYPE_BUFFER && (e->flags & FSW_EXTENT_FLAG_BORROWED)) {
+            extent->buffer = borrowed + e->log_start * blocksize;
+        } else if (e->type == FSW_EXTENT_TYPE_BUFFER) {
+            status = fsw_alloc(e->log_count * blocksize, &extent->buffer);
+            if (status)
+                return status;
+            memcpy(extent->buffer, expected + e->log_start * blocksize, e->log_count * blocksize);
+        }
+        return FSW_SUCCESS;
+    }
+    return FSW_VOLUME_CORRUPTED;
+}
+
+struct fsw_fstype_table fsw_memfs_table = {
+    { FSW_STRING_TYPE_ISO88591, 5, 5, "memfs" },
+    sizeof(struct fsw_volume),
+    sizeof(struct fsw_dnode),
+
+    NULL,
+    NULL,
+    NULL,
+    mem_dnode_fill,
+    NULL,
+    NULL,
+    mem_get_extent,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+typedef fsw_status_t (*shandle_read_fn)(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout,
+                                        void *buffer);
+
+static struct fsw_volume vol;
+static struct fsw_dnode dno;
+
+/* lay out the file for a logical block size and mount it at the given
+ * physical block size */
+static void build_file(fsw_u32 phys_blocksize, fsw_u32 log_blocksize)
+{
+    fsw_u32 i, n;
+
+    for (n = 0; n < sizeof(disk); n++)
+        disk[n] = rnd();
+    memset(expected, 0, sizeof(expected));
+    for (i = 0; i < NEXTENTS; i++) {
+        struct mem_extent *e = &extents[i];
+        fsw_u8 *data = expected + e->log_start * log_blocksize;
+
+        if (e->type == FSW_EXTENT_TYPE_PHYSBLOCK) {
+            memcpy(data, disk + e->disk_start * log_blocksize, e->log_count * log_blocksize);
+        } else if (e->type == FSW_EXTENT_TYPE_BUFFER) {
+            for (n = 0; n < e->log_count * log_blocksize; n++)
+                data[n] = rnd();
+            memcpy(borrowed + e->log_start * log_blocksize, data, e->log_count * log_blocksize);
+        }
+    }
+    file_size = (fsw_u64)FILE_BLOCKS * log_blocksize - 123;
+
+    vol.host_table = &mem_host_table;
+    vol.fstype_table = &fsw_memfs_table;
+    fsw_set_blocksize(&vol, phys_blocksize, log_blocksize);
+
+    dno.refcount = 1;
+    dno.vol = &vol;
+    dno.type = FSW_DNODE_TYPE_FILE;
+    dno.size = file_size;
+}
+
+/* read len bytes at pos and compare them with the file */
+static int check_read(struct fsw_shandle *shand, fsw_u64 pos, fsw_u32 len)
+{
+    static fsw_u8 buf[3 * FILE_BLOCKS * MAX_BLOCKSIZE + 1];
+    fsw_u32 want = pos >= file_size ? 0 : (file_size - pos < len ? (fsw_u32)(file_size - pos) : len);
+    fsw_u32 size = len;
+
+    memset(buf, 0xAA, len + 1);
+    shand->pos = pos;
+    if (fsw_shandle_read(shand, &size, buf) != FSW_SUCCESS)
+        return 0;
+    return size == want && shand->pos == pos + want && memcmp(buf, expected + pos, want) == 0
+        && buf[len] == 0xAA;
+}
+
+static void test_geometry(fsw_u32 phys_blocksize, fsw_u32 log_blocksize, shandle_read_fn shandle_read)
+{
+    struct fsw_shandle shand;
+    fsw_u32 i, size, reads, calls;
+    fsw_u8 buf[100];
+    char what[80];
+    int ok;
+
+    build_file(phys_blocksize, log_blocksize);
+    if (shandle_read)
+        vol.shandle_read = shandle_read;
+    snprintf(what, sizeof(what), "%u/%u%s", phys_blocksize, log_blocksize,
+             shandle_read ? " generic" : "");
+
+    check(fsw_shandle_open(&dno, &shand) == FSW_SUCCESS, "shandle open");
+
+    // the whole file in one call, and then some
+    if (!check_read(&shand, 0, FILE_BLOCKS * log_blocksize + 1000)) {
+        printf("FAIL: %s: whole file\n", what);
+        failures++;
+    }
+
+    // random positions and lengths, crossing blocks, extents and the end
+    for (ok = 1, i = 0; i < 3000 && ok; i++) {
+        fsw_u64 pos = rnd() % (file_size + 200);
+        fsw_u32 len = rnd() % (3 * log_blocksize);
+        ok = check_read(&shand, pos, len);
+    }
+    if (!ok) {
+        printf("FAIL: %s: random reads\n", what);
+        failures++;
+    }
+
+    // small reads within one extent ask the driver once and read each
+    // physical block once
+    fsw_shandle_close(&shand);
+    fsw_set_blocksize(&vol, phys_blocksize, log_blocksize);     // empties the block cache
+    if (shandle_read)
+        vol.shandle_read = shandle_read;
+    fsw_shandle_open(&dno, &shand);
+    disk_reads = extent_calls = 0;
+    for (ok = 1, reads = 0; shand.pos + sizeof(buf) <= 3 * log_blocksize && ok; reads++) {
+        fsw_u64 pos = shand.pos;
+        size = sizeof(buf);
+        ok = fsw_shandle_read(&shand, &size, buf) == FSW_SUCCESS && size == sizeof(buf)
+            && memcmp(buf, expected + pos, size) == 0;
+    }
+    calls = extent_calls;
+    if (!ok || calls != 1 || disk_reads != 3 * log_blocksize / phys_blocksize) {
+        printf("FAIL: %s: small sequential reads (%u extent calls, %u disk reads)\n", what, calls, disk_reads);
+        failures++;
+    }
+
+    // at and past the end nothing is read
+    shand.pos = file_size;
+    size = sizeof(buf);
+    check(fsw_shandle_read(&shand, &size, buf) == FSW_SUCCESS && size == 0 && shand.pos == file_size,
+          "read at the end of the file");
+
+    fsw_shandle_close(&shand);
+}
+
+static void test_geometries(void)
+{
+    static const fsw_u32 sizes[] = { 512, 1024, 2048, 4096 };
+    shandle_read_fn picked[4], generic;
+    fsw_u32 i;
+
+    // unequal sizes, and a logical size that is no power of 2, use the
+    // generic copy
+    test_geometry(512, 2048, NULL);
+    test_geometry(1024, 4096, NULL);
+    test_geometry(512, 1536, NULL);
+    generic = vol.shandle_read;
+
+    for (i = 0; i < 4; i++) {
+        test_geometry(sizes[i], sizes[i], NULL);
+        picked[i] = vol.shandle_read;
+        test_geometry(sizes[i], sizes[i], generic);
+    }
+    check(picked[0] != generic && picked[1] != generic && picked[2] != generic && picked[3] != generic
+          && picked[0] != picked[1] && picked[1] != picked[2] && picked[2] != picked[3],
+          "a copy of its own for each block size");
+}
+
+//
+// benchmark: small and large reads with the picked and the generic copy
+//
+
+static void bench_one(const char *name, fsw_u32 piece)
+{
+    static fsw_u8 buf[FILE_BLOCKS * MAX_BLOCKSIZE];
+    struct fsw_shandle shand;
+    clock_t start;
+    double secs;
+    fsw_u32 size;
+    fsw_u64 total = 0;
+
+    fsw_shandle_open(&dno, &shand);
+    size = sizeof(buf);
+    fsw_shandle_read(&shand, &size, buf);   // warm up the buffer and the block cache
+    start = clock();
+    do {
+        for (shand.pos = 0; shand.pos < file_size; ) {
+            size = piece;
+            fsw_shandle_read(&shand, &size, buf);
+            total += size;
+        }
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (secs < 0.5);
+    fsw_shandle_close(&shand);
+    printf("shandle_read: %.0f MB/s (%s, %u byte reads)\n", total / 1e6 / secs, name, piece);
+}
+
+static void bench_read(void)
+{
+    shandle_read_fn generic;
+
+    build_file(1024, 4096);
+    generic = vol.shandle_read;
+    build_file(4096, 4096);
+    bench_one("4096", 512);
+    bench_one("4096", 65536);
+    vol.shandle_read = generic;
+    bench_one("generic", 512);
+    bench_one("generic", 65536);
+}
+
+int main(int argc, char **argv)
+{
+    test_geometries();
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        bench_read();
+
+    if (failures) {
+        printf("shandletest: %d failures\n", failures);
+        return 1;
+    }
+    printf("shandletest: ok\n");
+    return 0;
+}
+
+// EOF
@@ -0,0 +1,520 @@
+/**
+ * \file zstdtest.c
+ * Checks the btrfs zstd extent decompression: one-shot reads at an offset,
+ * piecewise stream reads, the context pool and damaged frames.
+ */
+
+/*-
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../fsw_btrfs.c"
+
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+//
+// reference data: make_text() output, compressed with the zstd 1.5 command
+// line tool at window log 17 (-19 with a checksum, and -1 --no-check), and
+// 64 KiB of zeros
+//
+
+#define TEXT_SIZE   (131072)
+#define ZERO_SIZE   (65536)
+
+static fsw_u32 rnd_state;
+
+static fsw_u32 rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+/* 3000 bytes of words and noise, then repeated with a marker every 1 KiB */
+static void make_text(fsw_u8 *p, unsigned n)
+{
+    static const char *words[] = { "efi ", "boot ", "loader ", "volume ", "btrfs ", "extent ",
+                                   "zstd ", "frame ", "\n", "0123456789 " };
+    unsigned i = 0, k;
+
+    rnd_state = 7;
+    while (i < n && i < 3000) {
+        fsw_u32 r = rnd();
+        if (r % 11 == 0) {
+            p[i++] = rnd();
+        } else {
+            const char *w = words[r % 10];
+            for (k = 0; w[k] && i < n && i < 3000; k++)
+                p[i++] = w[k];
+        }
+    }
+    for (; i < n; i++)
+        p[i] = (i & 1023) ? p[i - 3000] : (fsw_u8)(i >> 10);
+}
+
+static const fsw_u8 frame_text_19[1018] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0xa4, 0x00, 0x00, 0x02, 0x00, 0xc4, 0x0e, 0x00,
+    0x64, 0x06, 0x07, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x20, 0x65, 0x78, 0x74,
+    0x65, 0x6e, 0x74, 0x20, 0x7a, 0x73, 0x74, 0x64, 0x20, 0x6c, 0x6f, 0x61,
+    0x64, 0x65, 0x72, 0x76, 0x6f, 0x6c, 0x75, 0x6d, 0x65, 0x20, 0xfd, 0x0a,
+    0x65, 0x66, 0x69, 0x20, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x62, 0x6f, 0x6f, 0x74, 0x20, 0x0a, 0x62, 0x74, 0x72, 0x66,
+    0x73, 0xfa, 0x0a, 0x0a, 0x8d, 0x0a, 0x14, 0x19, 0x10, 0xb5, 0x0a, 0x13,
+    0xee, 0xfa, 0x93, 0xf9, 0xd4, 0xc6, 0x23, 0x0a, 0x61, 0x8a, 0x9a, 0x68,
+    0xc7, 0x6e, 0xdd, 0x67, 0xf6, 0x0a, 0x87, 0x77, 0x94, 0x0a, 0x0a, 0x0a,
+    0x91, 0x42, 0x0a, 0x0a, 0xcd, 0x6e, 0x00, 0x0a, 0x80, 0xbf, 0xa8, 0x40,
+    0x4d, 0x0a, 0x52, 0xca, 0x70, 0x20, 0x84, 0x20, 0x63, 0xaa, 0xcc, 0x03,
+    0x11, 0x30, 0x0c, 0x0e, 0x12, 0x43, 0xb0, 0x49, 0xc1, 0x88, 0x85, 0xa9,
+    0x54, 0x96, 0x31, 0x2a, 0xc7, 0x92, 0xbf, 0xa5, 0x25, 0x22, 0x06, 0x52,
+    0x89, 0x05, 0x54, 0xed, 0x7f, 0xa1, 0x96, 0xe2, 0xaf, 0x22, 0x12, 0x92,
+    0xe2, 0xad, 0xe8, 0xf0, 0x3c, 0x6c, 0x2c, 0xe8, 0xb2, 0x91, 0xfa, 0x4b,
+    0xb1, 0x33, 0xeb, 0xaf, 0xfe, 0x0d, 0x18, 0x63, 0x21, 0x99, 0x2b, 0xb4,
+    0x86, 0xdf, 0x7e, 0x60, 0xc0, 0xe7, 0x1a, 0xf1, 0x22, 0x52, 0xbe, 0x76,
+    0xa0, 0x5b, 0xfe, 0x9c, 0x82, 0x2b, 0xc8, 0xf7, 0x22, 0xb3, 0x20, 0x28,
+    0x0c, 0x81, 0x7b, 0xef, 0xdb, 0xcb, 0xf9, 0xeb, 0xea, 0x25, 0xf0, 0x2c,
+    0xeb, 0x14, 0x1e, 0x0b, 0x66, 0xa7, 0x5d, 0x82, 0x3f, 0xab, 0x55, 0x8f,
+    0xfa, 0x75, 0x2b, 0x79, 0x35, 0xce, 0x9a, 0xc9, 0x34, 0x76, 0xb1, 0x57,
+    0x02, 0xb2, 0x66, 0xd2, 0xf2, 0x34, 0x82, 0x04, 0xc1, 0x39, 0x9e, 0x00,
+    0xf2, 0x11, 0xbd, 0x61, 0xe6, 0xf5, 0x0d, 0x38, 0xb7, 0xd1, 0xba, 0xcd,
+    0x88, 0xf8, 0xec, 0xd8, 0xb7, 0x36, 0x08, 0x49, 0xc4, 0x6e, 0xa4, 0xb3,
+    0x9b, 0x10, 0x58, 0x18, 0x0c, 0x99, 0x87, 0xc4, 0x5f, 0x33, 0xa2, 0xf6,
+    0xe1, 0xad, 0xdc, 0xa8, 0xb6, 0x18, 0x69, 0xc3, 0x3b, 0x61, 0xed, 0x6c,
+    0xc7, 0xd4, 0x1f, 0x04, 0x2f, 0x2b, 0x50, 0x41, 0x5a, 0x06, 0x8d, 0x1a,
+    0xe7, 0x1e, 0x00, 0xa3, 0x58, 0x43, 0x47, 0xf7, 0x14, 0xc7, 0x76, 0x96,
+    0xf3, 0x0d, 0x06, 0xeb, 0x8b, 0xc8, 0x5a, 0x58, 0x47, 0xe1, 0x46, 0x9b,
+    0x1a, 0x2d, 0x50, 0xc7, 0x00, 0x03, 0x15, 0x64, 0x5c, 0xd9, 0xb1, 0x07,
+    0x27, 0x8f, 0xc1, 0x33, 0xfc, 0x63, 0xe7, 0x78, 0xbe, 0xd6, 0xfc, 0x03,
+    0xca, 0xc2, 0x99, 0x4e, 0x45, 0x3a, 0xf0, 0x43, 0x57, 0x61, 0xd7, 0xbb,
+    0x60, 0xfb, 0x28, 0xd6, 0xdf, 0x0d, 0xdc, 0x84, 0xc2, 0x7a, 0xa1, 0x4c,
+    0x9f, 0xea, 0xd0, 0x7e, 0xc6, 0x99, 0xbf, 0x9b, 0x79, 0x4e, 0xc2, 0xbb,
+    0x6e, 0x46, 0xa2, 0x03, 0x80, 0x3e, 0x8e, 0x14, 0x87, 0xc5, 0x36, 0x3a,
+    0x84, 0x96, 0xee, 0x28, 0x63, 0xbd, 0x99, 0xb7, 0x81, 0x78, 0x39, 0x92,
+    0x6d, 0x42, 0xd4, 0x89, 0x92, 0x08, 0x1e, 0x91, 0x0c, 0x41, 0x42, 0xcd,
+    0x70, 0x59, 0x1c, 0x84, 0xb7, 0xcd, 0x2c, 0x30, 0x0c, 0xc0, 0x78, 0xa9,
+    0x09, 0xc9, 0x85, 0x02, 0x42, 0x73, 0x5c, 0x61, 0xe6, 0xe7, 0x43, 0x6c,
+    0x5f, 0x3d, 0x04, 0x02, 0x1a, 0x25, 0xd4, 0x77, 0x43, 0x76, 0xc8, 0x8a,
+    0x37, 0x5c, 0x21, 0x05, 0x7d, 0x10, 0x00, 0xa4, 0x09, 0x85, 0xa4, 0xcf,
+    0x24, 0x8f, 0x9e, 0xec, 0xf6, 0xd6, 0x58, 0xe4, 0xed, 0x7d, 0xa6, 0x27,
+    0xc0, 0x0a, 0x0a, 0x4f, 0x8b, 0xac, 0x38, 0x0a, 0x21, 0x0a, 0xfe, 0x86,
+    0x9f, 0x0a, 0x0a, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c,
+    0x3d, 0x3e, 0x3f, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54,
+    0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f, 0x60,
+    0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c,
+    0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f, 0x80, 0xc0, 0xa8, 0x90, 0xb8,
+    0x0e, 0x20, 0x25, 0x10, 0x11, 0x6d, 0xdc, 0x12, 0x40, 0x20, 0x30, 0x10,
+    0x82, 0x20, 0x24, 0x82, 0x12, 0x20, 0x04, 0x18, 0xc2, 0x20, 0x04, 0x09,
+    0x43, 0xb0, 0x42, 0xf0, 0x27, 0x04, 0xe3, 0x1f, 0xfc, 0xf9, 0x9b, 0x3f,
+    0xfe, 0xe0, 0x2f, 0xfe, 0xf8, 0x8f, 0x3f, 0xf9, 0xe3, 0x0f, 0x7f, 0xf3,
+    0xc7, 0x9f, 0xfc, 0xe1, 0x0f, 0xff, 0xf1, 0x87, 0x3f, 0xfc, 0xe7, 0x0f,
+    0x7f, 0xf8, 0x93, 0xbf, 0xfc, 0xe5, 0x1f, 0x7f, 0xf1, 0x87, 0x3f, 0xfe,
+    0xe0, 0x2f, 0x7f, 0xf8, 0x83, 0xbf, 0xfc, 0xe3, 0x4f, 0xfe, 0xf8, 0xc3,
+    0x1f, 0xfc, 0xf1, 0x07, 0x7f, 0xf2, 0xc7, 0x3f, 0xfc, 0xc9, 0x1f, 0x7f,
+    0xf9, 0xc3, 0x1f, 0xfe, 0xe0, 0x0f, 0x7f, 0xf8, 0x97, 0x3f, 0xfc, 0xe1,
+    0x2f, 0x7f, 0xf8, 0xcb, 0x1f, 0xfe, 0xe0, 0x0f, 0xff, 0xf8, 0x83, 0xbf,
+    0xfc, 0xf1, 0x07, 0x7f, 0xf9, 0xc3, 0x9f, 0xfc, 0xf1, 0x0f, 0x7f, 0xf0,
+    0xc7, 0x5f, 0x8b, 0x7f, 0xf3, 0xc7, 0x1f, 0xfc, 0xcd, 0x1f, 0xff, 0xf3,
+    0x87, 0x3f, 0xfc, 0xe3, 0x0f, 0x7f, 0xf8, 0x9b, 0x3f, 0xfc, 0xe1, 0x7f,
+    0xfe, 0xf0, 0x97, 0x7f, 0xfe, 0xe0, 0x0f, 0x7f, 0xf9, 0x83, 0xbf, 0xfc,
+    0xe7, 0x0f, 0xfe, 0xf2, 0xcf, 0x9f, 0xfc, 0xf1, 0x17, 0x7f, 0xf0, 0xc7,
+    0x7f, 0xfc, 0xc9, 0x1f, 0xff, 0xf8, 0x93, 0x3f, 0xfe, 0xe6, 0x0f, 0x7f,
+    0xf8, 0x8f, 0x3f, 0xfc, 0xe1, 0x3f, 0x7f, 0xf8, 0xc3, 0xdf, 0xfc, 0xe1,
+    0x2f, 0xff, 0x75, 0xa5, 0x76, 0x97, 0x97, 0x29, 0x8c, 0x8e, 0x01, 0x66,
+    0x6c, 0xcf, 0xab, 0x56, 0xdf, 0x6f, 0x4e, 0x1f, 0xa8, 0xcb, 0x8e, 0xe9,
+    0x07, 0x23, 0x3a, 0x29, 0x05, 0x3f, 0x45, 0x95, 0x20, 0xdd, 0x54, 0xf0,
+    0x6e, 0xf6, 0x1d, 0x7b, 0x02, 0xff, 0x93, 0x23, 0xfe, 0x6c, 0xe6, 0xeb,
+    0x5e, 0x54, 0xf0, 0x0d, 0x99, 0x16, 0x24, 0x61, 0x45, 0xdf, 0xad, 0x9f,
+    0xe7, 0xf1, 0xca, 0xe7, 0xb0, 0xac, 0xe7, 0xf1, 0xc6, 0x4e, 0xe3, 0x1f,
+    0xe2, 0xea, 0xbb, 0x2f, 0x8a, 0xb7, 0x45, 0xbf, 0x7a, 0xaa, 0x4d, 0xe8,
+    0x36, 0xa2, 0xb4, 0x4a, 0x69, 0xb2, 0x97, 0xc4, 0xb0, 0xa2, 0x48, 0xd3,
+    0x6a, 0x5e, 0x9d, 0xe8, 0x89, 0xe8, 0xd2, 0x42, 0x24, 0xc7, 0xc1, 0x2e,
+    0x94, 0xc3, 0xed, 0x45, 0x98, 0x15, 0x7f, 0x5f, 0xae, 0xaf, 0x59, 0xca,
+    0x67, 0x3d, 0xb1, 0x2b, 0x37, 0x81, 0xe9, 0x01, 0x22, 0x38, 0xcb, 0xc1,
+    0x3d, 0xb2, 0x94, 0xa9, 0x48, 0x43, 0x79, 0x9d, 0xfb, 0xc3, 0x8c, 0xc6,
+    0x3f, 0xab, 0xf2, 0xfd, 0x5b, 0xc1, 0x49, 0xa4, 0x4c, 0x07, 0xc6, 0x20,
+    0x70, 0x52, 0xf0, 0x01, 0x72, 0x9f, 0x5d, 0x79, 0x36, 0xa5
+};
+
+static const fsw_u8 frame_text_1[1263] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0xa0, 0x00, 0x00, 0x02, 0x00, 0x1d, 0x27, 0x00,
+    0x24, 0x18, 0x07, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x20, 0x65, 0x78, 0x74,
+    0x65, 0x6e, 0x74, 0x20, 0x7a, 0x73, 0x74, 0x64, 0x20, 0x6c, 0x6f, 0x61,
+    0x64, 0x65, 0x72, 0x76, 0x6f, 0x6c, 0x75, 0x6d, 0x65, 0x20, 0xfd, 0x0a,
+    0x65, 0x66, 0x69, 0x20, 0x65, 0x66, 0x69, 0x20, 0x30, 0x31, 0x32, 0x33,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x66, 0x69, 0x20, 0x7a, 0x73, 0x74,
+    0x64, 0x20, 0x62, 0x6f, 0x6f, 0x74, 0x20, 0x0a, 0x62, 0x74, 0x72, 0x66,
+    0x73, 0xfa, 0x62, 0x6f, 0x6f, 0x0a, 0x0a, 0x7a, 0x73, 0x74, 0x64, 0x20,
+    0x8d, 0x62, 0x6f, 0x6f, 0x74, 0x65, 0x66, 0x69, 0x62, 0x6f, 0x6f, 0x74,
+    0x20, 0x65, 0x66, 0x69, 0x62, 0x6f, 0x6f, 0x74, 0x6f, 0x6f, 0x74, 0x74,
+    0x72, 0x66, 0x73, 0x0a, 0x7a, 0x73, 0x74, 0x64, 0x0a, 0x14, 0x19, 0x6f,
+    0x6f, 0x10, 0x0a, 0x65, 0x66, 0x69, 0xb5, 0x0a, 0x13, 0xee, 0xfa, 0x7a,
+    0x73, 0x74, 0x64, 0x20, 0x93, 0xf9, 0xd4, 0x6f, 0x6f, 0x65, 0x66, 0x69,
+    0x62, 0x6f, 0x6f, 0x74, 0x20, 0xc6, 0x23, 0x65, 0x66, 0x69, 0x7a, 0x73,
+    0x74, 0x64, 0x0a, 0x61, 0x8a, 0x62, 0x6f, 0x6f, 0x74, 0x20, 0x9a, 0x65,
+    0x66, 0x69, 0x20, 0x68, 0x65, 0x66, 0x69, 0x20, 0xc7, 0x6e, 0xdd, 0x67,
+    0xf6, 0x0a, 0x87, 0x77, 0x7a, 0x73, 0x74, 0x64, 0x94, 0x0a, 0x7a, 0x73,
+    0x74, 0x64, 0x0a, 0x65, 0x66, 0x69, 0x91, 0x42, 0x0a, 0xcd, 0x6e, 0x0a,
+    0x00, 0x0a, 0x62, 0x6f, 0x6f, 0x74, 0x20, 0x85, 0x0a, 0xa4, 0xcf, 0x24,
+    0x65, 0x66, 0x69, 0x8f, 0x9e, 0xec, 0x7a, 0x73, 0x74, 0x64, 0x20, 0xf6,
+    0x0a, 0xd6, 0x62, 0x6f, 0x6f, 0x74, 0x20, 0x58, 0xe4, 0xed, 0x7d, 0xa6,
+    0x27, 0xc0, 0x0a, 0x0a, 0x0a, 0x4f, 0x65, 0x66, 0x69, 0x20, 0x8b, 0xac,
+    0x38, 0x0a, 0x21, 0x65, 0x66, 0x69, 0x20, 0x0a, 0xfe, 0x86, 0x9f, 0x07,
+    0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a,
+    0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b,
+    0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62, 0x63,
+    0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x7b,
+    0x7c, 0x7d, 0x7e, 0x7f, 0x81, 0xc5, 0xa8, 0x01, 0x5e, 0x49, 0x92, 0xa4,
+    0xb0, 0xec, 0x06, 0x51, 0x85, 0x48, 0x49, 0x29, 0x59, 0x3d, 0x12, 0x48,
+    0xc0, 0xd1, 0x1c, 0x45, 0xe1, 0x98, 0x21, 0x84, 0x10, 0x22, 0x28, 0x44,
+    0x50, 0x88, 0xf0, 0xff, 0xf8, 0x03, 0xfc, 0x91, 0xff, 0xcb, 0x9f, 0xf0,
+    0xdf, 0xfc, 0x35, 0xff, 0x82, 0xbf, 0xe4, 0x9f, 0xf9, 0x3f, 0xfc, 0x9d,
+    0xff, 0xcf, 0xdf, 0xf0, 0xef, 0xfc, 0x7d, 0xfe, 0x87, 0xff, 0xe7, 0xef,
+    0xf9, 0x3f, 0xfc, 0x9d, 0x7f, 0xcf, 0xdf, 0xe1, 0xff, 0xfc, 0x7f, 0xfe,
+    0x86, 0xff, 0xe7, 0xef, 0xf9, 0x37, 0xfc, 0x3d, 0xff, 0xcf, 0xff, 0xe1,
+    0xef, 0xfc, 0x7f, 0xfe, 0x86, 0x7f, 0xe7, 0xef, 0xf3, 0x3f, 0xfc, 0x3f,
+    0x7f, 0xcf, 0xff, 0xe1, 0xef, 0xfc, 0x7b, 0xfe, 0x0e, 0xff, 0xe7, 0xff,
+    0xf3, 0x37, 0xfc, 0x3f, 0x7f, 0xcf, 0xbf, 0xe1, 0xef, 0xf9, 0x7f, 0xfe,
+    0x0f, 0x7f, 0xe7, 0xff, 0xf3, 0x37, 0xfc, 0x3b, 0x7f, 0x9f, 0xff, 0xe1,
+    0xff, 0xf9, 0x7b, 0xfe, 0x0f, 0x7f, 0xe7, 0xdf, 0xf3, 0x77, 0xf8, 0x3f,
+    0xff, 0x9f, 0xbf, 0xe1, 0xff, 0xf9, 0x7b, 0xfe, 0x0d, 0x7f, 0xcf, 0xff,
+    0xf3, 0x7f, 0xf8, 0x1b, 0xe5, 0xff, 0xe6, 0x0f, 0xf8, 0x77, 0xfe, 0x3e,
+    0xff, 0xc2, 0x7f, 0xf3, 0xd7, 0xfc, 0x07, 0xfe, 0xcc, 0xbf, 0xe6, 0x2f,
+    0xf0, 0x7f, 0xfe, 0x3f, 0x7f, 0xc2, 0xff, 0xe6, 0x8f, 0xf9, 0x37, 0xfc,
+    0x35, 0xff, 0xce, 0xff, 0xe0, 0xaf, 0xfc, 0x67, 0xfe, 0x80, 0x7f, 0xe7,
+    0xef, 0xf3, 0x3f, 0xfc, 0x3f, 0x7f, 0xcf, 0xff, 0xe1, 0xef, 0xfc, 0x7b,
+    0xfe, 0x0e, 0xff, 0xe7, 0xff, 0xf3, 0x37, 0xfc, 0x3f, 0x7f, 0xcf, 0xbf,
+    0xe1, 0xef, 0xf9, 0x7f, 0xfe, 0x0f, 0x7f, 0xe7, 0xff, 0xf3, 0x37, 0xfc,
+    0x3b, 0x7f, 0x9f, 0xff, 0xe1, 0xff, 0xf9, 0x7b, 0xfe, 0x0f, 0x7f, 0x63,
+    0x74, 0x77, 0xd5, 0x03, 0x25, 0xd0, 0x53, 0x78, 0x8e, 0x12, 0x88, 0xef,
+    0x38, 0xaa, 0xc2, 0xe1, 0x61, 0xb4, 0xb9, 0x67, 0x6c, 0x04, 0x12, 0x0a,
+    0x45, 0xae, 0xa8, 0x87, 0x10, 0x83, 0x8c, 0x18, 0x96, 0x9d, 0xef, 0xc0,
+    0xe4, 0x27, 0xd8, 0x8e, 0x04, 0x47, 0x43, 0xc7, 0x2a, 0x26, 0xcd, 0xc9,
+    0x42, 0x78, 0xf9, 0x5a, 0x7e, 0xb1, 0x45, 0x14, 0xcd, 0x5c, 0x88, 0x14,
+    0xfe, 0x25, 0x89, 0x04, 0x1c, 0x18, 0x33, 0x68, 0x19, 0x5b, 0x01, 0xdf,
+    0x82, 0x7f, 0xc8, 0x3d, 0xbc, 0x1c, 0xa7, 0xc1, 0xd6, 0x14, 0xe1, 0x13,
+    0xba, 0xe7, 0xfc, 0x9a, 0xe6, 0xcb, 0x15, 0x43, 0x1f, 0xc4, 0xe6, 0x2b,
+    0x26, 0xb6, 0x24, 0xa5, 0xac, 0x45, 0xdb, 0x3d, 0x51, 0x07, 0x5b, 0xfc,
+    0x61, 0x7c, 0x2b, 0xf9, 0x07, 0x00, 0xb2, 0x08, 0xcf, 0x7b, 0xea, 0x1d,
+    0x0d, 0xfa, 0x84, 0x74, 0x0a, 0x60, 0x40, 0x32, 0x7c, 0x52, 0x2c, 0xba,
+    0x50, 0xb1, 0x14, 0x73, 0x8e, 0x3b, 0xd9, 0x8f, 0xef, 0xae, 0x36, 0x86,
+    0xfe, 0x22, 0x6a, 0xde, 0xa3, 0x14, 0xac, 0xa2, 0xd5, 0x73, 0x9c, 0x63,
+    0x7b, 0x8b, 0xa1, 0x80, 0xf2, 0xcf, 0x3f, 0x51, 0x70, 0xe6, 0x4e, 0xf8,
+    0x91, 0x2c, 0x7d, 0x1d, 0xbe, 0xc1, 0x82, 0x22, 0x79, 0x19, 0x36, 0x69,
+    0x91, 0xc7, 0xfa, 0x7e, 0x9f, 0x10, 0x24, 0x24, 0x3e, 0xb1, 0x06, 0x10,
+    0xef, 0x35, 0xc5, 0x35, 0x49, 0x41, 0x95, 0x08, 0xc7, 0xf0, 0xc3, 0xa5,
+    0xc5, 0x5b, 0x90, 0xa8, 0x56, 0xaa, 0x18, 0x30, 0x0e, 0x00, 0x87, 0x96,
+    0x57, 0x61, 0xbd, 0x6c, 0x9d, 0x81, 0xae, 0xd0, 0x8f, 0x1d, 0xea, 0x2c,
+    0x05, 0x1e, 0xb3, 0xd1, 0x74, 0x9d, 0x6e, 0x0d, 0x15, 0x0a, 0xdf, 0x00,
+    0xf0, 0xed, 0x28, 0x84, 0x21, 0x26, 0x81, 0x7a, 0x72, 0x47, 0xcb, 0x90,
+    0x66, 0x61, 0x8e, 0xd1, 0x81, 0x4b, 0x0d, 0x41, 0x8f, 0xd7, 0x07, 0x24,
+    0xd7, 0x31, 0x42, 0x72, 0xe7, 0x28, 0x82, 0x2c, 0x12, 0x02, 0x85, 0xe0,
+    0x6a, 0xc7, 0x2f, 0x55, 0x46, 0xa9, 0x56, 0xc6, 0xd9, 0x80, 0xcf, 0x31,
+    0x22, 0xb6, 0x2f, 0x16, 0xc3, 0x3b, 0xee, 0x7b, 0xd7, 0xf3, 0xcb, 0x1b,
+    0x1a, 0xd2, 0x70, 0xdf, 0x05, 0xba, 0x04, 0xc9, 0xe3, 0x50, 0x50, 0x0c,
+    0x2c, 0x12, 0x91, 0x0c, 0xb7, 0xe6, 0x60, 0x88, 0x3f, 0x29, 0xaf, 0xfe,
+    0xc6, 0x85, 0x36, 0x8c, 0xb8, 0x15, 0x56, 0x40, 0x8c, 0x63, 0xd2, 0x1d,
+    0x32, 0xfe, 0x3d, 0xc7, 0xfe, 0x50, 0xfc, 0x4c, 0x85, 0x99, 0xd4, 0xb0,
+    0xa0, 0xc1, 0x94, 0x86, 0xbd, 0x68, 0x58, 0x1b, 0x7d, 0xd2, 0x86, 0xa0,
+    0x39, 0x33, 0x01, 0x8d, 0x98, 0x5d, 0xd5, 0x80, 0xd3, 0x8d, 0x7c, 0x7e,
+    0xfb, 0x90, 0xef, 0x53, 0x30, 0x7d, 0xdc, 0x89, 0x80, 0xd0, 0x3b, 0x46,
+    0x59, 0x77, 0x46, 0xdc, 0x1f, 0x15, 0xa8, 0x55, 0x66, 0x66, 0x9f, 0x07,
+    0x02, 0x30, 0xc0, 0x8a, 0x53, 0x4d, 0x84, 0xe3, 0xdd, 0xb3, 0xdc, 0x62,
+    0x20, 0x59, 0x4d, 0x6e, 0x6c, 0xd2, 0x2d, 0x49, 0x50, 0x2f, 0xe1, 0xc6,
+    0x45, 0x4e, 0x1b, 0xc2, 0x8f, 0x06, 0xa0, 0x2d, 0xc3, 0xde, 0x1f, 0xc5,
+    0x3e, 0xbd, 0x40, 0x71, 0xbb, 0x79, 0xff, 0x91, 0x61, 0xe6, 0x50, 0xaf,
+    0x17, 0x03, 0xb5, 0x4d, 0x87, 0xf1, 0xc7, 0x9c, 0xfe, 0x24, 0xd9, 0xb2,
+    0x06, 0x6b, 0x9d, 0xff, 0x77, 0xa0, 0x83, 0xae, 0x7a, 0x7a, 0x39, 0x7b,
+    0x03, 0x6a, 0xfd, 0xe6, 0xae, 0x94, 0x7c, 0x2d, 0x94, 0x89, 0xd9, 0xcd,
+    0x6d, 0x38, 0x7a, 0xec, 0xa3, 0x93, 0x14, 0x48, 0x20, 0x7b, 0xd8, 0x04,
+    0x3d, 0xaa, 0x71, 0x9f, 0x17, 0x29, 0x07, 0xd6, 0x43, 0xe9, 0x14, 0xf3,
+    0xdf, 0xbd, 0x6b, 0xcb, 0x27, 0x5b, 0xce, 0x50, 0x73, 0xee, 0x7e, 0x26,
+    0x74, 0xe0, 0xac, 0x9a, 0xf5, 0x54, 0x6b, 0xc0, 0xbe, 0x7e, 0xe6, 0x67,
+    0xb9, 0xc1, 0xf2, 0xaa, 0x07, 0x4e, 0xca, 0x34, 0x2b, 0x70, 0xec, 0x89,
+    0xe4, 0xc3, 0x8d, 0x29, 0x88, 0xb1, 0x2c, 0x33, 0x8a, 0xb3, 0xa3, 0xaa,
+    0xa2, 0x29, 0x58, 0x49, 0xff, 0xc5, 0x69, 0xec, 0x20, 0x80, 0x10, 0x85,
+    0x01, 0x90, 0x90, 0x91, 0xe5, 0x96, 0x98, 0x06, 0x08, 0x58, 0x58, 0x91,
+    0x8c, 0x7f, 0xd1, 0x47, 0x4b, 0x05, 0xa8, 0x66, 0x41, 0xa4, 0x98, 0xf8,
+    0x37, 0x30, 0x40, 0x1f, 0x40, 0xfa, 0xb3, 0xfb, 0x6c, 0x55, 0xd8, 0x0f,
+    0x26, 0x44, 0x0d
+};
+
+static const fsw_u8 frame_zero[23] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0x64, 0x00, 0xff, 0x4d, 0x00, 0x00, 0x08, 0x00,
+    0x01, 0x00, 0xfc, 0x7f, 0x1d, 0x08, 0x01, 0xa4, 0x15, 0x57, 0xf1
+};
+
+static fsw_u8 text[TEXT_SIZE];
+static fsw_u8 zero[ZERO_SIZE];
+
+struct vector {
+    const char *name;
+    const fsw_u8 *frame;
+    unsigned frame_size;
+    const fsw_u8 *data;
+    unsigned data_size;
+};
+
+static struct vector vectors[] = {
+    { "text -19", frame_text_19, sizeof(frame_text_19), text, TEXT_SIZE },
+    { "text -1", frame_text_1, sizeof(frame_text_1), text, TEXT_SIZE },
+    { "zeros", frame_zero, sizeof(frame_zero), zero, ZERO_SIZE },
+};
+
+#define NVECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+static struct fsw_btrfs_zstd_pool pool;
+
+/* the inline extent path: osize bytes from offset off in one call */
+static int check_oneshot(struct vector *v, unsigned off, unsigned osize)
+{
+    static char ibuf[4096], obuf[TEXT_SIZE + 64];
+    fsw_ssize_t ret;
+    unsigned want = off >= v->data_size ? 0 : v->data_size - off;
+
+    if (want > osize)
+        want = osize;
+    memcpy(ibuf, v->frame, v->frame_size);
+    memset(obuf, 0xAA, sizeof(obuf));
+    ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZSTD, ibuf, v->frame_size, off, obuf, osize, &pool);
+    if (off >= v->data_size)
+        return ret <= 0;
+    return ret == (fsw_ssize_t)want && memcmp(obuf, v->data + off, want) == 0
+        && (fsw_u8)obuf[osize] == 0xAA;
+}
+
+/* the regular extent path: one stream, read in pieces of the given size */
+static int check_pieces(struct vector *v, unsigned piece)
+{
+    static char ibuf[4096], obuf[TEXT_SIZE + 200000];
+    struct btrfs_decomp_stream ds;
+    unsigned pos = 0;
+    fsw_ssize_t ret;
+    int ok = 1;
+
+    memcpy(ibuf, v->frame, v->frame_size);
+    if (btrfs_stream_open(&ds, GRUB_BTRFS_COMPRESSION_ZSTD, ibuf, v->frame_size, &pool) != FSW_SUCCESS)
+        return 0;
+    do {
+        ret = btrfs_stream_read(&ds, obuf + pos, piece);
+        if (ret < 0 || ret > (fsw_ssize_t)piece)
+            ok = 0;
+        else
+            pos += ret;
+    } while (ok && ret == (fsw_ssize_t)piece && pos <= TEXT_SIZE);
+    btrfs_stream_close(&ds);
+
+    return ok && pos == v->data_size && ds.pos == pos && memcmp(obuf, v->data, pos) == 0;
+}
+
+static void test_vectors(void)
+{
+    static const unsigned offsets[] = { 0, 1, 4095, 4096, 65537, 131000, 131071, 131072 };
+    static const unsigned sizes[] = { 1, 100, 4096, 65536, 131072 };
+    static const unsigned pieces[] = { 1, 1000, 4096, 65536, 131072, 200000 };  // obuf: TEXT_SIZE + largest piece
+    unsigned i, k, n;
+    char what[80];
+    int ok;
+
+    make_text(text, TEXT_SIZE);
+
+    for (i = 0; i < NVECTORS; i++) {
+        for (ok = 1, k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++)
+            for (n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+                if (!check_oneshot(&vectors[i], offsets[k] % (vectors[i].data_size + 1), sizes[n]))
+                    ok = 0;
+        snprintf(what, sizeof(what), "%s: one-shot reads at an offset", vectors[i].name);
+        check(ok, what);
+        for (ok = 1, k = 0; k < sizeof(pieces) / sizeof(pieces[0]); k++)
+            if (!check_pieces(&vectors[i], pieces[k]))
+                ok = 0;
+        snprintf(what, sizeof(what), "%s: stream read in pieces", vectors[i].name);
+        check(ok, what);
+    }
+}
+
+static void test_pool(void)
+{
+    static char ibuf[4096];
+    struct zstd_stream a, b, c;
+    void *first;
+
+    zstd_pool_free(&pool);
+    memcpy(ibuf, frame_text_19, sizeof(frame_text_19));
+
+    // a closed context goes to the pool and is handed out again
+    check(zstd_stream_open(&a, &pool, ibuf, sizeof(frame_text_19)) == FSW_SUCCESS, "pool: open");
+    first = a.workspace;
+    zstd_stream_close(&a, &pool);
+    check(pool.count == 1 && pool.workspace[0] == first, "pool: context kept on close");
+    check(zstd_stream_open(&a, &pool, ibuf, sizeof(frame_text_19)) == FSW_SUCCESS
+          && a.workspace == first && pool.count == 0, "pool: context reused");
+
+    // a reused context must start over, even after a half read frame
+    {
+        static char obuf[TEXT_SIZE];
+        check(zstd_stream_read(&a, obuf, 5000) == 5000, "pool: partial read");
+        zstd_stream_close(&a, &pool);
+        check(zstd_stream_open(&a, &pool, ibuf, sizeof(frame_text_19)) == FSW_SUCCESS
+              && zstd_stream_read(&a, obuf, TEXT_SIZE) == TEXT_SIZE
+              && memcmp(obuf, text, TEXT_SIZE) == 0, "pool: reused context reset");
+    }
+
+    // only ZSTD_POOL_SIZE contexts are kept, the rest is freed
+    check(zstd_stream_open(&b, &pool, ibuf, sizeof(frame_text_19)) == FSW_SUCCESS &&
+          zstd_stream_open(&c, &pool, ibuf, sizeof(frame_text_19)) == FSW_SUCCESS &&
+          a.workspace != b.workspace && b.workspace != c.workspace, "pool: separate contexts");
+    zstd_stream_close(&a, &pool);
+    zstd_stream_close(&b, &pool);
+    zstd_stream_close(&c, &pool);
+    check(pool.count == ZSTD_POOL_SIZE, "pool: size limit");
+    zstd_pool_free(&pool);
+    check(pool.count == 0, "pool: freed");
+}
+
+static void test_damaged(void)
+{
+    static char ibuf[4096], obuf[TEXT_SIZE];
+    unsigned i, size;
+    fsw_ssize_t ret;
+    int silent = 0;
+
+    // every truncation and single byte change of the checksummed frame must
+    // end in an error or a short read, never in wrong data reported as good
+    for (i = 0; i < sizeof(frame_text_19) * 2; i++) {
+        memcpy(ibuf, frame_text_19, sizeof(frame_text_19));
+        size = sizeof(frame_text_19);
+        if (i < sizeof(frame_text_19))
+            size = i;
+        else
+            ibuf[i - sizeof(frame_text_19)] ^= 0x20;
+        ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZSTD, ibuf, size, 0, obuf, TEXT_SIZE, &pool);
+        if (ret == TEXT_SIZE && memcmp(obuf, text, TEXT_SIZE) != 0)
+            silent++;
+    }
+    check(silent == 0, "damaged frames");
+    zstd_pool_free(&pool);
+}
+
+//
+// benchmark: decompress a .zst file and compare it with the original
+//
+
+static fsw_u8 *read_file(const char *path, long *size)
+{
+    FILE *f = fopen(path, "rb");
+    fsw_u8 *buf;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(*size + 1);
+    if (buf == NULL || fread(buf, 1, *size, f) != (size_t)*size) {
+        fclose(f);
+        free(buf);
+        return NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+static void bench_file(const char *zpath, const char *path)
+{
+    fsw_u8 *zdata, *data;
+    char *obuf;
+    long zsize, size;
+    clock_t start;
+    double secs;
+    int round, rounds = 0;
+    fsw_ssize_t ret;
+
+    zdata = read_file(zpath, &zsize);
+    data = read_file(path, &size);
+    if (zdata == NULL || data == NULL) {
+        check(0, "benchmark: reading the files");
+        return;
+    }
+    obuf = malloc(size + 1);
+
+    ret = btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZSTD, (char *)zdata, zsize, 0, obuf, size, &pool);
+    check(ret == size && memcmp(obuf, data, size) == 0, "benchmark: file contents");
+
+    start = clock();
+    do {
+        for (round = 0; round < 16; round++)
+            btrfs_decompress(GRUB_BTRFS_COMPRESSION_ZSTD, (char *)zdata, zsize, 0, obuf, size, &pool);
+        rounds += 16;
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (secs < 1.0);
+    printf("zstd: %.0f MB/s (%ld bytes from %ld)\n", (double)rounds * size / 1e6 / secs, size, zsize);
+
+    zstd_pool_free(&pool);
+    free(obuf);
+    free(zdata);
+    free(data);
+}
+
+int main(int argc, char **argv)
+{
+    test_vectors();
+    test_pool();
+    test_damaged();
+    if (argc > 3 && strcmp(argv[1], "-b") == 0)
+        bench_file(argv[2], argv[3]);
+    else if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        printf("usage: zstdtest -b <file.zst> <file>\n");
+
+    if (failures) {
+        printf("zstdtest: %d failures\n", failures);
+        return 1;
+    }
+    printf("zstdtest: ok\n");
+    return 0;
+}
+
+// EOF
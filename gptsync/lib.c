@@ -36,6 +36,7 @@
 
 #pragma pack(0)
 #include "gptsync.h"
+#include "../refind/crc32.h"
 
 // variables
 
@@ -260,6 +261,7 @@ UINTN read_gpt(VOID)
     GPT_ENTRY   *entry;
     UINT64      entry_lba;
     UINTN       entry_count, entry_size, i;
+    UINT32      header_crc, entry_crc;
 
     Print(L"\nCurrent GUID partition table:\n");
 
@@ -282,10 +284,25 @@ UINTN read_gpt(VOID)
         return 0;
     }
 
+    // check the header CRC, computed with the CRC field zeroed
+    if (header->header_size < 92 || header->header_size > 512) {
+        Print(L" Error: Invalid GPT header size\n");
+        return 0;
+    }
+    header_crc = header->header_crc32;
+    header->header_crc32 = 0;
+    if (crc32(0, header, header->header_size) != header_crc) {
+        Print(L" Error: GPT header CRC mismatch\n");
+        return 0;
+    }
+    header->header_crc32 = header_crc;
+
     // read entries
     entry_lba   = header->entry_lba;
     entry_size  = header->entry_size;
     entry_count = header->entry_count;
+    header_crc  = header->entry_crc32;
+    entry_crc   = 0;
 
     for (i = 0; i < entry_count; i++) {
         if (((i * entry_size) % 512) == 0) {
@@ -295,12 +312,10 @@ UINTN read_gpt(VOID)
             entry_lba++;
         }
         entry = (GPT_ENTRY *)(sector + ((i * entry_size) % 512));
+        entry_crc = crc32(entry_crc, entry, entry_size);
 
         if (guids_are_equal(entry->type_guid, empty_guid))
             continue;
-        if (gpt_part_count == 0) {
-            Print(L" #      Start LBA      End LBA  Type\n");
-        }
 
         gpt_parts[gpt_part_count].index     = i;
         gpt_parts[gpt_part_count].start_lba = entry->start_lba;
@@ -310,19 +325,29 @@ UINTN read_gpt(VOID)
         gpt_parts[gpt_part_count].gpt_parttype = gpt_parttype(gpt_parts[gpt_part_count].gpt_type);
         gpt_parts[gpt_part_count].active    = FALSE;
 
-        Print(L" %d   %12lld %12lld  %s\n",
-              gpt_parts[gpt_part_count].index + 1,
-              gpt_parts[gpt_part_count].start_lba,
-              gpt_parts[gpt_part_count].end_lba,
-              gpt_parts[gpt_part_count].gpt_parttype->name);
-
         gpt_part_count++;
     }
+
+    // only list the partitions once the whole entry array is known to be intact
+    if (entry_crc != header_crc) {
+        Print(L" Error: GPT partition entry array CRC mismatch\n");
+        gpt_part_count = 0;
+        return 0;
+    }
     if (gpt_part_count == 0) {
         Print(L" No partitions defined\n");
         return 0;
     }
 
+    Print(L" #      Start LBA      End LBA  Type\n");
+    for (i = 0; i < gpt_part_count; i++) {
+        Print(L" %d   %12lld %12lld  %s\n",
+              gpt_parts[i].index + 1,
+              gpt_parts[i].start_lba,
+              gpt_parts[i].end_lba,
+              gpt_parts[i].gpt_parttype->name);
+    }
+
     return 0;
 }
 
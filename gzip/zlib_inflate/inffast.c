@@ -27,6 +27,24 @@ get_unaligned16(const unsigned short *p)
         return mm.us;
 }
 
+#ifdef INFLATE_FAST_WIDE
+/*
+   Top the bit buffer up to at least 56 bits with one unaligned 8-byte load.
+   The bytes loaded beyond those counted in bits land exactly where the next
+   refill puts them again, so or-ing them in twice is harmless, and every use
+   of hold masks them off. The bit buffer is a UINT64 here because unsigned
+   long is only 32 bits wide on LLP64 toolchains.
+ */
+#define REFILL() \
+    do { \
+        UINT64 w_; \
+        memcpy(&w_, in, 8); \
+        hold |= w_ << bits; \
+        in += (63 - bits) >> 3; \
+        bits |= 56; \
+    } while (0)
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -57,6 +75,10 @@ get_unaligned16(const unsigned short *p)
       Therefore if strm->avail_in >= 6, then there is enough input to avoid
       checking for available input while decoding.
 
+    - With INFLATE_FAST_WIDE the bit buffer is refilled once per code pair to
+      at least 48 bits, reading eight bytes at a time, so strm->avail_in must
+      be at least 8 instead.
+
     - The maximum bytes that a single length/distance pair can output is 258
       bytes, which is the maximum length that can be coded.  inflate_fast()
       requires strm->avail_out >= 258 for each loop to avoid checking for
@@ -79,7 +101,11 @@ void inflate_fast(z_streamp strm, unsigned start)
     unsigned whave;             /* valid bytes in the window */
     unsigned write;             /* window write index */
     unsigned char *window;      /* allocated sliding window, if wsize != 0 */
+#ifdef INFLATE_FAST_WIDE
+    UINT64 hold;                /* local strm->hold, wide enough for REFILL() */
+#else
     unsigned long hold;         /* local strm->hold */
+#endif
     unsigned bits;              /* local strm->bits */
     code const *lcode;          /* local strm->lencode */
     code const *dcode;          /* local strm->distcode */
@@ -95,7 +121,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* copy state to local variables */
     state = (struct inflate_state *)strm->state;
     in = strm->next_in;
-    last = in + (strm->avail_in - 5);
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_IN - 1));
     out = strm->next_out;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
@@ -116,12 +142,17 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef INFLATE_FAST_WIDE
+        if (bits < 48)
+            REFILL();
+#else
         if (bits < 15) {
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
         }
+#endif
         this = lcode[hold & lmask];
       dolen:
         op = (unsigned)(this.bits);
@@ -135,20 +166,24 @@ void inflate_fast(z_streamp strm, unsigned start)
             len = (unsigned)(this.val);
             op &= 15;                           /* number of extra bits */
             if (op) {
+#ifndef INFLATE_FAST_WIDE
                 if (bits < op) {
                     hold += (unsigned long)(*in++) << bits;
                     bits += 8;
                 }
+#endif
                 len += (unsigned)hold & ((1U << op) - 1);
                 hold >>= op;
                 bits -= op;
             }
+#ifndef INFLATE_FAST_WIDE
             if (bits < 15) {
                 hold += (unsigned long)(*in++) << bits;
                 bits += 8;
                 hold += (unsigned long)(*in++) << bits;
                 bits += 8;
             }
+#endif
             this = dcode[hold & dmask];
           dodist:
             op = (unsigned)(this.bits);
@@ -158,6 +193,7 @@ void inflate_fast(z_streamp strm, unsigned start)
             if (op & 16) {                      /* distance base */
                 dist = (unsigned)(this.val);
                 op &= 15;                       /* number of extra bits */
+#ifndef INFLATE_FAST_WIDE
                 if (bits < op) {
                     hold += (unsigned long)(*in++) << bits;
                     bits += 8;
@@ -166,6 +202,7 @@ void inflate_fast(z_streamp strm, unsigned start)
                         bits += 8;
                     }
                 }
+#endif
                 dist += (unsigned)hold & ((1U << op) - 1);
 #ifdef INFLATE_STRICT
                 if (dist > dmax) {
@@ -236,6 +273,20 @@ void inflate_fast(z_streamp strm, unsigned start)
                             *out++ = *from++;
                     }
                 }
+#ifdef INFLATE_FAST_WIDE
+                else if (dist >= 8) {
+                    from = out - dist;          /* copy direct from output */
+                    /* the chunks never overlap, copy eight at a time */
+                    while (len >= 8) {
+                        memcpy(out, from, 8);
+                        out += 8;
+                        from += 8;
+                        len -= 8;
+                    }
+                    while (len--)
+                        *out++ = *from++;
+                }
+#endif
                 else {
                     unsigned short *sout;
                     unsigned long loops;
@@ -317,7 +368,9 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* update state and return */
     strm->next_in = in;
     strm->next_out = out;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->avail_in = (unsigned)(in < last ?
+                                (INFLATE_FAST_MIN_IN - 1) + (last - in) :
+                                (INFLATE_FAST_MIN_IN - 1) - (in - last));
     strm->avail_out = (unsigned)(out < end ?
                                  257 + (end - out) : 257 - (out - end));
     state->hold = hold;
@@ -8,4 +8,14 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* On 64-bit little-endian targets inflate_fast() refills its bit buffer
+   with one 8-byte load instead of byte by byte, so it needs two more bytes
+   of input slack than the portable loop. */
+#if defined(EFIX64) || defined(EFIAARCH64)
+#  define INFLATE_FAST_WIDE
+#  define INFLATE_FAST_MIN_IN 8
+#else
+#  define INFLATE_FAST_MIN_IN 6
+#endif
+
 void inflate_fast (z_streamp strm, unsigned start);
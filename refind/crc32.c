@@ -91,13 +91,52 @@ static UINT32 crc32_tab[] = {
    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+/*
+ * Tables for processing eight bytes per step ("slicing-by-8"):
+ * crc32_tab_n[k][i] is the CRC register after byte i followed by k+1 zero
+ * bytes, so the eight bytes of a step can be looked up independently.
+ * Built from crc32_tab on first use.
+ */
+static UINT32 crc32_tab_n[7][256];
+static BOOLEAN crc32_tab_n_ready = FALSE;
+
+static VOID crc32_init(VOID)
+{
+   UINTN i, k;
+   UINT32 c;
+
+   for (i = 0; i < 256; i++) {
+      c = crc32_tab[i];
+      for (k = 0; k < 7; k++) {
+         c = crc32_tab[c & 0xFF] ^ (c >> 8);
+         crc32_tab_n[k][i] = c;
+      }
+   }
+   crc32_tab_n_ready = TRUE;
+}
+
 UINT32 crc32(UINT32 crc, const VOID *buf, UINTN size)
 {
    const UINT8 *p;
+   UINT32 lo, hi;
+
+   if (!crc32_tab_n_ready)
+      crc32_init();
 
    p = buf;
    crc = crc ^ ~0U;
 
+   while (size >= 8) {
+      lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | ((UINT32) p[3] << 24));
+      hi = p[4] | (p[5] << 8) | (p[6] << 16) | ((UINT32) p[7] << 24);
+      crc = crc32_tab_n[6][lo & 0xFF] ^ crc32_tab_n[5][(lo >> 8) & 0xFF] ^
+            crc32_tab_n[4][(lo >> 16) & 0xFF] ^ crc32_tab_n[3][lo >> 24] ^
+            crc32_tab_n[2][hi & 0xFF] ^ crc32_tab_n[1][(hi >> 8) & 0xFF] ^
+            crc32_tab_n[0][(hi >> 16) & 0xFF] ^ crc32_tab[hi >> 24];
+      p += 8;
+      size -= 8;
+   }
+
    while (size--)
       crc = crc32_tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
 